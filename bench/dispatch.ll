@@ -0,0 +1,34 @@
+# Method calls on user classes and operator methods.
+class Counter {
+    mut count = 0
+
+    def bump(self, by) {
+        self.count = self.count + by
+    }
+
+    def get(self) {
+        self.count
+    }
+}
+
+class Money {
+    mut cents = 0
+
+    def __add__(self, other) {
+        mut m = Money.new()
+        m.cents = self.cents + other.cents
+        m
+    }
+}
+
+mut c = Counter.new()
+for mut i = 0; i < 50000; i = i + 1 {
+    c.bump(i % 7)
+}
+mut total = Money.new()
+mut one = Money.new()
+one.cents = 1
+for mut i = 0; i < 20000; i = i + 1 {
+    total = total + one
+}
+println(c.get(), total.cents)
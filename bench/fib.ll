@@ -0,0 +1,11 @@
+# Recursive calls and integer arithmetic.
+def fib(n) {
+    if n < 2 {
+        n
+    }
+    else {
+        fib(n - 2) + fib(n - 1)
+    }
+}
+
+println(fib(24))
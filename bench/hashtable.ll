@@ -0,0 +1,69 @@
+# examples/data-structures/hashtable.ll at scale, with chaining so every
+# key is kept.
+class Entry {
+    mut key
+    mut value
+
+    def new(self, key, value) {
+        self.key = key
+        self.value = value
+    }
+}
+
+class HashTable {
+    mut buckets
+    mut size = 0
+
+    def new(self, capacity) {
+        self.buckets = Vector.new(capacity)
+        for mut i = 0; i < capacity; i = i + 1 {
+            self.buckets.push_back(Vector.new())
+        }
+    }
+
+    def bucket(self, key) {
+        self.buckets[hash(key) % self.buckets.length()]
+    }
+
+    def find(self, bucket, key) {
+        for mut i = 0; i < bucket.length(); i = i + 1 {
+            if bucket[i].key == key {
+                return bucket[i]
+            }
+        }
+        nil
+    }
+
+    def set(self, key, value) {
+        const bucket = self.bucket(key)
+        const entry = self.find(bucket, key)
+        if entry == nil {
+            bucket.push_back(Entry.new(key, value))
+            self.size = self.size + 1
+        }
+        else {
+            entry.value = value
+        }
+    }
+
+    def get(self, key) {
+        const entry = self.find(self.bucket(key), key)
+        if entry == nil {
+            return nil
+        }
+        entry.value
+    }
+}
+
+const n = 5000
+mut h = HashTable.new(1024)
+for mut i = 0; i < n; i = i + 1 {
+    h.set("key" + string(i), i)
+}
+mut key = nil
+mut sum = 0
+for mut i = 0; i < n; i = i + 1 {
+    key = "key" + string(i)
+    sum = sum + h.get(key)
+}
+println(h.size, sum)
@@ -0,0 +1,10 @@
+# Loading a chain of 24 modules, each importing the next, then calling
+# through all of them. bench/run.sh writes the chain and runs this without
+# the module cache.
+import "imports/chain-00.ll" as chain
+
+mut sum = 0
+for mut i = 0; i < 200; i = i + 1 {
+    sum = sum + chain.total(i)
+}
+println(sum)
@@ -0,0 +1,17 @@
+# Allocating objects with default members.
+class Point {
+    mut x = 0
+    mut y = 0
+    mut label = "point"
+}
+
+mut last = nil
+mut all = Vector.new()
+for mut i = 0; i < 30000; i = i + 1 {
+    last = Point.new()
+    last.x = i
+    if i % 10 == 0 {
+        all.push_back(last)
+    }
+}
+println(all.length(), last.x)
@@ -0,0 +1,161 @@
+#!/bin/bash
+#
+# Times the workloads in bench/. Each one is run a few times to warm up and
+# then timed RUNS times, the median, p95, min and max are printed and, with
+# -o, written as JSON so two builds can be diffed.
+#
+#   bench/run.sh [-b binary] [-n runs] [-w warmups] [-o output.json] [name ...]
+
+BENCH_DIR=$(cd "$(dirname "$0")" && pwd)
+BINARY=$BENCH_DIR/../bin/little-lang
+RUNS=10
+WARMUPS=2
+OUTPUT=
+NAMES=()
+
+usage() {
+    echo "usage: $0 [-b binary] [-n runs] [-w warmups] [-o output.json] [name ...]" >&2
+    exit 1
+}
+
+while [ $# -gt 0 ]
+do
+    case "$1" in
+        -b ) BINARY=$2; shift 2 ;;
+        -n ) RUNS=$2; shift 2 ;;
+        -w ) WARMUPS=$2; shift 2 ;;
+        -o ) OUTPUT=$2; shift 2 ;;
+        -h | --help ) usage ;;
+        -* ) usage ;;
+        * ) NAMES+=("$1"); shift ;;
+    esac
+done
+
+if [ ! -x "$BINARY" ]; then
+    echo "$BINARY isn't executable, build it first." >&2
+    exit 1
+fi
+if ! [[ "$RUNS" =~ ^[1-9][0-9]*$ && "$WARMUPS" =~ ^[0-9]+$ ]]; then
+    usage
+fi
+BINARY=$(cd "$(dirname "$BINARY")" && pwd)/$(basename "$BINARY")
+
+if [ ${#NAMES[@]} -eq 0 ]; then
+    for f in "$BENCH_DIR"/*.ll; do
+        NAMES+=("$(basename "$f" .ll)")
+    done
+fi
+
+now_ns() {
+    date +%s%N
+}
+
+# Writes the modules imports.ll loads, a chain of CHAIN_LENGTH modules
+# that each import the next.
+CHAIN_LENGTH=24
+write_import_chain() {
+    local dir=$BENCH_DIR/imports i file
+    mkdir -p "$dir" || return
+    for ((i = 0; i < CHAIN_LENGTH; ++i)); do
+        printf -v file '%s/chain-%02d.ll' "$dir" "$i"
+        {
+            if [ $((i + 1)) -lt "$CHAIN_LENGTH" ]; then
+                printf 'import "chain-%02d.ll" as next\n\n' $((i + 1))
+            fi
+            printf 'const Depth = %d\n\n' "$i"
+            printf 'class Link {\n    mut value = 0\n\n    def get(self) {\n        self.value\n    }\n}\n\n'
+            printf 'def square(x) {\n    x * x\n}\n\n'
+            if [ $((i + 1)) -lt "$CHAIN_LENGTH" ]; then
+                printf 'def total(n) {\n    square(n) + next.total(n)\n}\n'
+            else
+                printf 'def total(n) {\n    square(n)\n}\n'
+            fi
+        } > "$file" || return
+    done
+}
+
+# Options a workload runs with. imports parses its whole chain on every
+# run, the cache the run before left would have it time reading trees.
+options_for() {
+    case "$1" in
+        imports ) echo --no-module-cache ;;
+    esac
+}
+
+# Runs one workload from bench/ so its imports resolve, output is dropped.
+run_once() {
+    (cd "$BENCH_DIR" && "$BINARY" $(options_for "$1") "$1.ll" > /dev/null)
+}
+
+# Reads one time per line in nanoseconds, prints "median p95 min max" in
+# milliseconds. p95 is the nearest rank.
+summarize() {
+    sort -n | awk '
+        { t[NR] = $1 }
+        END {
+            if (NR % 2) median = t[(NR + 1) / 2]
+            else median = (t[NR / 2] + t[NR / 2 + 1]) / 2
+            rank = int(NR * 0.95); if (rank < NR * 0.95) rank++
+            printf "%.3f %.3f %.3f %.3f\n", median / 1e6, t[rank] / 1e6, t[1] / 1e6, t[NR] / 1e6
+        }'
+}
+
+json_string() {
+    printf '"%s"' "$(printf '%s' "$1" | sed 's/\\/\\\\/g; s/"/\\"/g')"
+}
+
+if ! write_import_chain; then
+    echo "Could not write the modules of imports.ll." >&2
+    exit 1
+fi
+
+results=()
+failed=0
+printf "%-12s %10s %10s %10s %10s\n" "benchmark" "median ms" "p95 ms" "min ms" "max ms" >&2
+for name in "${NAMES[@]}"; do
+    if [ ! -f "$BENCH_DIR/$name.ll" ]; then
+        echo "No benchmark named '$name'" >&2
+        failed=1
+        continue
+    fi
+    ok=1
+    for ((i = 0; i < WARMUPS; ++i)); do
+        run_once "$name" || { ok=0; break; }
+    done
+    times=()
+    for ((i = 0; ok && i < RUNS; ++i)); do
+        start=$(now_ns)
+        run_once "$name" || { ok=0; break; }
+        times+=($(( $(now_ns) - start )))
+    done
+    if [ "$ok" -eq 0 ]; then
+        printf "%-12s failed\n" "$name" >&2
+        failed=1
+        continue
+    fi
+    read -r median p95 min max < <(printf '%s\n' "${times[@]}" | summarize)
+    printf "%-12s %10s %10s %10s %10s\n" "$name" "$median" "$p95" "$min" "$max" >&2
+    ms=$(printf '%s\n' "${times[@]}" | awk '{ printf "%s%.3f", sep, $1 / 1e6; sep = ", " }')
+    results+=("$(printf '    {"name": %s, "median_ms": %s, "p95_ms": %s, "min_ms": %s, "max_ms": %s, "times_ms": [%s]}' \
+                 "$(json_string "$name")" "$median" "$p95" "$min" "$max" "$ms")")
+done
+
+if [ -n "$OUTPUT" ]; then
+    {
+        printf '{\n'
+        printf '  "binary": %s,\n' "$(json_string "$BINARY")"
+        printf '  "commit": %s,\n' "$(json_string "$(git -C "$BENCH_DIR" rev-parse --short HEAD 2> /dev/null)")"
+        printf '  "date": %s,\n' "$(json_string "$(date -u +%Y-%m-%dT%H:%M:%SZ)")"
+        printf '  "host": %s,\n' "$(json_string "$(uname -srm)")"
+        printf '  "runs": %d,\n' "$RUNS"
+        printf '  "warmups": %d,\n' "$WARMUPS"
+        printf '  "benchmarks": [\n'
+        for ((i = 0; i < ${#results[@]}; ++i)); do
+            printf '%s%s\n' "${results[$i]}" "$([ $((i + 1)) -lt ${#results[@]} ] && echo ,)"
+        done
+        printf '  ]\n'
+        printf '}\n'
+    } > "$OUTPUT"
+fi
+
+exit $failed
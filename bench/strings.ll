@@ -0,0 +1,10 @@
+# Building strings by concatenation, each step copies.
+mut s = ""
+for mut i = 0; i < 4000; i = i + 1 {
+    s = s + string(i) + ","
+}
+mut words = ""
+for mut i = 0; i < 20000; i = i + 1 {
+    words = "word" + string(i % 10)
+}
+println(s.length(), words)
@@ -0,0 +1,14 @@
+# Appending to and indexing into a vector.
+const n = 40000
+mut v = Vector.new()
+for mut i = 0; i < n; i = i + 1 {
+    v.push_back(i)
+}
+mut sum = 0
+for mut i = 0; i < n; i = i + 1 {
+    sum = sum + v[i]
+}
+for mut i = 0; i < n; i = i + 1 {
+    v[i] = v[n - i - 1]
+}
+println(v.length(), sum)
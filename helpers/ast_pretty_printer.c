@@ -235,6 +235,10 @@ void printReturn(struct Ast *node) {
         printNode(expr);
     }
 }
+void printYield(struct Ast *node) {
+    printf("yield ");
+    printNode(node->Children[0]);
+}
 void printContinue(void) {
     printf("continue");
 }
@@ -279,6 +283,13 @@ void printFor(struct Ast *node) {
     printNode(node->Children[3]); /* post */
     printBody(node->Children[2]); /* body */
 }
+void printForIn(struct Ast *node) {
+    printf("for ");
+    printNode(node->Children[0]); /* name */
+    printf(" in ");
+    printNode(node->Children[1]); /* iterable */
+    printBody(node->Children[2]); /* body */
+}
 void printWhile(struct Ast *node) {
     printf("while ");
     printNode(node->Children[0]); /* cond */
@@ -394,6 +405,9 @@ void printNode(struct Ast *node) {
         case BreakExpr:
             printBreak();
             break;
+        case YieldExpr:
+            printYield(node);
+            break;
         case MutExpr:
             printMut(node);
             break;
@@ -403,6 +417,9 @@ void printNode(struct Ast *node) {
         case ForExpr:
             printFor(node);
             break;
+        case ForInExpr:
+            printForIn(node);
+            break;
         case WhileExpr:
             printWhile(node);
             break;
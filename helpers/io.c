@@ -2,6 +2,12 @@
 
 #include <termios.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 /*
  * Heavily based on: http://stackoverflow.com/a/7469410
@@ -36,3 +42,66 @@ int getch(void) {
 int getche(void) {
     return _getch(1);
 }
+
+/* Reads the whole file with as few read calls as possible. */
+static int MappedFileRead(struct MappedFile *file, int fd, unsigned int length) {
+    unsigned int got = 0;
+    ssize_t n;
+    file->Data = malloc(length + 1);
+    while (got < length) {
+        n = read(fd, file->Data + got, length - got);
+        if (n <= 0) {
+            break;
+        }
+        got += n;
+    }
+    file->Data[got] = 0;
+    file->Length = got;
+    file->IsMapped = 0;
+    return 0;
+}
+
+int MappedFileOpen(struct MappedFile *file, const char *filename) {
+    struct stat st;
+    long pageSize = sysconf(_SC_PAGESIZE);
+    void *data;
+    int fd, result;
+    memset(file, 0, sizeof *file);
+    fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    if (0 != fstat(fd, &st) || !S_ISREG(st.st_mode)) {
+        close(fd);
+        return -1;
+    }
+    /* The rest of the last page reads as zeros which terminates the
+       code, a file that fills its last page has no room for that. */
+    if (0 == st.st_size || 0 == st.st_size % pageSize) {
+        result = MappedFileRead(file, fd, st.st_size);
+        close(fd);
+        return result;
+    }
+    data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (MAP_FAILED == data) {
+        return -1;
+    }
+    file->Data = data;
+    file->Length = st.st_size;
+    file->IsMapped = 1;
+    return 0;
+}
+
+void MappedFileClose(struct MappedFile *file) {
+    if (!file || !file->Data) {
+        return;
+    }
+    if (file->IsMapped) {
+        munmap(file->Data, file->Length);
+    }
+    else {
+        free(file->Data);
+    }
+    memset(file, 0, sizeof *file);
+}
@@ -4,4 +4,16 @@
 int getch(void);
 int getche(void);
 
+/* A whole file in memory, mapped when possible. Data is always nul
+   terminated. */
+struct MappedFile {
+    char *Data;
+    unsigned int Length;
+    int IsMapped;
+};
+
+/* Returns 0 on success. */
+int MappedFileOpen(struct MappedFile *file, const char *filename);
+void MappedFileClose(struct MappedFile *file);
+
 #endif
@@ -49,18 +49,26 @@ enum AstNodeType {
     ReturnExpr,
     ContinueExpr,
     BreakExpr,
+    YieldExpr,
     MutExpr,
     ConstExpr,
 
     ImportExpr,
 
     ForExpr,
+    ForInExpr,
     WhileExpr,
     IfElseExpr,
 };
 
 struct Ast {
     enum AstNodeType Type;
+    /* Set on nodes made from an arena, they are released with it. */
+    unsigned int InArena;
+    /* Set on ifs and loops that declare nothing, they run in the scope
+       around them instead of pushing their own. */
+    unsigned int NoScope;
+    /* Nodes of a fixed arity keep their children right after the node. */
     struct Ast **Children;
     unsigned int NumChildren;
     unsigned int CapChildren;
@@ -71,9 +79,29 @@ struct Ast {
     struct SrcLoc SrcLoc;
 };
 
+struct AstArenaBlock;
+
+/* Nodes, their children and their symbol names are bump allocated from
+   an arena in blocks and released all at once. */
+struct AstArena {
+    struct AstArenaBlock *Blocks;
+    char *Next;
+    char *End;
+};
+
+int AstArenaMake(struct AstArena *arena);
+int AstArenaFree(struct AstArena *arena);
+/* Nodes made by the calling thread come from arena, or from the heap if
+   it is NULL. Returns the arena used before. */
+struct AstArena *AstArenaUse(struct AstArena *arena);
+char *AstArenaStrdup(struct AstArena *arena, const char *str);
+
 void AstPrettyPrint(struct Ast *ast);
 
 int AstMakeBlank(struct Ast **out_ast);
+/* A node with numChildren children for the caller to fill in. */
+int AstMakeNode(struct Ast **out_ast, enum AstNodeType type, unsigned int numChildren, struct SrcLoc srcLoc);
+/* Frees the children of a heap node, does nothing to arena nodes. */
 int AstFree(struct Ast *ast);
 
 int AstDeepCopy(struct Ast **out_ast, struct Ast *ast);
@@ -101,9 +129,11 @@ int AstMakeMemberAccess(struct Ast **out_ast, struct Ast *postfix, struct Ast *s
 int AstMakeReturn(struct Ast **out_ast, struct Ast *expr, struct SrcLoc srcLoc);
 int AstMakeContinue(struct Ast **out_ast, struct SrcLoc srcLoc);
 int AstMakeBreak(struct Ast **out_ast, struct SrcLoc srcLoc);
+int AstMakeYield(struct Ast **out_ast, struct Ast *expr, struct SrcLoc srcLoc);
 int AstMakeMut(struct Ast **out_ast, struct Ast *names, struct Ast *values, struct SrcLoc srcLoc);
 int AstMakeConst(struct Ast **out_ast, char *name, struct Ast *value, struct SrcLoc srcLoc);
 int AstMakeFor(struct Ast **out_ast, struct Ast *pre, struct Ast *condition, struct Ast *body, struct Ast *post, struct SrcLoc srcLoc);
+int AstMakeForIn(struct Ast **out_ast, struct Ast *name, struct Ast *iterable, struct Ast *body, struct SrcLoc srcLoc);
 int AstMakeWhile(struct Ast **out_ast, struct Ast *condition, struct Ast *body, struct SrcLoc srcLoc);
 int AstMakeIfElse(struct Ast **out_ast, struct Ast *condition, struct Ast *body, struct Ast *elseif, struct SrcLoc srcLoc);
 
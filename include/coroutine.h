@@ -0,0 +1,38 @@
+#ifndef _LITTLE_LANG_COROUTINE_H
+#define _LITTLE_LANG_COROUTINE_H
+
+#include <stddef.h>
+#include <ucontext.h>
+
+/* As much as the main thread usually gets, only the pages a coroutine
+   touches are ever backed by memory. */
+#define COROUTINE_DEFAULT_STACK_SIZE (8U * 1024U * 1024U)
+
+typedef void (*CoroutineProc_t)(void *arg);
+
+/* A proc running on a stack of its own that can be suspended part way
+   through and resumed later from the same thread. */
+struct Coroutine {
+    ucontext_t Context;
+    ucontext_t Resumer;
+    /* The mapping holding the stack, its first page is the guard page. */
+    void *Stack;
+    size_t StackSize;
+    CoroutineProc_t Proc;
+    void *Arg;
+    int IsRunning;
+    int IsDone;
+};
+
+int CoroutineMake(struct Coroutine *coroutine, CoroutineProc_t proc, void *arg, size_t stackSize);
+int CoroutineFree(struct Coroutine *coroutine);
+
+/* Runs coroutine until it yields or its proc returns. */
+int CoroutineResume(struct Coroutine *coroutine);
+/* Suspends the running coroutine, returns when it is resumed. */
+int CoroutineYield(struct Coroutine *coroutine);
+/* Bytes of stack the running coroutine has left below the caller's
+   frame. */
+int CoroutineStackLeft(struct Coroutine *coroutine, size_t *out_left);
+
+#endif
@@ -1,6 +1,8 @@
 #ifndef _LITTLE_LANG_GLOBALS_H
 #define _LITTLE_LANG_GLOBALS_H
 
+#include "symbol_table.h"
+
 extern struct Value g_TheTrueValue;
 extern struct Value g_TheFalseValue;
 extern struct Value g_TheNilValue;
@@ -14,13 +16,14 @@ extern struct TypeInfo g_TheRealTypeInfo;
 extern struct TypeInfo g_TheStringTypeInfo;
 extern struct TypeInfo g_TheBooleanTypeInfo;
 extern struct TypeInfo g_TheVectorTypeInfo;
+extern struct TypeInfo g_TheGeneratorTypeInfo;
 
 extern struct TypeTable g_TheGlobalTypeTable;
 
-extern struct SymbolTable *g_TheGlobalScope;
-extern struct SymbolTable g_TheUberScope;
-
 int GlobalsInit(void);
 int GlobalsDenit(void);
 
+/* Binds the builtin type names, e.g. `Integer', in scope. */
+int GlobalsInsertTypeConstants(struct SymbolTable *scope);
+
 #endif
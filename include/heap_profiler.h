@@ -0,0 +1,33 @@
+#ifndef _LITTLE_LANG_HEAP_PROFILER_H
+#define _LITTLE_LANG_HEAP_PROFILER_H
+
+#include <stdio.h>
+
+/* Where objects were allocated, a source line and, when a builtin made
+   them, its name. */
+struct HeapSite;
+struct Isolate;
+
+/* Checked by GC_AllocValue, sites are only recorded while non-zero. */
+extern int g_HeapProfilerEnabled;
+
+/* The site of the allocation isolate is making on this thread, counted as
+   one more object allocated there. Each isolate keeps its own sites so
+   workers never wait on each other. */
+struct HeapSite *HeapProfilerAllocated(struct Isolate *isolate);
+void HeapProfilerFreed(struct HeapSite *site);
+/* Hands the sites of from to isolate along with the objects counted at
+   them, see GC_AdoptHeap. */
+void HeapProfilerAdoptSites(struct Isolate *isolate, struct Isolate *from);
+/* Frees the sites of isolate, none of its objects may be left. */
+void HeapProfilerFreeSites(struct Isolate *isolate);
+
+int HeapProfilerStart(void);
+/* Prints the sites with the most live objects of the current isolate,
+   merging the sites of the workers it joined. May be called while
+   recording. */
+int HeapProfilerReport(FILE *out);
+/* Stops recording and prints a last report to out, which may be NULL. */
+int HeapProfilerStop(FILE *out);
+
+#endif
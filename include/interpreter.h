@@ -4,12 +4,22 @@
 #include "little_lang_machine.h"
 #include "ast.h"
 
-/* Initializes the core runtime. */
+/* Initializes the core runtime shared by every isolate, only the first
+   call does any work. */
 int InterpreterInit(void);
 
+/* Releases the core runtime, no isolate may be used afterwards. */
+int InterpreterDenit(void);
+
 /* Runs the entire program from top to bottom. */
 int InterpreterRunProgram(struct Module *module);
 
+/* Runs the program of a lazily imported module if it has not run yet. */
+int InterpreterInitModule(struct Module *module);
+
+/* Runs every lazily imported module reachable from module's imports. */
+int InterpreterInitImports(struct Module *module);
+
 /* Executes a single AST, useful for REPL */
 struct Value *InterpreterRunAst(struct Module *module, struct Ast *ast);
 
@@ -19,6 +29,9 @@ struct Value *InterpreterBuildObjectWithDefaults(struct Module *module, struct T
 struct Value *InterpreterDoCallBuiltinFn(struct Module *module, struct Value *function, unsigned int argc, struct Value **argv, struct SrcLoc srcLoc);
 struct Value *InterpreterDoCallFunction(struct Module *module, struct Value *function, unsigned int argc, struct Value **argv, struct SrcLoc srcLoc);
 
+/* Calls a function or builtin value, the result is never a symbol. */
+struct Value *InterpreterCall(struct Module *module, struct Value *function, unsigned int argc, struct Value **argv, struct SrcLoc srcLoc);
+
 /* Attempts to call a method on an object */
 struct Value *InterpreterDispatchMethod(struct Module *module, struct Value *object, char *methodName, unsigned int argc, struct Value **argv, struct SrcLoc srcLoc);
 
@@ -0,0 +1,113 @@
+#ifndef _LITTLE_LANG_ISOLATE_H
+#define _LITTLE_LANG_ISOLATE_H
+
+#include "symbol_table.h"
+#include "value.h"
+
+#define ISOLATE_GC_SCOPES_SIZE 53U
+#define ISOLATE_MAX_INJECTED_ARGS 4U
+#define ISOLATE_GC_PAUSE_BUCKETS 6U
+
+struct GC_Object;
+struct ScopeHolder;
+struct Module;
+struct HeapSiteTable;
+
+/* Running totals kept by the collector of one isolate, times are in
+   nanoseconds of wall clock time. Bytes only count the objects
+   themselves, not the strings and vectors they point to. */
+struct GC_Stats {
+    unsigned long Collections;
+    unsigned long long MarkTime;
+    unsigned long long SweepTime;
+    unsigned long long MaxPause;
+    /* Pauses under 10us, 100us, 1ms, 10ms, 100ms and the rest. */
+    unsigned long PauseHistogram[ISOLATE_GC_PAUSE_BUCKETS];
+    unsigned long long ObjectsAllocated;
+    unsigned long long ObjectsFreed;
+    /* Summed over every collection, an object surviving two is counted
+       twice. */
+    unsigned long long ObjectsSurvived;
+    unsigned int LastSurvived;
+    unsigned int PeakObjects;
+    /* When the first object was allocated. */
+    unsigned long long Started;
+};
+
+/* A module as seen from a worker isolate, calls into it push scopes onto
+   Private rather than onto the shared module. */
+struct IsolateWorkerModule {
+    struct Module *Shared;
+    struct Module *Private;
+    struct IsolateWorkerModule *Next;
+};
+
+/* All of the mutable state of one interpreter instance. The builtin type
+   infos and the true/false/nil singletons are shared by every isolate and
+   are never written after InterpreterInit, everything else lives here so
+   independent programs may run side by side, one isolate per thread. */
+struct Isolate {
+    struct SymbolTable *GlobalScope;
+    struct SymbolTable UberScope;
+
+    struct {
+        struct GC_Object *Head;
+        struct GC_Object *Tail;
+        unsigned int Allocated;
+        /* Allocated at which GC_SafePoint collects next. */
+        unsigned int NextCollection;
+        int Disabled;
+        struct ScopeHolder *Scopes[ISOLATE_GC_SCOPES_SIZE];
+        /* Values only the C stack knows about, kept alive until popped,
+           see GC_PushRoot. */
+        struct Value **Roots;
+        unsigned int NumRoots;
+        unsigned int RootsCapacity;
+        struct GC_Stats Stats;
+        /* Where the heap profiler counted the objects, see
+           HeapProfilerAllocated. */
+        struct HeapSiteTable *Sites;
+    } GC;
+
+    /* Receiver of a method looked up by member access, consumed by the
+       call that follows it. */
+    unsigned int NumToInjectIntoNextCall;
+    struct Value *InjectIntoNextCall[ISOLATE_MAX_INJECTED_ARGS];
+
+    /* Directory of the module currently being loaded, imports are
+       resolved relative to it. */
+    char *CameFrom;
+
+    /* Set on worker isolates, see IsolateMakeWorker. */
+    struct Isolate *Parent;
+    struct IsolateWorkerModule *WorkerModules;
+};
+
+/* Creates a fresh global scope and heap, InterpreterInit must have been
+   called first. */
+int IsolateMake(struct Isolate *isolate);
+int IsolateFree(struct Isolate *isolate);
+
+/* A worker runs code on behalf of parent on another thread. It shares
+   parent's global scope, allocates into a heap of its own that is never
+   collected and owns a private scope stack for every module it calls
+   into. Parent must not run code while its workers do.
+   Globals are shared without locks: workers may read them and mutate the
+   objects they hold, but assigning to a global from a worker races with
+   every other worker and the last write wins. */
+int IsolateMakeWorker(struct Isolate *worker, struct Isolate *parent);
+/* Hands the worker's heap over to its parent, which must be the current
+   isolate, and releases the worker. */
+int IsolateJoinWorker(struct Isolate *worker);
+/* The module calls into module should run in, module itself unless
+   isolate is a worker. */
+struct Module *IsolateModuleFor(struct Isolate *isolate, struct Module *module);
+
+/* Makes isolate the current isolate of the calling thread. */
+int IsolateEnter(struct Isolate *isolate);
+int IsolateExit(struct Isolate *isolate);
+
+/* The isolate entered by the calling thread, NULL if there is none. */
+struct Isolate *IsolateCurrent(void);
+
+#endif
@@ -3,9 +3,17 @@
 
 #include "token.h"
 
+struct LexerChunk {
+    char *Code;
+    struct LexerChunk *Next;
+};
+
 struct Lexer {
     char *Filename;
+    /* Tokens are views into Code, it must outlive them. */
     char *Code;
+    int OwnsCode;
+    struct LexerChunk *Retired;
     char *Pos;
     unsigned int Length;
     int CurrentLineNumber;
@@ -14,10 +22,13 @@ struct Lexer {
     const char *REPLPrompt;
 };
 
+/* Lexes code in place, code must be nul terminated and is not copied. */
 int LexerMake(struct Lexer *lexer, char *filename, char *code);
 int LexerFree(struct Lexer *lexer);
 int LexerThrowAwayCode(struct Lexer *lexer);
 int LexerNextToken(struct Lexer *lexer, struct Token **out_token);
+/* Like LexerNextToken but fills in token rather than allocating one. */
+int LexerNextTokenInPlace(struct Lexer *lexer, struct Token *token);
 int LexerPeekToken(struct Lexer *lexer, struct Token **out_token);
 
 #endif
@@ -2,20 +2,39 @@
 #define _LITTLE_LANG_LITTLE_LANG_MACHINE_H
 
 #include "module_table.h"
+#include "isolate.h"
+#include "helpers/io.h"
 
+struct PreparsedModule;
 
 struct LittleLangMachine {
     struct Lexer *Lexer;
     struct ModuleTable *AllImportedModules;
     struct Module *ThisModule;
+    struct Isolate *Isolate;
+    /* Imports parsed ahead of being loaded, see LittleLangMachinePreparseImports. */
+    struct PreparsedModule *Preparsed;
+    unsigned int NumPreparsed;
     struct {
         int argc;
         char **argv;
         char *code;
+        struct MappedFile source;
         char *filename;
         int PrettyPrintAst;
         int TimeExecution;
         int ReplMode;
+        int NoModuleCache;
+        int LazyImports;
+        /* Where --profile writes collapsed stacks, NULL when not profiling. */
+        char *ProfileOutput;
+        int Trace;
+        /* Where --trace writes its counters as JSON, NULL for none. */
+        char *TraceOutput;
+        int GCStats;
+        int HeapProfile;
+        /* In KB, 0 for the default. */
+        unsigned long GeneratorStack;
     } CmdOpts;
     int Error;
 };
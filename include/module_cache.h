@@ -0,0 +1,19 @@
+#ifndef _LITTLE_LANG_MODULE_CACHE_H
+#define _LITTLE_LANG_MODULE_CACHE_H
+
+#include "parser.h"
+
+/* Parsed modules are cached next to their source, foo.ll in foo.llc, as a
+   flat pre-order image of the trees and a table of the strings they use.
+   A cache is only used while the size, mtime and hash of the source match
+   the ones it was written for, its checksum matches its contents and every
+   node it holds has the shape the parser gives that kind of node. */
+
+/* Fills trees from the cache of the module at path, source is the
+   module's code. R_FileNotFound if there is no usable cache. */
+int ModuleCacheLoad(struct ParsedTrees *trees, char *path, const char *source, unsigned int length);
+/* Writes the cache of the module at path. A cache that can not be written
+   is skipped, the module is parsed again next time. */
+int ModuleCacheStore(struct ParsedTrees *trees, char *path, const char *source, unsigned int length);
+
+#endif
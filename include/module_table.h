@@ -11,6 +11,13 @@ struct Module {
     struct TypeTable *TypeTable;
     struct Ast *Program;
     struct ModuleTable *Imports;
+    /* Set while the program of a lazily imported module has not run yet. */
+    unsigned int NeedsInit;
+    /* Set once InterpreterInitImports has started on the module, so shared
+       and cyclic imports are walked once. */
+    unsigned int ImportsInitialized;
+    /* Holds Program and every function and class body of the module. */
+    struct AstArena Arena;
 };
 
 struct ModuleTableNode {
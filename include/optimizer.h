@@ -0,0 +1,33 @@
+#ifndef _LITTLE_LANG_OPTIMIZER_H
+#define _LITTLE_LANG_OPTIMIZER_H
+
+#include "parser.h"
+#include "value.h"
+
+/* Hash-conses integer and real literals so every node of a module that
+   spells the same constant shares one value. Values taken from the pool
+   live as long as the trees that use them, freeing the pool only
+   releases its table. */
+struct ConstantPool {
+    struct Value **Values;
+    unsigned int NumValues;
+    unsigned int Capacity;
+};
+
+int ConstantPoolMake(struct ConstantPool *pool);
+int ConstantPoolFree(struct ConstantPool *pool);
+/* Frees the values handed out along with the table, for when the trees
+   using them are dropped. */
+int ConstantPoolFreeValues(struct ConstantPool *pool);
+struct Value *ConstantPoolInteger(struct ConstantPool *pool, int integer);
+struct Value *ConstantPoolReal(struct ConstantPool *pool, double real);
+
+/* Folds arithmetic, comparisons and logic whose operands are integer,
+   real or boolean literals, with the same results the builtin methods
+   would give, and moves every integer and real literal of the trees into
+   one constant pool. Anything the runtime would fail on, divisions by
+   zero and out of range shifts for one, is left for it to report. Ifs and
+   loops that declare nothing are marked NoScope. */
+int OptimizeTrees(struct ParsedTrees *trees);
+
+#endif
@@ -10,6 +10,8 @@ struct ParsedTrees {
     struct Ast *Classes;
     struct Ast *TopLevelFunctions;
     struct Ast *Program;
+    /* Every node of the trees above. */
+    struct AstArena Arena;
 };
 
 int Parse(struct ParsedTrees *parsedTrees, struct Lexer *lexer);
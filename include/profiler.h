@@ -0,0 +1,56 @@
+#ifndef _LITTLE_LANG_PROFILER_H
+#define _LITTLE_LANG_PROFILER_H
+
+#include "ast.h"
+#include "value.h"
+
+#include <stdio.h>
+
+#define PROFILER_MAX_DEPTH 64U
+#define PROFILER_DEFAULT_HZ 1000U
+
+/* Where the interpreter on a thread is, kept up to date while
+   g_ProfilerActive is set. The SIGPROF handler may read it at any point. */
+struct ProfilerThread {
+    struct Ast *volatile Node;
+    /* Functions being called, outermost first. Calls nested deeper than
+       PROFILER_MAX_DEPTH are counted but not kept. */
+    struct Value *volatile Frames[PROFILER_MAX_DEPTH];
+    volatile unsigned int Depth;
+};
+
+extern __thread struct ProfilerThread g_ProfilerThread;
+/* Number of profilers reading g_ProfilerThread, the sampling one and the
+   heap profiler. Only changed while no code runs. */
+extern int g_ProfilerActive;
+
+static inline void ProfilerAt(struct Ast *ast) {
+    if (g_ProfilerActive) {
+        g_ProfilerThread.Node = ast;
+    }
+}
+static inline void ProfilerEnter(struct Value *function) {
+    unsigned int depth;
+    if (!g_ProfilerActive) {
+        return;
+    }
+    depth = g_ProfilerThread.Depth;
+    if (depth < PROFILER_MAX_DEPTH) {
+        g_ProfilerThread.Frames[depth] = function;
+    }
+    g_ProfilerThread.Depth = depth + 1;
+}
+static inline void ProfilerLeave(void) {
+    if (g_ProfilerActive) {
+        --g_ProfilerThread.Depth;
+    }
+}
+
+/* Samples whichever thread is running every 1/hz of a second of CPU time. */
+int ProfilerStart(unsigned int hz);
+/* Stops sampling. Prints a flat profile by source line to flat and writes
+   the samples to stacks as collapsed stacks, the input flamegraph.pl and
+   similar tools take. Either may be NULL. */
+int ProfilerStop(FILE *flat, FILE *stacks);
+
+#endif
@@ -5,7 +5,8 @@
 #define R_True -1
 #define R_False 0
 
-#define R_OK                    0
+/* Not R_OK, <unistd.h> defines that for access(). */
+#define R_Success               0
 #define R_InvalidArgument       1
 #define R_AllocFailed           2
 #define R_KeyAlreadyInTable     3
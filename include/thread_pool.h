@@ -0,0 +1,28 @@
+#ifndef _LITTLE_LANG_THREAD_POOL_H
+#define _LITTLE_LANG_THREAD_POOL_H
+
+/* Runs proc over [begin, end) on behalf of worker, worker is in
+   [0, ThreadPoolSize(pool)) and 0 is always the calling thread. */
+typedef void (*ThreadPoolRangeProc_t)(void *context, unsigned int worker, unsigned int begin, unsigned int end);
+
+struct ThreadPool;
+
+/* Starts numThreads background threads, the caller of
+   ThreadPoolParallelFor is an extra worker. */
+int ThreadPoolMake(struct ThreadPool **out_pool, unsigned int numThreads);
+int ThreadPoolFree(struct ThreadPool *pool);
+
+/* Number of workers that take part in a job, including the caller. */
+unsigned int ThreadPoolSize(struct ThreadPool *pool);
+
+/* Splits [begin, end) evenly between the workers, a worker that runs out
+   of work steals half of what is left of another worker's range. Blocks
+   until every index has been processed. Called from inside a job the
+   range runs on the calling thread only, as worker 0. */
+int ThreadPoolParallelFor(struct ThreadPool *pool, unsigned int begin, unsigned int end, unsigned int grain, ThreadPoolRangeProc_t proc, void *context);
+
+/* The process wide pool, started on first use. Its size comes from
+   LITTLE_LANG_THREADS or the number of online processors. */
+struct ThreadPool *ThreadPoolShared(void);
+
+#endif
@@ -25,6 +25,7 @@ enum TokenType {
     TokenReturn,
     TokenContinue,
     TokenBreak,
+    TokenYield,
 
     TokenClass,
 
@@ -86,7 +87,10 @@ enum TokenType {
 
 struct Token {
     enum TokenType Type;
-    char *TokenStr;
+    /* A view of the token's text, it is not nul terminated and points
+       into the lexer's code. */
+    const char *Text;
+    unsigned int Length;
     struct SrcLoc SrcLoc;
     union {
         char *String;
@@ -95,9 +99,11 @@ struct Token {
     } v;
 };
 
-/* Initializes the token. */
-int TokenMake(struct Token *token, enum TokenType type, char *tokenStr, char *filename, int lineNumber, int columnNumber);
+/* Initializes the token, text is not copied. */
+int TokenMake(struct Token *token, enum TokenType type, const char *text, unsigned int length, char *filename, int lineNumber, int columnNumber);
 /* Frees all of the token's data. */
 int TokenFree(struct Token *token);
+/* Returns a nul terminated copy of the token's text. */
+char *TokenTextDup(struct Token *token);
 
 #endif
@@ -3,29 +3,32 @@
 
 #include "lexer.h"
 
-struct Node {
-    struct Node *Prev;
-    struct Token *Token;
-    struct Node *Next;
-};
-
+/* Tokens are kept in one growing array, positions in the stream are
+   indices into it so saving and restoring a position is a copy of
+   Current. */
 struct TokenStream {
-    struct Node *Head;
-    struct Node *Tail;
-    struct Node *Current;
+    struct Token *Tokens;
+    unsigned int Count;
+    unsigned int Capacity;
+    unsigned int Current;
     struct Lexer *Lexer;
 };
 
+/* The token at index. Appending in REPL mode may move the array, do not
+   hold on to the pointer across calls that advance the stream. */
+#define TOKEN_STREAM_AT(ts, index) (&(ts)->Tokens[(index)])
+#define TOKEN_STREAM_CURRENT(ts) TOKEN_STREAM_AT(ts, (ts)->Current)
+
 /* Initializes the token stream. */
 int TokenStreamMake(struct TokenStream *tokenStream, struct Lexer *lexer);
 /* Frees the token stream */
 int TokenStreamFree(struct TokenStream *tokenStream);
 
-/* Creates a new node and appends it to the end of the stream. */
+/* Copies token onto the end of the stream. */
 int TokenStreamAppend(struct TokenStream *tokenStream, struct Token *token);
-/* Advances the current node to the next by one. */
+/* Advances the current position by one. */
 int TokenStreamAdvance(struct TokenStream *tokenStream);
-/* Rewinds the current node to the previous one. */
+/* Rewinds the current position to the previous one. */
 int TokenStreamRewind(struct TokenStream *tokenStream);
 
 #endif
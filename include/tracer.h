@@ -0,0 +1,42 @@
+#ifndef _LITTLE_LANG_TRACER_H
+#define _LITTLE_LANG_TRACER_H
+
+#include "value.h"
+
+#include <stdio.h>
+
+#define TRACER_MAX_DEPTH 256U
+
+/* Exact counts for one function or builtin. The counter owns copies of the
+   names so it outlives the function it counts. */
+struct TraceCounter {
+    char *Name;
+    /* The file defining the function, NULL for builtins. */
+    char *Filename;
+    volatile unsigned long long Calls;
+    /* Nanoseconds spent in the function less the calls it made. */
+    volatile unsigned long long SelfTime;
+    /* Nanoseconds from call to return, recursive calls are only counted
+       once. */
+    volatile unsigned long long TotalTime;
+    /* Where the function keeps it, cleared when the counter is freed.
+       NULL once the function itself is gone. */
+    struct TraceCounter **Slot;
+    struct TraceCounter *Next;
+};
+
+/* Checked before each call, the interpreter skips the tracer when zero. */
+extern int g_TracerEnabled;
+
+void TracerEnterFunction(struct Function *function);
+void TracerEnterBuiltinFn(struct BuiltinFn *function);
+/* Ends the call last entered on this thread. */
+void TracerLeave(void);
+
+int TracerStart(void);
+/* Stops tracing. Prints a table sorted by self time to table and writes
+   the counters as JSON to json. Either may be NULL. The counters are
+   freed, the functions they count must still be around. */
+int TracerStop(FILE *table, FILE *json);
+
+#endif
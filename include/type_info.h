@@ -30,9 +30,13 @@
  * Note: __lt__ is expected to return a true or false value
  * Note: __eq__ is expected to return a true or false value
  *
+ * Optional
+ * __le__(self, other)          alias => self <= other
+ * __ge__(self, other)          alias => self >= other
+ *
  * Note: != returns the opposite of __eq__
- * Note: <= returns __lt__ OR __eq__
- * Note: >= returns __gt__ OR __eq__
+ * Note: <= returns __le__, or __lt__ OR __eq__ if there is no __le__
+ * Note: >= returns __ge__, or __gt__ OR __eq__ if there is no __ge__
  *
  * Misc.
  * __index__(self, other)       alias => self[other]
@@ -54,6 +58,7 @@ enum TypeInfoType {
     TypeReal,                 /* Floating point object*/
     TypeUserObject,           /* A user defined object */
     TypeVector,               /* A dynamic array */
+    TypeGenerator,            /* A suspended generator function call */
 
     TypeFunction,             /* Functions are first class objects */
 };
@@ -78,6 +83,6 @@ int TypeInfoInsertMethod(struct TypeInfo *typeInfo, struct Value *method, struct
 int TypeInfoInsertMember(struct TypeInfo *typeInfo, struct Ast *ast);
 /* Searches for a method */
 int TypeInfoLookupMethod(struct TypeInfo *typeInfo, char *methodName, struct Value **out_method);
-/* Returns R_OK if typeInfo has methodName */
+/* Returns R_Success if typeInfo has methodName */
 int TypeInfoHasMethod(struct TypeInfo *typeInfo, char *methodName);
 #endif
@@ -9,6 +9,8 @@
 
 #include <stdint.h>
 
+struct TraceCounter;
+
 struct Function {
     unsigned int NumArgs;
     int IsVarArgs;
@@ -16,6 +18,9 @@ struct Function {
     struct Ast *Params;
     struct Ast *Body;
     struct Module *OwnerModule;
+    int IsGenerator;
+    /* Set on the first call made while tracing, see tracer.h. */
+    struct TraceCounter *Counter;
 };
 
 typedef struct Value *(*BuiltinFnProc_t)(struct Module *module, unsigned int argc, struct Value **argv);
@@ -24,6 +29,7 @@ struct BuiltinFn {
     unsigned int NumArgs;
     int IsVarArgs;
     BuiltinFnProc_t Fn;
+    struct TraceCounter *Counter;
 };
 
 struct Value {
@@ -33,22 +39,29 @@ struct Value {
         IsSymbol : 1,
         Visited : 1,
         IsPtrToValue : 1;
+    /* With IsPtrToValue, the element of v.Vector referred to. */
+    unsigned int ElementIndex;
     union {
         int Integer;
         uint64_t RealToIntBits;
         double Real;
-        struct Value **PtrToValue;
         struct TypeInfo *MetaTypeInfo;
         struct Symbol *Symbol;
         struct LLString *String;
         struct LLVector *Vector;
         struct Function *Function;
         struct BuiltinFn *BuiltinFn;
+        struct Generator *Generator;
         unsigned char __ptrsize[sizeof(void*)];
     } v;
     struct SymbolTable *Members;
 };
 
+/* The element a value made by indexing into a vector refers to. It is
+   looked up on every use, the vector may have grown and moved its values
+   since. */
+#define VALUE_ELEMENT(ref) ((ref)->v.Vector->Values[(ref)->ElementIndex])
+
 struct Value *ValueAlloc(void);
 struct Value *ValueAllocNoGC(void);
 int ValueFree(struct Value *value);
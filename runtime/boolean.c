@@ -49,7 +49,7 @@ static struct Value *rt_Boolean___dbg__(struct Module *module, unsigned int argc
     do {                                                                \
         struct Value *method;                                           \
         int result = FunctionMaker(&method, XSTR(name), numArgs, isVarArgs, GLUE2(rt_Boolean_, name)); \
-        if (R_OK != result) {                                           \
+        if (R_Success != result) {                                           \
             return result;                                              \
         }                                                               \
         TypeInfoInsertMethod(&g_TheBooleanTypeInfo, method, srcLoc);     \
@@ -61,5 +61,5 @@ int RT_Boolean_RegisterBuiltins(void) {
     BOOLEAN_METHOD_INSERT(__str__, 1, 0);
     BOOLEAN_METHOD_INSERT(__hash__, 1, 0);
     BOOLEAN_METHOD_INSERT(__dbg__, 1, 0);
-    return R_OK;
+    return R_Success;
 }
@@ -25,7 +25,7 @@ static struct Value *rt_BuiltinFn___dbg__(struct Module *module, unsigned int ar
     do {                                                                \
         struct Value *method;                                           \
         int result = FunctionMaker(&method, XSTR(name), numArgs, isVarArgs, GLUE2(rt_BuiltinFn_, name)); \
-        if (R_OK != result) {                                           \
+        if (R_Success != result) {                                           \
             return result;                                              \
         }                                                               \
         TypeInfoInsertMethod(&g_TheBuiltinFnTypeInfo, method, srcLoc);     \
@@ -34,5 +34,5 @@ static struct Value *rt_BuiltinFn___dbg__(struct Module *module, unsigned int ar
 int RT_BuiltinFn_RegisterBuiltins(void) {
     BUILTINFN_METHOD_INSERT(__str__, 1, 0);
     BUILTINFN_METHOD_INSERT(__dbg__, 1, 0);
-    return R_OK;
+    return R_Success;
 }
@@ -25,7 +25,7 @@ static struct Value *rt_Function___dbg__(struct Module *module, unsigned int arg
     do {                                                                \
         struct Value *method;                                           \
         int result = FunctionMaker(&method, XSTR(name), numArgs, isVarArgs, GLUE2(rt_Function_, name)); \
-        if (R_OK != result) {                                           \
+        if (R_Success != result) {                                           \
             return result;                                              \
         }                                                               \
         TypeInfoInsertMethod(&g_TheFunctionTypeInfo, method, srcLoc);     \
@@ -34,5 +34,5 @@ static struct Value *rt_Function___dbg__(struct Module *module, unsigned int arg
 int RT_Function_RegisterBuiltins(void) {
     FUNCTION_METHOD_INSERT(__str__, 1, 0);
     FUNCTION_METHOD_INSERT(__dbg__, 1, 0);
-    return R_OK;
+    return R_Success;
 }
@@ -1,5 +1,8 @@
 #include "gc.h"
 #include "globals.h"
+#include "heap_profiler.h"
+#include "isolate.h"
+#include "runtime/generator.h"
 #include "result.h"
 
 #include "helpers/macro_helpers.h"
@@ -7,16 +10,15 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <time.h>
 
 struct GC_Object {
     struct GC_Object *Prev, *Next;
     struct Value *Value;
+    /* Where it was allocated, only set while profiling the heap. */
+    struct HeapSite *Site;
 };
 
-static struct GC_Object *GC_Head;
-static struct GC_Object *GC_Tail;
-static unsigned int GC_Allocated;
-static int GC_Disabled;
 /* TODO: Proper size of memory allocated rather than number of objects. */
 #ifdef GC_COLLECT_THRESHOLD
 const unsigned int GC_CollectThreshold = GC_COLLECT_THRESHOLD;
@@ -28,24 +30,42 @@ struct ScopeHolder {
     struct SymbolTable *ST;
     struct ScopeHolder *Next;
 };
-#define SCOPE_SIZE 53U
-const unsigned int ScopesSize = SCOPE_SIZE;
-static struct ScopeHolder *Scopes[SCOPE_SIZE];
+const unsigned int ScopesSize = ISOLATE_GC_SCOPES_SIZE;
 
-int GC_Append(struct GC_Object *object) {
+/* The heap of the isolate entered by this thread. */
+#define GC_Heap (IsolateCurrent()->GC)
+
+/* What one object costs the heap, payloads aside. */
+#define GC_OBJECT_BYTES (sizeof(struct GC_Object) + sizeof(struct Value))
+
+/* clock() is process wide, with workers running it counts their time
+   too. */
+static unsigned long long GC_Now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+}
+
+static void GC_UpdatePeak(struct Isolate *isolate) {
+    if (isolate->GC.Allocated > isolate->GC.Stats.PeakObjects) {
+        isolate->GC.Stats.PeakObjects = isolate->GC.Allocated;
+    }
+}
+
+static int GC_Append(struct Isolate *isolate, struct GC_Object *object) {
     if (!object) {
         return R_InvalidArgument;
     }
-    if (!GC_Head) {
-        GC_Head = object;
-        GC_Tail = GC_Head;
+    if (!isolate->GC.Head) {
+        isolate->GC.Head = object;
+        isolate->GC.Tail = isolate->GC.Head;
     }
     else {
-        GC_Tail->Next = object;
-        object->Prev = GC_Tail;
-        GC_Tail = object;
+        isolate->GC.Tail->Next = object;
+        object->Prev = isolate->GC.Tail;
+        isolate->GC.Tail = object;
     }
-    return R_OK;
+    return R_Success;
 }
 
 int GC_Free(struct GC_Object *object) {
@@ -57,7 +77,7 @@ int GC_Free(struct GC_Object *object) {
     prev = object->Prev;
     next = object->Next;
     result = ValueFree(object->Value);
-    if (R_OK != result) {
+    if (R_Success != result) {
         return result;
     }
     if (prev) {
@@ -66,17 +86,20 @@ int GC_Free(struct GC_Object *object) {
     if (next) {
         next->Prev = prev;
     }
-    if (GC_Head == object) {
-        GC_Head = next;
+    if (GC_Heap.Head == object) {
+        GC_Heap.Head = next;
     }
-    if (GC_Tail == object) {
-        GC_Tail = prev;
+    if (GC_Heap.Tail == object) {
+        GC_Heap.Tail = prev;
     }
 #ifndef NDEBUG
     memset(object->Value, 0xff, sizeof *object->Value);
 #endif
     free(object->Value);
-    GC_Allocated--;
+    if (object->Site) {
+        HeapProfilerFreed(object->Site);
+    }
+    GC_Heap.Allocated--;
     return result;
 }
 
@@ -117,7 +140,18 @@ static void GC_VisitVector(struct LLVector *v, GC_ApplyProcToValue_t fn) {
     }
 }
 
+static void GC_VisitGenerator(struct Generator *g, GC_ApplyProcToValue_t fn) {
+    GC_VisitObject(g->Function, fn);
+    GC_VisitObject(g->Yielded, fn);
+    GC_VisitSymbolTable(g->Scope, fn);
+}
+
+/* Objects already visited are not gone through again, cycles end there
+   and shared ones are marked once. */
 static void GC_VisitObject(struct Value *v, GC_ApplyProcToValue_t fn) {
+    if (v->Visited) {
+        return;
+    }
     fn(v);
     if (v->TypeInfo && TypeUserObject == v->TypeInfo->Type) {
         GC_VisitObjectMembers(v, fn);
@@ -125,11 +159,13 @@ static void GC_VisitObject(struct Value *v, GC_ApplyProcToValue_t fn) {
     else if (&g_TheVectorTypeInfo == v->TypeInfo) {
         GC_VisitVector(v->v.Vector, fn);
     }
+    else if (&g_TheGeneratorTypeInfo == v->TypeInfo) {
+        GC_VisitGenerator(v->v.Generator, fn);
+    }
 }
 
 static void GC_VisitSymbols(struct Symbol *s, GC_ApplyProcToValue_t fn) {
     while (s) {
-        s->Value->Visited = 1;
         GC_VisitObject(s->Value, fn);
         s = s->Next;
     }
@@ -155,19 +191,34 @@ static void GC_VisitScopeHolders(struct ScopeHolder *sh, GC_ApplyProcToValue_t f
 static void GC_VisitReachableScopes(GC_ApplyProcToValue_t fn) {
     unsigned int i;
     for (i = 0; i < ScopesSize; ++i) {
-        if (Scopes[i]) {
-            GC_VisitScopeHolders(Scopes[i], fn);
+        if (GC_Heap.Scopes[i]) {
+            GC_VisitScopeHolders(GC_Heap.Scopes[i], fn);
         }
     }
 }
 
 static void GC_VisitTheUberScope(GC_ApplyProcToValue_t fn) {
-    GC_VisitSymbolTable(&g_TheUberScope, fn);
+    GC_VisitSymbolTable(&IsolateCurrent()->UberScope, fn);
+}
+
+/* A reference to a symbol keeps the value it refers to alive too, the
+   symbol may belong to an object nothing else refers to. */
+static void GC_VisitRoots(GC_ApplyProcToValue_t fn) {
+    unsigned int i;
+    struct Value *v;
+    for (i = 0; i < GC_Heap.NumRoots; ++i) {
+        v = GC_Heap.Roots[i];
+        GC_VisitObject(v, fn);
+        if (v->IsSymbol) {
+            GC_VisitObject(v->v.Symbol->Value, fn);
+        }
+    }
 }
 
 static void GC_VisitEverything(GC_ApplyProcToValue_t fn) {
     GC_VisitTheUberScope(fn);
     GC_VisitReachableScopes(fn);
+    GC_VisitRoots(fn);
 }
 
 static void GC_Mark(void) {
@@ -175,8 +226,9 @@ static void GC_Mark(void) {
 }
 
 static void GC_Sweep(void) {
-    struct GC_Object *object = GC_Head;
+    struct GC_Object *object = GC_Heap.Head;
     struct GC_Object *next;
+    unsigned int freed = 0, survived = 0;
     while (object) {
         next = object->Next;
         if (!object->Value->Visited) {
@@ -185,12 +237,17 @@ static void GC_Sweep(void) {
             object->Next = NULL;
             object->Value = NULL;
             free(object);
+            ++freed;
         }
         else {
             object->Value->Visited = 0;
+            ++survived;
         }
         object = next;
     }
+    GC_Heap.Stats.ObjectsFreed += freed;
+    GC_Heap.Stats.ObjectsSurvived += survived;
+    GC_Heap.Stats.LastSurvived = survived;
 }
 
 static struct ScopeHolder *ScopeHolderAlloc(struct SymbolTable *st) {
@@ -199,10 +256,22 @@ static struct ScopeHolder *ScopeHolderAlloc(struct SymbolTable *st) {
     return sh;
 }
 
+static void GC_FreeScopeHolders(struct ScopeHolder **scopes) {
+    struct ScopeHolder *sh, *next;
+    unsigned int i;
+    for (i = 0; i < ScopesSize; ++i) {
+        for (sh = scopes[i]; sh; sh = next) {
+            next = sh->Next;
+            free(sh);
+        }
+        scopes[i] = NULL;
+    }
+}
+
 /************************ Public Functions *************************/
 
 void GC_Dump(void) {
-    struct GC_Object *object = GC_Head;
+    struct GC_Object *object = GC_Heap.Head;
     while (object) {
         GC_PrintObject(object);
         object = object->Next;
@@ -213,23 +282,70 @@ void GC_DumpReachable(void) {
     GC_VisitEverything(GC_PrintValue);
 }
 
+const struct GC_Stats *GC_GetStats(void) {
+    return &GC_Heap.Stats;
+}
+
+void GC_PrintStats(FILE *out) {
+    static const char *buckets[ISOLATE_GC_PAUSE_BUCKETS] = {
+        "< 10us", "< 100us", "< 1ms", "< 10ms", "< 100ms", ">= 100ms"
+    };
+    const struct GC_Stats *stats = &GC_Heap.Stats;
+    double elapsed = stats->Started ? (GC_Now() - stats->Started) / 1e9 : 0.0;
+    unsigned long long pauses = stats->MarkTime + stats->SweepTime;
+    unsigned int i;
+    fprintf(out, "\nGC statistics:\n");
+    fprintf(out, "  collections      %lu, threshold %u objects\n", stats->Collections, GC_CollectThreshold);
+    fprintf(out, "  mark time        %.3f ms\n", stats->MarkTime / 1e6);
+    fprintf(out, "  sweep time       %.3f ms\n", stats->SweepTime / 1e6);
+    if (stats->Collections) {
+        fprintf(out, "  pause            %.3f ms mean, %.3f ms max\n",
+                pauses / 1e6 / stats->Collections,
+                stats->MaxPause / 1e6);
+        for (i = 0; i < ISOLATE_GC_PAUSE_BUCKETS; ++i) {
+            fprintf(out, "    %-14s %lu\n", buckets[i], stats->PauseHistogram[i]);
+        }
+    }
+    fprintf(out, "  allocated        %llu objects, %llu bytes",
+            stats->ObjectsAllocated,
+            stats->ObjectsAllocated * GC_OBJECT_BYTES);
+    if (elapsed > 0) {
+        fprintf(out, ", %.0f objects a second", stats->ObjectsAllocated / elapsed);
+    }
+    fprintf(out, "\n");
+    fprintf(out, "  freed            %llu objects, %llu bytes\n",
+            stats->ObjectsFreed,
+            stats->ObjectsFreed * GC_OBJECT_BYTES);
+    fprintf(out, "  survived         %llu objects, %llu bytes, %u after the last collection\n",
+            stats->ObjectsSurvived,
+            stats->ObjectsSurvived * GC_OBJECT_BYTES,
+            stats->LastSurvived);
+    fprintf(out, "  peak heap        %u objects, %llu bytes\n",
+            stats->PeakObjects,
+            (unsigned long long)stats->PeakObjects * GC_OBJECT_BYTES);
+}
+
+unsigned long GC_ObjectBytes(void) {
+    return GC_OBJECT_BYTES;
+}
+
 void GC_Disable(void) {
-    GC_Disabled = 1;
+    GC_Heap.Disabled = 1;
 }
 void GC_Enable(void) {
-    GC_Disabled = 0;
+    GC_Heap.Disabled = 0;
 }
 unsigned int GC_isDisabled(void) {
-    return GC_Disabled;
+    return GC_Heap.Disabled;
 }
 
 int GC_RegisterSymbolTable(struct SymbolTable *st) {
     unsigned int idx = (size_t)st % ScopesSize;
-    struct ScopeHolder *sh = Scopes[idx];
+    struct ScopeHolder *sh = GC_Heap.Scopes[idx];
     if (!sh) {
         sh = ScopeHolderAlloc(st);
-        Scopes[idx] = sh;
-        return R_OK;;
+        GC_Heap.Scopes[idx] = sh;
+        return R_Success;;
     }
     while (sh->Next) {
         if (st == sh->ST) {
@@ -238,51 +354,150 @@ int GC_RegisterSymbolTable(struct SymbolTable *st) {
         sh = sh->Next;
     }
     sh->Next = ScopeHolderAlloc(st);
-    return R_OK;
+    return R_Success;
+}
+
+int GC_PushRoot(struct Value *value) {
+    struct Value **roots;
+    unsigned int capacity;
+    if (!value) {
+        return R_InvalidArgument;
+    }
+    if (GC_Heap.NumRoots == GC_Heap.RootsCapacity) {
+        capacity = GC_Heap.RootsCapacity ? GC_Heap.RootsCapacity * 2 : 16;
+        roots = realloc(GC_Heap.Roots, capacity * sizeof *roots);
+        if (!roots) {
+            return R_AllocFailed;
+        }
+        GC_Heap.Roots = roots;
+        GC_Heap.RootsCapacity = capacity;
+    }
+    GC_Heap.Roots[GC_Heap.NumRoots++] = value;
+    return R_Success;
+}
+
+void GC_PopRoots(unsigned int count) {
+    GC_Heap.NumRoots -= count < GC_Heap.NumRoots ? count : GC_Heap.NumRoots;
 }
 
 int GC_AllocValue(struct Value **out_value) {
     int result;
     struct GC_Object *object;
     struct Value *value;
+    struct Isolate *isolate = IsolateCurrent();
 
-    /* TODO: Need to fix marking: cycles and symbol lifetime. */
-    result = GC_Collect();
-    if (R_OK != result) {
-        *out_value = NULL;
-        return result;
-    }
-
+    /* Never collects, the caller has yet to store the value anywhere the
+       collector looks. See GC_SafePoint. */
     object = calloc(sizeof *object, 1);
     value = calloc(sizeof *value, 1);
-    value->Visited = 1;
     object->Value = value;
-    result = GC_Append(object);
-    if (R_OK != result) {
+    if (g_HeapProfilerEnabled) {
+        object->Site = HeapProfilerAllocated(isolate);
+    }
+    result = GC_Append(isolate, object);
+    if (R_Success != result) {
         *out_value = NULL;
         free(value);
         free(object);
         return result;
     }
-    GC_Allocated++;
+    isolate->GC.Allocated++;
+    isolate->GC.Stats.ObjectsAllocated++;
+    if (!isolate->GC.Stats.Started) {
+        isolate->GC.Stats.Started = GC_Now();
+    }
+    GC_UpdatePeak(isolate);
     *out_value = value;
-    return R_OK;
+    return R_Success;
+}
+
+/* ValueDuplicate makes shallow copies that share their payload with the
+   original, so only the objects themselves are released here. */
+int GC_FreeHeap(void) {
+    struct GC_Object *object = GC_Heap.Head, *next;
+    while (object) {
+        next = object->Next;
+        free(object->Value);
+        free(object);
+        object = next;
+    }
+    GC_FreeScopeHolders(GC_Heap.Scopes);
+    HeapProfilerFreeSites(IsolateCurrent());
+    free(GC_Heap.Roots);
+    GC_Heap.Roots = NULL;
+    GC_Heap.NumRoots = 0;
+    GC_Heap.RootsCapacity = 0;
+    GC_Heap.Head = NULL;
+    GC_Heap.Tail = NULL;
+    GC_Heap.Allocated = 0;
+    return R_Success;
+}
+
+int GC_AdoptHeap(struct Isolate *from) {
+    if (!from || from == IsolateCurrent()) {
+        return R_InvalidArgument;
+    }
+    /* The scopes from registered are gone with it, they are no roots. */
+    GC_FreeScopeHolders(from->GC.Scopes);
+    HeapProfilerAdoptSites(IsolateCurrent(), from);
+    if (!from->GC.Head) {
+        return R_Success;
+    }
+    if (!GC_Heap.Head) {
+        GC_Heap.Head = from->GC.Head;
+    }
+    else {
+        GC_Heap.Tail->Next = from->GC.Head;
+        from->GC.Head->Prev = GC_Heap.Tail;
+    }
+    GC_Heap.Tail = from->GC.Tail;
+    GC_Heap.Allocated += from->GC.Allocated;
+    GC_Heap.Stats.ObjectsAllocated += from->GC.Stats.ObjectsAllocated;
+    GC_UpdatePeak(IsolateCurrent());
+    from->GC.Head = NULL;
+    from->GC.Tail = NULL;
+    from->GC.Allocated = 0;
+    return R_Success;
 }
 
 #ifdef NO_GC
 int GC_Collect(void) {
-    return R_OK;
+    return R_Success;
 }
 #else
-int GC_Collect(void) {
-    if (GC_Disabled) {
-        return R_OK;
+static void GC_RecordPause(unsigned long long pause) {
+    unsigned long long limit = 10000;
+    unsigned int bucket = 0;
+    while (bucket + 1 < ISOLATE_GC_PAUSE_BUCKETS && pause >= limit) {
+        limit *= 10;
+        ++bucket;
+    }
+    ++GC_Heap.Stats.PauseHistogram[bucket];
+    if (pause > GC_Heap.Stats.MaxPause) {
+        GC_Heap.Stats.MaxPause = pause;
     }
-    if (GC_Allocated < GC_CollectThreshold) {
-        return R_OK;
+}
+
+int GC_Collect(void) {
+    unsigned long long start, marked, swept;
+    if (GC_Heap.Disabled) {
+        return R_Success;
     }
+    start = GC_Now();
     GC_Mark();
+    marked = GC_Now();
     GC_Sweep();
-    return R_OK;
+    swept = GC_Now();
+    GC_Heap.Stats.Collections++;
+    GC_Heap.Stats.MarkTime += marked - start;
+    GC_Heap.Stats.SweepTime += swept - marked;
+    GC_RecordPause(swept - start);
+    /* Collecting again before the heap doubles would only find the same
+       objects alive, once it was at least the threshold. */
+    GC_Heap.NextCollection = 2 * GC_Heap.Stats.LastSurvived;
+    if (GC_Heap.NextCollection < GC_CollectThreshold) {
+        GC_Heap.NextCollection = GC_CollectThreshold;
+    }
+    return R_Success;
 }
 #endif
@@ -3,7 +3,12 @@
 
 #include "value.h"
 #include "symbol_table.h"
+#include "isolate.h"
+#include "result.h"
 
+#include <stdio.h>
+
+/* Collects now unless the collector is disabled. */
 int GC_Collect(void);
 int GC_AllocValue(struct Value **out_value);
 unsigned int GC_isDisabled(void);
@@ -11,6 +16,35 @@ void GC_Disable(void);
 void GC_Enable(void);
 void GC_Dump(void);
 void GC_DumpReachable(void);
+/* Totals for the current isolate, see struct GC_Stats. */
+const struct GC_Stats *GC_GetStats(void);
+void GC_PrintStats(FILE *out);
+/* Bytes one object takes on the heap, the unit of the byte counts. */
+unsigned long GC_ObjectBytes(void);
 int GC_RegisterSymbolTable(struct SymbolTable *st);
+/* Keeps value alive while the interpreter holds it on the C stack and
+   evaluates something that may collect, pops are in reverse order. */
+int GC_PushRoot(struct Value *value);
+void GC_PopRoots(unsigned int count);
+/* Collects once the heap has doubled since the last collection and has
+   at least GC_COLLECT_THRESHOLD objects. Allocating never collects, the
+   interpreter calls this between statements only, where every value it
+   still needs is in a scope or on the root stack. */
+static inline int GC_SafePoint(struct Isolate *isolate) {
+#ifdef NO_GC
+    (void)isolate;
+    return R_Success;
+#else
+    if (isolate->GC.Allocated < isolate->GC.NextCollection || isolate->GC.Disabled) {
+        return R_Success;
+    }
+    return GC_Collect();
+#endif
+}
+/* Releases every object of the current isolate. */
+int GC_FreeHeap(void);
+/* Moves every object of from into the current isolate's heap and drops
+   the scopes it registered. */
+int GC_AdoptHeap(struct Isolate *from);
 
 #endif
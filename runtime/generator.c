@@ -0,0 +1,203 @@
+#include "registrar.h"
+#include "type_info.h"
+#include "globals.h"
+#include "interpreter.h"
+#include "helpers/macro_helpers.h"
+#include "helpers/strings.h"
+#include "runtime/generator.h"
+#include "value.h"
+
+#include "result.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Left for whatever a call does before the next one checks again. */
+#define GENERATOR_STACK_RESERVE (64U * 1024U)
+
+static struct SrcLoc srcLoc = {"generator.c", -1, -1};
+
+static size_t TheStackSize = COROUTINE_DEFAULT_STACK_SIZE;
+
+/* The generator whose coroutine this thread is running, if any. */
+static __thread struct Generator *TheRunningGenerator;
+
+static void GeneratorMain(void *arg) {
+    struct Generator *generator = arg;
+    struct Ast *body = generator->Function->v.Function->Body;
+    if (body) {
+        InterpreterRunAst(&generator->Module, body);
+    }
+}
+
+/* Frees whatever scopes the body still had pushed when it was abandoned
+   and then the scope holding the arguments. */
+static void GeneratorFreeScopes(struct Generator *generator) {
+    struct SymbolTable *parent, *scope = generator->Scope;
+    while (scope->Child) {
+        scope = scope->Child;
+    }
+    while (1) {
+        parent = scope->Parent;
+        SymbolTableFree(scope);
+        free(scope);
+        if (generator->Scope == scope) {
+            break;
+        }
+        scope = parent;
+    }
+    generator->Scope = NULL;
+    generator->Module.CurrentScope = NULL;
+}
+
+static struct Value *rt_Generator_next(struct Module *module, unsigned int argc, struct Value **argv) {
+    struct Value *value, *self = argv[0];
+    if (R_Success != GeneratorResume(self->v.Generator, &value)) {
+        printf("Generator '%s' is already running\n", self->v.Generator->Function->v.Function->Name);
+        return &g_TheNilValue;
+    }
+    return value;
+}
+static struct Value *rt_Generator_done(struct Module *module, unsigned int argc, struct Value **argv) {
+    struct Value *self = argv[0];
+    return self->v.Generator->Coroutine.IsDone ? &g_TheTrueValue : &g_TheFalseValue;
+}
+static struct Value *rt_Generator___str__(struct Module *module, unsigned int argc, struct Value **argv) {
+    struct Value *out, *self = argv[0];
+    char *name = str_cat("<generator ", self->v.Generator->Function->v.Function->Name);
+    char *s = str_cat(name, ">");
+    ValueMakeLLStringWithCString(&out, s);
+    free(name);
+    free(s);
+    return out;
+}
+static struct Value *rt_Generator___dbg__(struct Module *module, unsigned int argc, struct Value **argv) {
+    return rt_Generator___str__(module, argc, argv);
+}
+
+#define GENERATOR_METHOD_INSERT(name, numArgs, isVarArgs)                 \
+    do {                                                                \
+        struct Value *method;                                           \
+        int result = FunctionMaker(&method, XSTR(name), numArgs, isVarArgs, GLUE2(rt_Generator_, name)); \
+        if (R_Success != result) {                                           \
+            return result;                                              \
+        }                                                               \
+        TypeInfoInsertMethod(&g_TheGeneratorTypeInfo, method, srcLoc);  \
+    } while (0)
+
+/************************ Public Functions *************************/
+
+int GeneratorMake(struct Value **out_value, struct Module *module, struct Value *function, unsigned int argc, struct Value **argv) {
+    struct Generator *generator;
+    struct Value *value;
+    struct Ast *param, *params = function->v.Function->Params;
+    unsigned int i;
+    int result;
+    if (!out_value || !module || !function) {
+        return R_InvalidArgument;
+    }
+    generator = calloc(sizeof *generator, 1);
+    result = CoroutineMake(&generator->Coroutine, GeneratorMain, generator, TheStackSize);
+    if (R_Success != result) {
+        free(generator);
+        *out_value = NULL;
+        return result;
+    }
+    memcpy(&generator->Module, module, sizeof generator->Module);
+    /* Not pushed with SymbolTablePushScope, the caller's scopes must not
+       see it as their child. */
+    generator->Scope = malloc(sizeof *generator->Scope);
+    SymbolTableMake(generator->Scope);
+    generator->Scope->Parent = module->ModuleScope;
+    generator->Module.CurrentScope = generator->Scope;
+    if (params) {
+        for (i = 0; i < params->NumChildren && i < argc; ++i) {
+            param = params->Children[i];
+            SymbolTableInsert(generator->Scope, argv[i], param->u.SymbolName, 1, param->SrcLoc);
+        }
+    }
+    generator->Function = function;
+    generator->Yielded = &g_TheNilValue;
+
+    value = ValueAlloc();
+    value->TypeInfo = &g_TheGeneratorTypeInfo;
+    value->IsPassByReference = 1;
+    value->v.Generator = generator;
+    *out_value = value;
+    return R_Success;
+}
+
+int GeneratorFree(struct Generator *generator) {
+    if (!generator) {
+        return R_InvalidArgument;
+    }
+    if (generator->Coroutine.IsRunning) {
+        return R_OperationFailed;
+    }
+    GeneratorFreeScopes(generator);
+    CoroutineFree(&generator->Coroutine);
+    free(generator);
+    return R_Success;
+}
+
+int GeneratorResume(struct Generator *generator, struct Value **out_value) {
+    struct Generator *previous;
+    int result;
+    if (!generator || !out_value) {
+        return R_InvalidArgument;
+    }
+    *out_value = &g_TheNilValue;
+    if (generator->Coroutine.IsDone) {
+        return R_Success;
+    }
+    if (generator->Coroutine.IsRunning) {
+        return R_OperationFailed;
+    }
+    previous = TheRunningGenerator;
+    TheRunningGenerator = generator;
+    generator->Yielded = &g_TheNilValue;
+    result = CoroutineResume(&generator->Coroutine);
+    TheRunningGenerator = previous;
+    if (R_Success != result) {
+        return result;
+    }
+    if (!generator->Coroutine.IsDone) {
+        *out_value = generator->Yielded;
+    }
+    return R_Success;
+}
+
+int GeneratorYield(struct Value *value) {
+    struct Generator *generator = TheRunningGenerator;
+    if (!generator) {
+        return R_OperationFailed;
+    }
+    generator->Yielded = value;
+    return CoroutineYield(&generator->Coroutine);
+}
+
+int GeneratorSetStackSize(size_t stackSize) {
+    if (stackSize <= GENERATOR_STACK_RESERVE) {
+        return R_InvalidArgument;
+    }
+    TheStackSize = stackSize;
+    return R_Success;
+}
+
+int GeneratorCheckStack(void) {
+    size_t left;
+    struct Generator *generator = TheRunningGenerator;
+    if (!generator || R_Success != CoroutineStackLeft(&generator->Coroutine, &left)) {
+        return R_Success;
+    }
+    return left < GENERATOR_STACK_RESERVE ? R_OperationFailed : R_Success;
+}
+
+int RT_Generator_RegisterBuiltins(void) {
+    GENERATOR_METHOD_INSERT(next, 1, 0);
+    GENERATOR_METHOD_INSERT(done, 1, 0);
+    GENERATOR_METHOD_INSERT(__str__, 1, 0);
+    GENERATOR_METHOD_INSERT(__dbg__, 1, 0);
+    return R_Success;
+}
@@ -0,0 +1,38 @@
+#ifndef _LITTLE_LANG_RUNTIME_GENERATOR_H
+#define _LITTLE_LANG_RUNTIME_GENERATOR_H
+
+#include "coroutine.h"
+#include "module_table.h"
+#include "value.h"
+
+/* A call to a function containing `yield', its body runs on a coroutine
+   of its own and is suspended at every yield. */
+struct Generator {
+    struct Coroutine Coroutine;
+    /* The function's module with a scope stack of its own, rooted at
+       Scope which holds the arguments. */
+    struct Module Module;
+    struct SymbolTable *Scope;
+    struct Value *Function;
+    struct Value *Yielded;
+};
+
+int GeneratorMake(struct Value **out_value, struct Module *module, struct Value *function, unsigned int argc, struct Value **argv);
+int GeneratorFree(struct Generator *generator);
+
+/* Runs generator up to its next yield, *out_value is nil once it has
+   finished. */
+int GeneratorResume(struct Generator *generator, struct Value **out_value);
+/* Suspends the running generator, called by the interpreter for
+   `yield'. */
+int GeneratorYield(struct Value *value);
+/* Stack for the generators made from now on, stackSize is in bytes. */
+int GeneratorSetStackSize(size_t stackSize);
+/* R_OperationFailed when the running generator is close to the end of its
+   stack, checked before every call so running out is an error rather than
+   a fault. */
+int GeneratorCheckStack(void);
+
+int RT_Generator_RegisterBuiltins(void);
+
+#endif
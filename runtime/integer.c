@@ -284,7 +284,7 @@ static struct Value *rt_Integer_is_nan(struct Module *module, unsigned int argc,
     do {                                                                \
         struct Value *method;                                           \
         int result = FunctionMaker(&method, XSTR(name), numArgs, isVarArgs, GLUE2(rt_Integer_, name)); \
-        if (R_OK != result) {                                           \
+        if (R_Success != result) {                                           \
             return result;                                              \
         }                                                               \
         TypeInfoInsertMethod(&g_TheIntegerTypeInfo, method, srcLoc);     \
@@ -311,5 +311,5 @@ int RT_Integer_RegisterBuiltins(void) {
     INTEGER_METHOD_INSERT(__hash__, 1, 0);
     INTEGER_METHOD_INSERT(__dbg__, 1, 0);
     INTEGER_METHOD_INSERT(is_nan, 1, 0);
-    return R_OK;
+    return R_Success;
 }
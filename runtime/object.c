@@ -100,7 +100,7 @@ static struct Value *rt_Object_is_nan(struct Module *module, unsigned int argc,
     do {                                                                \
         struct Value *method;                                           \
         int result = FunctionMaker(&method, XSTR(name), numArgs, isVarArgs, GLUE2(rt_Object_, name)); \
-        if (R_OK != result) {                                           \
+        if (R_Success != result) {                                           \
             return result;                                              \
         }                                                               \
         TypeInfoInsertMethod(&g_TheBaseObjectTypeInfo, method, srcLoc);     \
@@ -131,5 +131,5 @@ int RT_Object_RegisterBuiltins(void) {
     OBJECT_METHOD_INSERT(__dbg__, 1, 0);
     OBJECT_METHOD_INSERT(new, 1, 0);
     OBJECT_METHOD_INSERT(is_nan, 1, 0);
-    return R_OK;
+    return R_Success;
 }
@@ -0,0 +1,120 @@
+#include "parallel.h"
+#include "globals.h"
+#include "interpreter.h"
+#include "isolate.h"
+#include "thread_pool.h"
+#include "result.h"
+
+#include "runtime/gc.h"
+
+#include <stdlib.h>
+
+/* Chunks per worker, small enough to even out uneven calls. */
+#define PARALLEL_CHUNKS_PER_WORKER 8U
+
+struct ParallelJob {
+    struct Module *Module;
+    struct Value *Fn;
+    /* Arguments, or NULL to pass Start + i. */
+    struct Value **Values;
+    int Start;
+    /* Where results go, or NULL to drop them. */
+    struct Value **Results;
+    struct Isolate *Workers;
+    struct SrcLoc SrcLoc;
+};
+
+static void ParallelRange(void *context, unsigned int worker, unsigned int begin, unsigned int end) {
+    struct ParallelJob *job = context;
+    struct Isolate *previous = IsolateCurrent();
+    struct Isolate *isolate = &job->Workers[worker];
+    struct Module *module;
+    struct Value *arg, *result;
+    unsigned int i;
+    IsolateEnter(isolate);
+    module = IsolateModuleFor(isolate, job->Module);
+    for (i = begin; i < end; ++i) {
+        if (job->Values) {
+            ValueDuplicate(&arg, job->Values[i]);
+        }
+        else {
+            ValueMakeInteger(&arg, job->Start + (int)i);
+        }
+        result = InterpreterCall(module, job->Fn, 1, &arg, job->SrcLoc);
+        if (job->Results) {
+            job->Results[i] = result;
+        }
+    }
+    IsolateExit(isolate);
+    if (previous) {
+        IsolateEnter(previous);
+    }
+}
+
+static int ParallelRun(struct ParallelJob *job, unsigned int length) {
+    struct ThreadPool *pool = ThreadPoolShared();
+    struct Isolate *parent = IsolateCurrent();
+    unsigned int i, numWorkers = ThreadPoolSize(pool), grain;
+    unsigned int wasDisabled = GC_isDisabled();
+    int result;
+
+    /* A worker must never be the one to run a lazily imported module. */
+    if (&g_TheFunctionTypeInfo == job->Fn->TypeInfo) {
+        InterpreterInitImports(job->Fn->v.Function->OwnerModule);
+    }
+    job->Workers = malloc(sizeof *job->Workers * numWorkers);
+    for (i = 0; i < numWorkers; ++i) {
+        IsolateMakeWorker(&job->Workers[i], parent);
+    }
+    /* Nothing the workers allocate is visible to our roots until they
+       are joined. */
+    GC_Disable();
+    grain = length / (numWorkers * PARALLEL_CHUNKS_PER_WORKER);
+    result = ThreadPoolParallelFor(pool, 0, length, grain ? grain : 1, ParallelRange, job);
+    for (i = 0; i < numWorkers; ++i) {
+        IsolateJoinWorker(&job->Workers[i]);
+    }
+    if (!wasDisabled) {
+        GC_Enable();
+    }
+    free(job->Workers);
+    job->Workers = NULL;
+    return result;
+}
+
+/********************* Public Functions **********************/
+
+int ParallelIsCallable(struct Value *value) {
+    return value && (value->IsBuiltInFn || &g_TheFunctionTypeInfo == value->TypeInfo);
+}
+
+int ParallelMap(struct Module *module, struct Value *fn, struct Value **values, unsigned int length, struct Value **out_results, struct SrcLoc srcLoc) {
+    struct ParallelJob job;
+    if (!module || !ParallelIsCallable(fn) || !values || !out_results) {
+        return R_InvalidArgument;
+    }
+    job.Module = module;
+    job.Fn = fn;
+    job.Values = values;
+    job.Start = 0;
+    job.Results = out_results;
+    job.SrcLoc = srcLoc;
+    return ParallelRun(&job, length);
+}
+
+int ParallelFor(struct Module *module, struct Value *fn, int start, int end, struct SrcLoc srcLoc) {
+    struct ParallelJob job;
+    if (!module || !ParallelIsCallable(fn)) {
+        return R_InvalidArgument;
+    }
+    if (end <= start) {
+        return R_Success;
+    }
+    job.Module = module;
+    job.Fn = fn;
+    job.Values = NULL;
+    job.Start = start;
+    job.Results = NULL;
+    job.SrcLoc = srcLoc;
+    return ParallelRun(&job, (unsigned int)(end - start));
+}
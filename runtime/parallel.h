@@ -0,0 +1,19 @@
+#ifndef _LITTLE_LANG_RUNTIME_PARALLEL_H
+#define _LITTLE_LANG_RUNTIME_PARALLEL_H
+
+#include "value.h"
+#include "little_lang_machine.h"
+
+/* Returns true if value can be passed to the parallel builtins. */
+int ParallelIsCallable(struct Value *value);
+
+/* Calls fn once for each of values[0..length) on the shared thread pool,
+   out_results[i] receives the result for values[i]. fn runs in a scope of
+   its own under the module scope, see IsolateMakeWorker for what it may
+   share. */
+int ParallelMap(struct Module *module, struct Value *fn, struct Value **values, unsigned int length, struct Value **out_results, struct SrcLoc srcLoc);
+
+/* Calls fn(i) for every i in [start, end) on the shared thread pool. */
+int ParallelFor(struct Module *module, struct Value *fn, int start, int end, struct SrcLoc srcLoc);
+
+#endif
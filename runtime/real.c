@@ -1,4 +1,5 @@
 
+#include "real.h"
 #include "registrar.h"
 #include "type_info.h"
 #include "globals.h"
@@ -15,7 +16,6 @@ static struct SrcLoc srcLoc = {"real.c", -1, -1};
 #define IS_INTEGER(v) ((v)->TypeInfo == &g_TheIntegerTypeInfo)
 #define IS_REAL(v) ((v)->TypeInfo == &g_TheRealTypeInfo)
 #define IS_NUMERIC(v) (IS_INTEGER(v) || IS_REAL(v))
-#define REAL_EPSILON (1e-16)
 
 static struct Value *rt_Real___add__(struct Module *module, unsigned int argc, struct Value **argv) {
     struct Value *self = argv[0];
@@ -215,7 +215,7 @@ static struct Value *rt_Real_is_nan(struct Module *module, unsigned int argc, st
     do {                                                                \
         struct Value *method;                                           \
         int result = FunctionMaker(&method, XSTR(name), numArgs, isVarArgs, GLUE2(rt_Real_, name)); \
-        if (R_OK != result) {                                           \
+        if (R_Success != result) {                                           \
             return result;                                              \
         }                                                               \
         TypeInfoInsertMethod(&g_TheRealTypeInfo, method, srcLoc);     \
@@ -236,5 +236,5 @@ int RT_Real_RegisterBuiltins(void) {
     REAL_METHOD_INSERT(__hash__, 1, 0);
     REAL_METHOD_INSERT(__dbg__, 1, 0);
     REAL_METHOD_INSERT(is_nan, 1, 0);
-    return R_OK;
+    return R_Success;
 }
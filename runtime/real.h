@@ -1,6 +1,9 @@
 #ifndef _LITTLE_LANG_RUNTIME_REAL_H
 #define _LITTLE_LANG_RUNTIME_REAL_H
 
+/* Reals closer than this compare equal. */
+#define REAL_EPSILON (1e-16)
+
 int RT_Real_RegisterBuiltins(void);
 
 #endif
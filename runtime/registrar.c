@@ -11,6 +11,7 @@
 #include "runtime/vector.h"
 #include "runtime/function.h"
 #include "runtime/builtinfn.h"
+#include "runtime/generator.h"
 
 #include <stdlib.h>
 
@@ -25,7 +26,8 @@ int RegisterRuntimes(void) {
     RT_Vector_RegisterBuiltins();
     RT_Function_RegisterBuiltins();
     RT_BuiltinFn_RegisterBuiltins();
-    return R_OK;
+    RT_Generator_RegisterBuiltins();
+    return R_Success;
 }
 
 int FunctionMaker(struct Value **out_value, char *name, unsigned int numArgs, int isVarArgs, BuiltinFnProc_t proc) {
@@ -39,5 +41,5 @@ int FunctionMaker(struct Value **out_value, char *name, unsigned int numArgs, in
     BuiltinFnMake(&fn, name, numArgs, isVarArgs, proc);
     ValueMakeBuiltinFn(value, fn);
     *out_value = value;
-    return R_OK;
+    return R_Success;
 }
@@ -1,15 +1,20 @@
 #include "runtime_core.h"
 #include "globals.h"
+#include "isolate.h"
 #include "result.h"
 #include "symbol_table.h"
 
+#include "heap_profiler.h"
 #include "runtime/gc.h"
+#include "runtime/parallel.h"
 
 #include "helpers/strings.h"
 #include "interpreter.h"
 #include "helpers/macro_helpers.h"
 
+#include <limits.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 BuiltinFnProc_t RT_string;
 BuiltinFnProc_t RT_print;
@@ -17,12 +22,15 @@ BuiltinFnProc_t RT_println;
 BuiltinFnProc_t RT_type;
 BuiltinFnProc_t RT_hash;
 BuiltinFnProc_t RT_dbg;
+BuiltinFnProc_t RT_parallel_for;
 
 BuiltinFnProc_t RT___gc_dump;
 BuiltinFnProc_t RT___gc_reachable;
 BuiltinFnProc_t RT___gc_disable;
 BuiltinFnProc_t RT___gc_enable;
 BuiltinFnProc_t RT___gc_is_disabled;
+BuiltinFnProc_t RT___gc_stats;
+BuiltinFnProc_t RT___heap_profile;
 
 static struct SrcLoc srcLoc = {"<runtime_core.c>", -1, -1};
 
@@ -57,7 +65,7 @@ static struct Value *_rt_type(struct Module *module, unsigned int argc, struct V
     struct Symbol *symbol;
     SymbolTableFindNearest(module->CurrentScope, typeName, &symbol);
     if (!symbol) {
-        SymbolTableFindLocal(g_TheGlobalScope, typeName, &symbol);
+        SymbolTableFindLocal(IsolateCurrent()->GlobalScope, typeName, &symbol);
     }
     return symbol->Value;
 }
@@ -72,6 +80,20 @@ static struct Value *_rt_dbg(struct Module *module, unsigned int argc, struct Va
     return dbg;
 }
 
+static struct Value *_rt_parallel_for(struct Module *module, unsigned int argc, struct Value **argv) {
+    struct Value *start = argv[0], *end = argv[1], *fn = argv[2];
+    if (&g_TheIntegerTypeInfo != start->TypeInfo || &g_TheIntegerTypeInfo != end->TypeInfo) {
+        printf("parallel_for expects Integer bounds\n");
+        return &g_TheNilValue;
+    }
+    if (!ParallelIsCallable(fn)) {
+        printf("parallel_for expects a function\n");
+        return &g_TheNilValue;
+    }
+    ParallelFor(module, fn, start->v.Integer, end->v.Integer, srcLoc);
+    return &g_TheNilValue;
+}
+
 static struct Value *_rt___gc_dump(struct Module *module, unsigned int argc, struct Value **argv) {
     GC_Dump();
     return &g_TheNilValue;
@@ -109,30 +131,133 @@ static struct Value *_rt___gc_is_disabled(struct Module *module, unsigned int ar
     return &g_TheFalseValue;
 }
 
+static struct Value *StatsVector(unsigned int capacity) {
+    struct Value *vector = ValueAlloc();
+    vector->TypeInfo = &g_TheVectorTypeInfo;
+    vector->IsPassByReference = 1;
+    vector->v.Vector = calloc(sizeof *vector->v.Vector, 1);
+    LLVectorMake(vector->v.Vector, capacity);
+    return vector;
+}
+
+/* Integers are only 32 bits, bigger counts become Reals. */
+static struct Value *StatsNumber(unsigned long long n) {
+    struct Value *value;
+    if (n > INT_MAX) {
+        ValueMakeReal(&value, (double)n);
+    }
+    else {
+        ValueMakeInteger(&value, (int)n);
+    }
+    return value;
+}
+
+static void StatsAppend(struct Value *stats, char *name, struct Value *value) {
+    struct Value *pair = StatsVector(2), *key;
+    ValueMakeLLStringWithCString(&key, name);
+    LLVectorAppendValue(pair->v.Vector, key);
+    LLVectorAppendValue(pair->v.Vector, value);
+    LLVectorAppendValue(stats->v.Vector, pair);
+}
+
+static struct Value *StatsMilliseconds(unsigned long long ns) {
+    struct Value *value;
+    ValueMakeReal(&value, ns / 1e6);
+    return value;
+}
+
+/* The collector's totals as a Vector of [name, value] pairs. */
+static struct Value *_rt___gc_stats(struct Module *module, unsigned int argc, struct Value **argv) {
+    const struct GC_Stats *gc = GC_GetStats();
+    struct Value *stats, *histogram;
+    unsigned long objectBytes = GC_ObjectBytes();
+    unsigned int i, wasDisabled = GC_isDisabled();
+    /* Nothing made here is reachable until it is returned. */
+    GC_Disable();
+    stats = StatsVector(16);
+    StatsAppend(stats, "collections", StatsNumber(gc->Collections));
+    StatsAppend(stats, "mark_ms", StatsMilliseconds(gc->MarkTime));
+    StatsAppend(stats, "sweep_ms", StatsMilliseconds(gc->SweepTime));
+    StatsAppend(stats, "max_pause_ms", StatsMilliseconds(gc->MaxPause));
+    histogram = StatsVector(ISOLATE_GC_PAUSE_BUCKETS);
+    for (i = 0; i < ISOLATE_GC_PAUSE_BUCKETS; ++i) {
+        LLVectorAppendValue(histogram->v.Vector, StatsNumber(gc->PauseHistogram[i]));
+    }
+    StatsAppend(stats, "pause_histogram", histogram);
+    StatsAppend(stats, "objects_allocated", StatsNumber(gc->ObjectsAllocated));
+    StatsAppend(stats, "objects_freed", StatsNumber(gc->ObjectsFreed));
+    StatsAppend(stats, "objects_survived", StatsNumber(gc->ObjectsSurvived));
+    StatsAppend(stats, "last_survived", StatsNumber(gc->LastSurvived));
+    StatsAppend(stats, "peak_objects", StatsNumber(gc->PeakObjects));
+    StatsAppend(stats, "bytes_allocated", StatsNumber(gc->ObjectsAllocated * objectBytes));
+    StatsAppend(stats, "bytes_freed", StatsNumber(gc->ObjectsFreed * objectBytes));
+    StatsAppend(stats, "bytes_survived", StatsNumber(gc->ObjectsSurvived * objectBytes));
+    StatsAppend(stats, "peak_bytes", StatsNumber((unsigned long long)gc->PeakObjects * objectBytes));
+    if (!wasDisabled) {
+        GC_Enable();
+    }
+    return stats;
+}
+static struct Value *_rt___heap_profile(struct Module *module, unsigned int argc, struct Value **argv) {
+    if (!g_HeapProfilerEnabled) {
+        printf("The heap is not being profiled, run with --heap-profile.\n");
+        return &g_TheNilValue;
+    }
+    fflush(stdout);
+    HeapProfilerReport(stdout);
+    return &g_TheNilValue;
+}
+
+#define RT_FUNCTION_INIT(name)                                          \
+    GLUE2(RT_, name) = GLUE2(_rt_, name)
 
-#define GLOBAL_FUNCTION_INSERT(name, numArgs, isVarArgs)                \
+#define GLOBAL_FUNCTION_INSERT(scope, name, numArgs, isVarArgs)         \
     do {                                                                \
         struct Value *func;                                             \
         struct BuiltinFn *fn;                                           \
-        GLUE2(RT_, name) = GLUE2(_rt_, name);                           \
         func = ValueAllocNoGC();                                        \
         BuiltinFnMake(&fn, XSTR(name), numArgs, isVarArgs, GLUE2(RT_, name)); \
         ValueMakeBuiltinFn(func, fn);                                  \
-        SymbolTableInsert(g_TheGlobalScope, func, fn->Name, 0, srcLoc); \
+        SymbolTableInsert(scope, func, fn->Name, 0, srcLoc);            \
     } while (0)
 
 int RegisterRuntime_core(void) {
-    GLOBAL_FUNCTION_INSERT(print, 0, 1);
-    GLOBAL_FUNCTION_INSERT(println, 0, 1);
-    GLOBAL_FUNCTION_INSERT(string, 1, 0);
-    GLOBAL_FUNCTION_INSERT(type, 1, 0);
-    GLOBAL_FUNCTION_INSERT(hash, 1, 0);
-    GLOBAL_FUNCTION_INSERT(dbg, 1, 0);
-
-    GLOBAL_FUNCTION_INSERT(__gc_dump, 0, 0);
-    GLOBAL_FUNCTION_INSERT(__gc_reachable, 0, 0);
-    GLOBAL_FUNCTION_INSERT(__gc_enable, 0, 0);
-    GLOBAL_FUNCTION_INSERT(__gc_disable, 0, 0);
-    GLOBAL_FUNCTION_INSERT(__gc_is_disabled, 0, 0);
-    return R_OK;
+    RT_FUNCTION_INIT(print);
+    RT_FUNCTION_INIT(println);
+    RT_FUNCTION_INIT(string);
+    RT_FUNCTION_INIT(type);
+    RT_FUNCTION_INIT(hash);
+    RT_FUNCTION_INIT(dbg);
+    RT_FUNCTION_INIT(parallel_for);
+
+    RT_FUNCTION_INIT(__gc_dump);
+    RT_FUNCTION_INIT(__gc_reachable);
+    RT_FUNCTION_INIT(__gc_enable);
+    RT_FUNCTION_INIT(__gc_disable);
+    RT_FUNCTION_INIT(__gc_is_disabled);
+    RT_FUNCTION_INIT(__gc_stats);
+    RT_FUNCTION_INIT(__heap_profile);
+    return R_Success;
+}
+
+int RegisterRuntime_coreGlobals(struct SymbolTable *globalScope) {
+    if (!globalScope) {
+        return R_InvalidArgument;
+    }
+    GLOBAL_FUNCTION_INSERT(globalScope, print, 0, 1);
+    GLOBAL_FUNCTION_INSERT(globalScope, println, 0, 1);
+    GLOBAL_FUNCTION_INSERT(globalScope, string, 1, 0);
+    GLOBAL_FUNCTION_INSERT(globalScope, type, 1, 0);
+    GLOBAL_FUNCTION_INSERT(globalScope, hash, 1, 0);
+    GLOBAL_FUNCTION_INSERT(globalScope, dbg, 1, 0);
+    GLOBAL_FUNCTION_INSERT(globalScope, parallel_for, 3, 0);
+
+    GLOBAL_FUNCTION_INSERT(globalScope, __gc_dump, 0, 0);
+    GLOBAL_FUNCTION_INSERT(globalScope, __gc_reachable, 0, 0);
+    GLOBAL_FUNCTION_INSERT(globalScope, __gc_enable, 0, 0);
+    GLOBAL_FUNCTION_INSERT(globalScope, __gc_disable, 0, 0);
+    GLOBAL_FUNCTION_INSERT(globalScope, __gc_is_disabled, 0, 0);
+    GLOBAL_FUNCTION_INSERT(globalScope, __gc_stats, 0, 0);
+    GLOBAL_FUNCTION_INSERT(globalScope, __heap_profile, 0, 0);
+    return R_Success;
 }
@@ -10,13 +10,19 @@ extern BuiltinFnProc_t RT_println;
 extern BuiltinFnProc_t RT_type;
 extern BuiltinFnProc_t RT_hash;
 extern BuiltinFnProc_t RT_dbg;
+extern BuiltinFnProc_t RT_parallel_for;
 
 extern BuiltinFnProc_t RT___gc_dump;
 extern BuiltinFnProc_t RT___gc_reachable;
 extern BuiltinFnProc_t RT___gc_disable;
 extern BuiltinFnProc_t RT___gc_enable;
 extern BuiltinFnProc_t RT___gc_is_disabled;
+extern BuiltinFnProc_t RT___gc_stats;
+extern BuiltinFnProc_t RT___heap_profile;
 
 int RegisterRuntime_core(void);
 
+/* Binds the core functions, e.g. `println', in an isolate's global scope. */
+int RegisterRuntime_coreGlobals(struct SymbolTable *globalScope);
+
 #endif
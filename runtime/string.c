@@ -83,7 +83,7 @@ static struct Value *rt_String_new(struct Module *module, unsigned int argc, str
     do {                                                                \
         struct Value *method;                                           \
         int result = FunctionMaker(&method, XSTR(name), numArgs, isVarArgs, GLUE2(rt_String_, name)); \
-        if (R_OK != result) {                                           \
+        if (R_Success != result) {                                           \
             return result;                                              \
         }                                                               \
         TypeInfoInsertMethod(&g_TheStringTypeInfo, method, srcLoc);     \
@@ -99,5 +99,5 @@ int RT_String_RegisterBuiltins(void) {
     STRING_METHOD_INSERT(__dbg__, 1, 0);
     STRING_METHOD_INSERT(length, 1, 0);
     STRING_METHOD_INSERT(new, 2, 0);
-    return R_OK;
+    return R_Success;
 }
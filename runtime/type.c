@@ -4,6 +4,7 @@
 #include "helpers/macro_helpers.h"
 #include "helpers/strings.h"
 #include "interpreter.h"
+#include "runtime/gc.h"
 
 #include "result.h"
 
@@ -34,12 +35,15 @@ static struct Value *rt_Type_new(struct Module *module, unsigned int argc, struc
     TypeInfoLookupMethod(value->TypeInfo, "new", &func);
     if (func) {
         argv[0] = value;
+        /* Only argv knows about it while new runs. */
+        GC_PushRoot(value);
         if (func->IsBuiltInFn) {
             InterpreterDoCallBuiltinFn(module, func, argc, argv, srcLoc);
         }
         else {
             InterpreterDoCallFunction(module, func, argc, argv, srcLoc);
         }
+        GC_PopRoots(1);
     }
     return value;
 }
@@ -60,7 +64,7 @@ static struct Value *rt_Type___dbg__(struct Module *module, unsigned int argc, s
     do {                                                                \
         struct Value *method;                                           \
         int result = FunctionMaker(&method, XSTR(name), numArgs, isVarArgs, GLUE2(rt_Type_, name)); \
-        if (R_OK != result) {                                           \
+        if (R_Success != result) {                                           \
             return result;                                              \
         }                                                               \
         TypeInfoInsertMethod(&g_TheTypeTypeInfo, method, srcLoc);     \
@@ -70,5 +74,5 @@ int RT_Type_RegisterBuiltins(void) {
     TYPE_METHOD_INSERT(new, 0, 1);
     TYPE_METHOD_INSERT(__str__, 1, 0);
     TYPE_METHOD_INSERT(__dbg__, 1, 0);
-    return R_OK;
+    return R_Success;
 }
@@ -4,6 +4,8 @@
 #include "interpreter.h"
 #include "helpers/macro_helpers.h"
 #include "runtime/string.h"
+#include "runtime/parallel.h"
+#include "runtime/gc.h"
 
 #include "result.h"
 
@@ -51,7 +53,8 @@ static struct Value *rt_Vector___index__(struct Module *module, unsigned int arg
     }
     ptrToValue = ValueAlloc();
     ptrToValue->IsPtrToValue = 1;
-    ptrToValue->v.PtrToValue = &(self->v.Vector->Values[i]);
+    ptrToValue->v.Vector = self->v.Vector;
+    ptrToValue->ElementIndex = (unsigned)i;
     return ptrToValue;
 }
 
@@ -66,6 +69,24 @@ static struct Value *rt_Vector___lshift__(struct Module *module, unsigned int ar
     return rt_Vector_push_back(module, argc, argv);
 }
 
+static struct Value *rt_Vector_parallel_map(struct Module *module, unsigned int argc, struct Value **argv) {
+    struct Value *result, *self = argv[0], *fn = argv[1];
+    unsigned int length = self->v.Vector->Length;
+    if (!ParallelIsCallable(fn)) {
+        printf("%s.parallel_map expects a function\n", self->TypeInfo->TypeName);
+        return &g_TheNilValue;
+    }
+    result = ValueAlloc();
+    result->TypeInfo = &g_TheVectorTypeInfo;
+    result->IsPassByReference = 1;
+    result->v.Vector = calloc(sizeof *result->v.Vector, 1);
+    LLVectorMake(result->v.Vector, length ? length : 1);
+    result->v.Vector->Length = length;
+    result->v.Vector->Index = length;
+    ParallelMap(module, fn, self->v.Vector->Values, length, result->v.Vector->Values, srcLoc);
+    return result;
+}
+
 static struct Value *rt_Vector___str__(struct Module *module, unsigned int argc, struct Value **argv) {
     unsigned int i;
     struct Value *close, *sep, *other, *string, *self = argv[0];
@@ -74,8 +95,14 @@ static struct Value *rt_Vector___str__(struct Module *module, unsigned int argc,
     ValueMakeLLStringWithCString(&string, "[");
     ValueMakeLLStringWithCString(&close, "]");
     ValueMakeLLStringWithCString(&sep, ", ");
+    /* An element's __str__ may collect. */
+    GC_PushRoot(self);
+    GC_PushRoot(close);
+    GC_PushRoot(sep);
     for (i = 0; i < v->Length; ++i) {
+        GC_PushRoot(string);
         other = InterpreterDispatchMethod(module, v->Values[i], "__str__", 0, NULL, srcLoc);
+        GC_PopRoots(1);
         strArgv[0] = string;
         strArgv[1] = other;
         string = RT_String_Concat(module, 2, strArgv);
@@ -86,6 +113,7 @@ static struct Value *rt_Vector___str__(struct Module *module, unsigned int argc,
             string = RT_String_Concat(module, 2, strArgv);
         }
     }
+    GC_PopRoots(3);
     strArgv[0] = string;
     strArgv[1] = close;
     string = RT_String_Concat(module, 2, strArgv);
@@ -101,7 +129,7 @@ static struct Value *rt_Vector___dbg__(struct Module *module, unsigned int argc,
     do {                                                                \
         struct Value *method;                                           \
         int result = FunctionMaker(&method, XSTR(name), numArgs, isVarArgs, GLUE2(rt_Vector_, name)); \
-        if (R_OK != result) {                                           \
+        if (R_Success != result) {                                           \
             return result;                                              \
         }                                                               \
         TypeInfoInsertMethod(&g_TheVectorTypeInfo, method, srcLoc);     \
@@ -115,5 +143,6 @@ int RT_Vector_RegisterBuiltins(void) {
     VECTOR_METHOD_INSERT(push_back, 2, 0);
     VECTOR_METHOD_INSERT(length, 1, 0);
     VECTOR_METHOD_INSERT(new, 1, 1);
-    return R_OK;
+    VECTOR_METHOD_INSERT(parallel_map, 2, 0);
+    return R_Success;
 }
@@ -1,11 +1,63 @@
 #include "ast.h"
 #include "result.h"
 #include "globals.h"
+#include "value.h"
 
 #include "helpers/strings.h"
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+
+#define AST_ARENA_BLOCK_SIZE (64U * 1024U)
+#define AST_ARENA_ALIGN(n) (((n) + 7U) & ~7U)
+
+struct AstArenaBlock {
+    struct AstArenaBlock *Next;
+};
+
+static __thread struct AstArena *TheCurrentArena;
+
+/* Requests bigger than a quarter block get a block of their own so the
+   rest of the current block is not wasted. */
+static void *AstArenaAlloc(struct AstArena *arena, size_t size) {
+    struct AstArenaBlock *block;
+    size_t blockSize;
+    char *mem;
+    size = AST_ARENA_ALIGN(size);
+    if (size <= (size_t)(arena->End - arena->Next)) {
+        mem = arena->Next;
+        arena->Next += size;
+        return mem;
+    }
+    blockSize = AST_ARENA_ALIGN(sizeof *block);
+    if (size > AST_ARENA_BLOCK_SIZE / 4) {
+        block = malloc(blockSize + size);
+        if (arena->Blocks) {
+            block->Next = arena->Blocks->Next;
+            arena->Blocks->Next = block;
+        }
+        else {
+            block->Next = NULL;
+            arena->Blocks = block;
+        }
+        return (char*)block + blockSize;
+    }
+    block = malloc(AST_ARENA_BLOCK_SIZE);
+    block->Next = arena->Blocks;
+    arena->Blocks = block;
+    mem = (char*)block + blockSize;
+    arena->Next = mem + size;
+    arena->End = (char*)block + AST_ARENA_BLOCK_SIZE;
+    return mem;
+}
+
+static char *AstStrdup(struct Ast *ast, const char *str) {
+    if (!ast->InArena) {
+        return strdup(str);
+    }
+    return AstArenaStrdup(TheCurrentArena, str);
+}
 
 void AstExpandChildren(struct Ast *ast) {
     unsigned int i, capChildren = ast->CapChildren;
@@ -17,17 +69,37 @@ void AstExpandChildren(struct Ast *ast) {
     else {
         capChildren *= 2;
     }
-    newChildren = calloc(sizeof *newChildren, capChildren);
+    if (ast->InArena) {
+        newChildren = AstArenaAlloc(TheCurrentArena, sizeof *newChildren * capChildren);
+        memset(newChildren, 0, sizeof *newChildren * capChildren);
+    }
+    else {
+        newChildren = calloc(sizeof *newChildren, capChildren);
+    }
     for (i = 0; i < ast->CapChildren; ++i) {
         newChildren[i] = ast->Children[i];
     }
-    free(ast->Children);
+    if (!ast->InArena) {
+        free(ast->Children);
+    }
     ast->Children = newChildren;
     ast->CapChildren = capChildren;
 }
 
 struct Ast *AstAlloc(unsigned int numChildren) {
-    struct Ast *ast = malloc(sizeof *ast);
+    struct Ast *ast;
+    if (TheCurrentArena) {
+        ast = AstArenaAlloc(TheCurrentArena, sizeof *ast + sizeof *ast->Children * numChildren);
+        ast->InArena = 1;
+        ast->NoScope = 0;
+        ast->CapChildren = numChildren;
+        ast->NumChildren = numChildren;
+        ast->Children = numChildren > 0 ? (struct Ast**)(ast + 1) : NULL;
+        return ast;
+    }
+    ast = malloc(sizeof *ast);
+    ast->InArena = 0;
+    ast->NoScope = 0;
     ast->CapChildren = numChildren;
     ast->NumChildren = ast->CapChildren;
     if (ast->CapChildren > 0) {
@@ -41,13 +113,56 @@ struct Ast *AstAlloc(unsigned int numChildren) {
 
 /************************** Public Functions **************************/
 
+int AstArenaMake(struct AstArena *arena) {
+    if (!arena) {
+        return R_InvalidArgument;
+    }
+    arena->Blocks = NULL;
+    arena->Next = NULL;
+    arena->End = NULL;
+    return R_Success;
+}
+
+int AstArenaFree(struct AstArena *arena) {
+    struct AstArenaBlock *block, *next;
+    if (!arena) {
+        return R_InvalidArgument;
+    }
+    for (block = arena->Blocks; block; block = next) {
+        next = block->Next;
+        free(block);
+    }
+    if (TheCurrentArena == arena) {
+        TheCurrentArena = NULL;
+    }
+    return AstArenaMake(arena);
+}
+
+struct AstArena *AstArenaUse(struct AstArena *arena) {
+    struct AstArena *previous = TheCurrentArena;
+    TheCurrentArena = arena;
+    return previous;
+}
+
+char *AstArenaStrdup(struct AstArena *arena, const char *str) {
+    size_t len = strlen(str) + 1;
+    char *dup = AstArenaAlloc(arena, len);
+    memcpy(dup, str, len);
+    return dup;
+}
 
 int AstFree(struct Ast *ast) {
     unsigned int i;
     if (!ast) {
         return R_InvalidArgument;
     }
+    if (ast->InArena) {
+        return R_Success;
+    }
     for (i = 0; i < ast->NumChildren; ++i) {
+        if (ast->Children[i] && ast->Children[i]->InArena) {
+            continue;
+        }
         if (ast->Children[i] && SymbolNode == ast->Children[i]->Type) {
             free(ast->Children[i]->u.SymbolName);
         }
@@ -55,7 +170,7 @@ int AstFree(struct Ast *ast) {
         free(ast->Children[i]);
     }
     free(ast->Children);
-    return R_OK;
+    return R_Success;
 }
 
 int AstDeepCopy(struct Ast **out_ast, struct Ast *ast) {
@@ -66,8 +181,17 @@ int AstDeepCopy(struct Ast **out_ast, struct Ast *ast) {
     }
     out = AstAlloc(ast->NumChildren);
     out->Type = ast->Type;
+    out->NoScope = ast->NoScope;
     if (SymbolNode == ast->Type) {
-        out->u.SymbolName = strdup(ast->u.SymbolName);
+        out->u.SymbolName = AstStrdup(out, ast->u.SymbolName);
+    }
+    /* Each number node owns its literal, the optimizer frees it when it
+       pools the number. */
+    else if (IntegerNode == ast->Type) {
+        ValueMakeIntegerLiteral(&out->u.Value, ast->u.Value->v.Integer);
+    }
+    else if (RealNode == ast->Type) {
+        ValueMakeRealLiteral(&out->u.Value, ast->u.Value->v.Real);
     }
     else {
         out->u = ast->u;
@@ -78,7 +202,7 @@ int AstDeepCopy(struct Ast **out_ast, struct Ast *ast) {
         out->Children[i] = tmp;
     }
     *out_ast = out;
-    return R_OK;
+    return R_Success;
 }
 
 int AstMakeBoolean(struct Ast **out_ast, struct Value *boolean, struct SrcLoc srcLoc) {
@@ -91,7 +215,7 @@ int AstMakeBoolean(struct Ast **out_ast, struct Value *boolean, struct SrcLoc sr
     ast->u.Value = boolean;
     ast->SrcLoc = srcLoc;
     *out_ast = ast;
-    return R_OK;
+    return R_Success;
 }
 int AstMakeTrue(struct Ast **out_ast, struct SrcLoc srcLoc) {
     return AstMakeBoolean(out_ast, &g_TheTrueValue, srcLoc);
@@ -109,7 +233,7 @@ int AstMakeNil(struct Ast **out_ast, struct SrcLoc srcLoc) {
     ast->u.Value = &g_TheNilValue;
     ast->SrcLoc = srcLoc;
     *out_ast = ast;
-    return R_OK;
+    return R_Success;
 }
 int AstMakeReal(struct Ast **out_ast, struct Value *real, struct SrcLoc srcLoc) {
     struct Ast *ast;
@@ -121,7 +245,7 @@ int AstMakeReal(struct Ast **out_ast, struct Value *real, struct SrcLoc srcLoc)
     ast->u.Value = real;
     ast->SrcLoc = srcLoc;
     *out_ast = ast;
-    return R_OK;
+    return R_Success;
 }
 int AstMakeInteger(struct Ast **out_ast, struct Value *integer, struct SrcLoc srcLoc) {
     struct Ast *ast;
@@ -133,7 +257,7 @@ int AstMakeInteger(struct Ast **out_ast, struct Value *integer, struct SrcLoc sr
     ast->u.Value = integer;
     ast->SrcLoc = srcLoc;
     *out_ast = ast;
-    return R_OK;
+    return R_Success;
 }
 int AstMakeString(struct Ast **out_ast, struct Value *string, struct SrcLoc srcLoc) {
     struct Ast *ast;
@@ -145,7 +269,7 @@ int AstMakeString(struct Ast **out_ast, struct Value *string, struct SrcLoc srcL
     ast->u.Value = string;
     ast->SrcLoc = srcLoc;
     *out_ast = ast;
-    return R_OK;
+    return R_Success;
 }
 int AstMakeSymbol(struct Ast **out_ast, char *name, struct SrcLoc srcLoc) {
     struct Ast *ast;
@@ -154,10 +278,10 @@ int AstMakeSymbol(struct Ast **out_ast, char *name, struct SrcLoc srcLoc) {
     }
     ast = AstAlloc(0);
     ast->Type = SymbolNode;
-    ast->u.SymbolName = strdup(name); /* FIXME: Should this be strdup'd? */
+    ast->u.SymbolName = AstStrdup(ast, name);
     ast->SrcLoc = srcLoc;
     *out_ast = ast;
-    return R_OK;
+    return R_Success;
 }
 int AstMakeFunction(struct Ast **out_ast, struct Value *function, struct SrcLoc srcLoc) {
     struct Ast *ast;
@@ -169,7 +293,7 @@ int AstMakeFunction(struct Ast **out_ast, struct Value *function, struct SrcLoc
     ast->u.Value = function;
     ast->SrcLoc = srcLoc;
     *out_ast = ast;
-    return R_OK;
+    return R_Success;
 }
 int AstMakeImport(struct Ast **out_ast, struct Ast *modName, struct Ast *as, struct SrcLoc srcLoc) {
     struct Ast *ast;
@@ -182,7 +306,7 @@ int AstMakeImport(struct Ast **out_ast, struct Ast *modName, struct Ast *as, str
     ast->Children[1] = as;
     ast->SrcLoc = srcLoc;
     *out_ast = ast;
-    return R_OK;
+    return R_Success;
 }
 
 /* Expressions should be a combination of more expressions and terminals. */
@@ -197,7 +321,7 @@ int AstMakeBinaryOp(struct Ast **out_ast, struct Ast *lhs, enum AstNodeType op,
     ast->Children[1] = rhs;
     ast->SrcLoc = srcLoc;
     *out_ast = ast;
-    return R_OK;
+    return R_Success;
 }
 int AstMakeUnaryOp(struct Ast **out_ast, enum AstNodeType op, struct Ast *value, struct SrcLoc srcLoc) {
     struct Ast *ast;
@@ -209,7 +333,7 @@ int AstMakeUnaryOp(struct Ast **out_ast, enum AstNodeType op, struct Ast *value,
     ast->Children[0] = value;
     ast->SrcLoc = srcLoc;
     *out_ast = ast;
-    return R_OK;
+    return R_Success;
 }
 int AstMakeAssign(struct Ast **out_ast, struct Ast *lValue, struct Ast *rhs, struct SrcLoc srcLoc) {
     struct Ast *ast;
@@ -222,7 +346,7 @@ int AstMakeAssign(struct Ast **out_ast, struct Ast *lValue, struct Ast *rhs, str
     ast->Children[1] = rhs;
     ast->SrcLoc = srcLoc;
     *out_ast = ast;
-    return R_OK;
+    return R_Success;
 }
 int AstMakeArrayIdx(struct Ast **out_ast, struct Ast *postfix, struct Ast *expr, struct SrcLoc srcLoc) {
     struct Ast *ast;
@@ -235,7 +359,7 @@ int AstMakeArrayIdx(struct Ast **out_ast, struct Ast *postfix, struct Ast *expr,
     ast->Children[1] = expr;
     ast->SrcLoc = srcLoc;
     *out_ast = ast;
-    return R_OK;
+    return R_Success;
 }
 int AstMakeMemberAccess(struct Ast **out_ast, struct Ast *postfix, struct Ast *symbol, struct SrcLoc srcLoc) {
     struct Ast *ast;
@@ -248,7 +372,7 @@ int AstMakeMemberAccess(struct Ast **out_ast, struct Ast *postfix, struct Ast *s
     ast->Children[1] = symbol;
     ast->SrcLoc = srcLoc;
     *out_ast = ast;
-    return R_OK;
+    return R_Success;
 }
 int AstMakeCall(struct Ast **out_ast, struct Ast *primary, struct Ast *args, struct SrcLoc srcLoc) {
     struct Ast *ast;
@@ -264,7 +388,7 @@ int AstMakeCall(struct Ast **out_ast, struct Ast *primary, struct Ast *args, str
     ast->Children[1] = args;
     ast->SrcLoc = srcLoc;
     *out_ast = ast;
-    return R_OK;
+    return R_Success;
 }
 int AstMakeReturn(struct Ast **out_ast, struct Ast *expr, struct SrcLoc srcLoc) {
     struct Ast *ast;
@@ -276,7 +400,7 @@ int AstMakeReturn(struct Ast **out_ast, struct Ast *expr, struct SrcLoc srcLoc)
     ast->Children[0] = expr;
     ast->SrcLoc = srcLoc;
     *out_ast = ast;
-    return R_OK;
+    return R_Success;
 }
 int AstMakeContinue(struct Ast **out_ast, struct SrcLoc srcLoc) {
     struct Ast *ast;
@@ -287,7 +411,7 @@ int AstMakeContinue(struct Ast **out_ast, struct SrcLoc srcLoc) {
     ast->Type = ContinueExpr;
     ast->SrcLoc = srcLoc;
     *out_ast = ast;
-    return R_OK;
+    return R_Success;
 }
 int AstMakeBreak(struct Ast **out_ast, struct SrcLoc srcLoc) {
     struct Ast *ast;
@@ -298,9 +422,21 @@ int AstMakeBreak(struct Ast **out_ast, struct SrcLoc srcLoc) {
     ast->Type = BreakExpr;
     ast->SrcLoc = srcLoc;
     *out_ast = ast;
-    return R_OK;
+    return R_Success;
     
 }
+int AstMakeYield(struct Ast **out_ast, struct Ast *expr, struct SrcLoc srcLoc) {
+    struct Ast *ast;
+    if (!out_ast) {
+        return R_InvalidArgument;
+    }
+    ast = AstAlloc(1);
+    ast->Type = YieldExpr;
+    ast->Children[0] = expr;
+    ast->SrcLoc = srcLoc;
+    *out_ast = ast;
+    return R_Success;
+}
 int AstMakeMut(struct Ast **out_ast, struct Ast *names, struct Ast *values, struct SrcLoc srcLoc) {
     struct Ast *ast;
     if (!out_ast || !names) {
@@ -315,7 +451,7 @@ int AstMakeMut(struct Ast **out_ast, struct Ast *names, struct Ast *values, stru
     ast->Children[1] = values;
     ast->SrcLoc = srcLoc;
     *out_ast = ast;
-    return R_OK;
+    return R_Success;
 }
 int AstMakeConst(struct Ast **out_ast, char *name, struct Ast *value, struct SrcLoc srcLoc) {
     struct Ast *ast, *symbolName;
@@ -324,7 +460,7 @@ int AstMakeConst(struct Ast **out_ast, char *name, struct Ast *value, struct Src
         return R_InvalidArgument;
     }
     result = AstMakeSymbol(&symbolName, name, srcLoc);
-    if (R_OK != result) {
+    if (R_Success != result) {
         return result;
     }
     ast = AstAlloc(2);
@@ -333,7 +469,7 @@ int AstMakeConst(struct Ast **out_ast, char *name, struct Ast *value, struct Src
     ast->Children[1] = value;
     ast->SrcLoc = srcLoc;
     *out_ast = ast;
-    return R_OK;
+    return R_Success;
 }
 int AstMakeFor(struct Ast **out_ast, struct Ast *pre, struct Ast *condition, struct Ast *body, struct Ast *post, struct SrcLoc srcLoc) {
     struct Ast *ast;
@@ -348,7 +484,21 @@ int AstMakeFor(struct Ast **out_ast, struct Ast *pre, struct Ast *condition, str
     ast->Children[3] = post;
     ast->SrcLoc = srcLoc;
     *out_ast = ast;
-    return R_OK;
+    return R_Success;
+}
+int AstMakeForIn(struct Ast **out_ast, struct Ast *name, struct Ast *iterable, struct Ast *body, struct SrcLoc srcLoc) {
+    struct Ast *ast;
+    if (!out_ast || !name || !iterable) {
+        return R_InvalidArgument;
+    }
+    ast = AstAlloc(3);
+    ast->Type = ForInExpr;
+    ast->Children[0] = name;
+    ast->Children[1] = iterable;
+    ast->Children[2] = body;
+    ast->SrcLoc = srcLoc;
+    *out_ast = ast;
+    return R_Success;
 }
 int AstMakeWhile(struct Ast **out_ast, struct Ast *condition, struct Ast *body, struct SrcLoc srcLoc) {
     struct Ast *ast;
@@ -361,7 +511,7 @@ int AstMakeWhile(struct Ast **out_ast, struct Ast *condition, struct Ast *body,
     ast->Children[1] = body;
     ast->SrcLoc = srcLoc;
     *out_ast = ast;
-    return R_OK;
+    return R_Success;
 }
 int AstMakeIfElse(struct Ast **out_ast, struct Ast *condition, struct Ast *body, struct Ast *elseif, struct SrcLoc srcLoc) {
     struct Ast *ast;
@@ -375,7 +525,7 @@ int AstMakeIfElse(struct Ast **out_ast, struct Ast *condition, struct Ast *body,
     ast->Children[2] = elseif;
     ast->SrcLoc = srcLoc;
     *out_ast = ast;
-    return R_OK;
+    return R_Success;
 }
 int AstMakeClass(struct Ast **out_ast, char *className, struct Ast *body, struct SrcLoc srcLoc) {
     struct Ast *ast, *name;
@@ -389,7 +539,7 @@ int AstMakeClass(struct Ast **out_ast, char *className, struct Ast *body, struct
     ast->Children[1] = body;
     ast->SrcLoc = srcLoc;
     *out_ast = ast;
-    return R_OK;
+    return R_Success;
 }
 
 int AstMakeBlank(struct Ast **out_ast) {
@@ -397,10 +547,25 @@ int AstMakeBlank(struct Ast **out_ast) {
     if (!out_ast) {
         return R_InvalidArgument;
     }
-    ast = calloc(sizeof *ast, 1);
+    ast = AstAlloc(0);
+    memset(ast, 0, sizeof *ast);
+    ast->InArena = NULL != TheCurrentArena;
     ast->Type = UNASSIGNED;
     *out_ast = ast;
-    return R_OK;
+    return R_Success;
+}
+
+int AstMakeNode(struct Ast **out_ast, enum AstNodeType type, unsigned int numChildren, struct SrcLoc srcLoc) {
+    struct Ast *ast;
+    if (!out_ast) {
+        return R_InvalidArgument;
+    }
+    ast = AstAlloc(numChildren);
+    ast->Type = type;
+    ast->u.Value = NULL;
+    ast->SrcLoc = srcLoc;
+    *out_ast = ast;
+    return R_Success;
 }
 
 int AstAppendChild(struct Ast *ast, struct Ast *child) {
@@ -408,12 +573,12 @@ int AstAppendChild(struct Ast *ast, struct Ast *child) {
         return R_InvalidArgument;
     }
     if (!child) {
-        return R_OK;
+        return R_Success;
     }
     if (ast->NumChildren == ast->CapChildren) {
         AstExpandChildren(ast);
     }
     ast->Children[ast->NumChildren++] = child;
-    return R_OK;
+    return R_Success;
 }
 
@@ -0,0 +1,109 @@
+#include "coroutine.h"
+#include "result.h"
+
+#include <stdint.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#ifndef MAP_NORESERVE
+#define MAP_NORESERVE 0
+#endif
+
+/* makecontext can only pass ints portably, the entry point picks the
+   coroutine up from here instead. */
+static __thread struct Coroutine *TheStartingCoroutine;
+
+static void CoroutineEntry(void) {
+    struct Coroutine *coroutine = TheStartingCoroutine;
+    coroutine->Proc(coroutine->Arg);
+    coroutine->IsDone = 1;
+    /* Returning switches to uc_link, the resumer. */
+}
+
+/********************* Public Functions **********************/
+
+int CoroutineMake(struct Coroutine *coroutine, CoroutineProc_t proc, void *arg, size_t stackSize) {
+    size_t page;
+    if (!coroutine || !proc || 0 == stackSize) {
+        return R_InvalidArgument;
+    }
+    if (0 != getcontext(&coroutine->Context)) {
+        return R_OperationFailed;
+    }
+    /* Stacks grow down on everything we run on, the guard page below the
+       stack turns an overflow into a fault instead of heap corruption. */
+    page = (size_t)sysconf(_SC_PAGESIZE);
+    stackSize = (stackSize + page - 1) / page * page;
+    coroutine->Stack = mmap(NULL, stackSize + page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (MAP_FAILED == coroutine->Stack) {
+        coroutine->Stack = NULL;
+        return R_AllocFailed;
+    }
+    if (0 != mprotect(coroutine->Stack, page, PROT_NONE)) {
+        munmap(coroutine->Stack, stackSize + page);
+        coroutine->Stack = NULL;
+        return R_OperationFailed;
+    }
+    coroutine->StackSize = stackSize + page;
+    coroutine->Proc = proc;
+    coroutine->Arg = arg;
+    coroutine->IsRunning = 0;
+    coroutine->IsDone = 0;
+    coroutine->Context.uc_stack.ss_sp = (char*)coroutine->Stack + page;
+    coroutine->Context.uc_stack.ss_size = stackSize;
+    coroutine->Context.uc_link = &coroutine->Resumer;
+    makecontext(&coroutine->Context, CoroutineEntry, 0);
+    return R_Success;
+}
+
+int CoroutineFree(struct Coroutine *coroutine) {
+    if (!coroutine || coroutine->IsRunning) {
+        return R_InvalidArgument;
+    }
+    if (coroutine->Stack) {
+        munmap(coroutine->Stack, coroutine->StackSize);
+    }
+    coroutine->Stack = NULL;
+    coroutine->StackSize = 0;
+    return R_Success;
+}
+
+int CoroutineResume(struct Coroutine *coroutine) {
+    if (!coroutine || coroutine->IsRunning || coroutine->IsDone) {
+        return R_InvalidArgument;
+    }
+    coroutine->IsRunning = 1;
+    TheStartingCoroutine = coroutine;
+    if (0 != swapcontext(&coroutine->Resumer, &coroutine->Context)) {
+        coroutine->IsRunning = 0;
+        return R_OperationFailed;
+    }
+    coroutine->IsRunning = 0;
+    return R_Success;
+}
+
+int CoroutineYield(struct Coroutine *coroutine) {
+    if (!coroutine || !coroutine->IsRunning) {
+        return R_InvalidArgument;
+    }
+    if (0 != swapcontext(&coroutine->Context, &coroutine->Resumer)) {
+        return R_OperationFailed;
+    }
+    return R_Success;
+}
+
+int CoroutineStackLeft(struct Coroutine *coroutine, size_t *out_left) {
+    char here;
+    uintptr_t sp = (uintptr_t)&here;
+    uintptr_t bottom, top;
+    if (!coroutine || !out_left || !coroutine->IsRunning) {
+        return R_InvalidArgument;
+    }
+    bottom = (uintptr_t)coroutine->Context.uc_stack.ss_sp;
+    top = bottom + coroutine->Context.uc_stack.ss_size;
+    if (sp < bottom || sp >= top) {
+        return R_InvalidArgument;
+    }
+    *out_left = sp - bottom;
+    return R_Success;
+}
@@ -10,7 +10,7 @@
 
 #define RETURN_ON_FAIL(r)                       \
     do {                                        \
-        if (R_OK != (r)) {                      \
+        if (R_Success != (r)) {                      \
             return r;                           \
         }                                       \
     } while (0)
@@ -28,36 +28,41 @@ struct TypeInfo g_TheRealTypeInfo;
 struct TypeInfo g_TheStringTypeInfo;
 struct TypeInfo g_TheBooleanTypeInfo;
 struct TypeInfo g_TheVectorTypeInfo;
+struct TypeInfo g_TheGeneratorTypeInfo;
 
 struct TypeTable g_TheGlobalTypeTable;
 
-struct SymbolTable *g_TheGlobalScope;
-struct SymbolTable g_TheUberScope;
-
 static struct SrcLoc srcLoc = {"<globals.c>", -1, -1};
 
-#define MAKE_TYPEINFO_AND_CONSTANT(name, type)                          \
+#define MAKE_TYPEINFO(name, type)                                       \
     do {                                                                \
         struct TypeInfo *ti = &GLUE3(g_The, name, TypeInfo);            \
-        struct Value *v;                                                \
         int result = TypeInfoMake(ti, type, &g_TheBaseObjectTypeInfo, XSTR(name)); \
         RETURN_ON_FAIL(result);                                         \
+    } while (0)
+
+#define INSERT_TYPE_CONSTANT(scope, name)                               \
+    do {                                                                \
+        struct TypeInfo *ti = &GLUE3(g_The, name, TypeInfo);            \
+        struct Value *v;                                                \
+        int result;                                                     \
         ValueMakeType(&v, ti);                                          \
-        result = SymbolTableInsert(g_TheGlobalScope, v, ti->TypeName, 0, srcLoc); \
+        result = SymbolTableInsert(scope, v, ti->TypeName, 0, srcLoc);  \
         RETURN_ON_FAIL(result);                                         \
     } while (0)
 
 static int GlobalsInitTypeInfos(void) {
-    MAKE_TYPEINFO_AND_CONSTANT(BaseObject, TypeBaseObject);
-    MAKE_TYPEINFO_AND_CONSTANT(Type, TypeType);
-    MAKE_TYPEINFO_AND_CONSTANT(Function, TypeFunction);
-    MAKE_TYPEINFO_AND_CONSTANT(BuiltinFn, TypeFunction);
-    MAKE_TYPEINFO_AND_CONSTANT(Integer, TypeInteger);
-    MAKE_TYPEINFO_AND_CONSTANT(Real, TypeReal);
-    MAKE_TYPEINFO_AND_CONSTANT(String, TypeString);
-    MAKE_TYPEINFO_AND_CONSTANT(Boolean, TypeBoolean);
-    MAKE_TYPEINFO_AND_CONSTANT(Vector, TypeVector);
-    return R_OK;
+    MAKE_TYPEINFO(BaseObject, TypeBaseObject);
+    MAKE_TYPEINFO(Type, TypeType);
+    MAKE_TYPEINFO(Function, TypeFunction);
+    MAKE_TYPEINFO(BuiltinFn, TypeFunction);
+    MAKE_TYPEINFO(Integer, TypeInteger);
+    MAKE_TYPEINFO(Real, TypeReal);
+    MAKE_TYPEINFO(String, TypeString);
+    MAKE_TYPEINFO(Boolean, TypeBoolean);
+    MAKE_TYPEINFO(Vector, TypeVector);
+    MAKE_TYPEINFO(Generator, TypeGenerator);
+    return R_Success;
 }
 
 static int GlobalsInitSingletonValues(void) {
@@ -71,16 +76,7 @@ static int GlobalsInitSingletonValues(void) {
     result = ValueMakeSingleton(&g_TheNilValue, &g_TheBaseObjectTypeInfo);
     RETURN_ON_FAIL(result);
 
-    return R_OK;
-}
-
-static int GlobalsInitGlobalScope(void) {
-    int result;
-    g_TheGlobalScope = calloc(sizeof *g_TheGlobalScope, 1);
-    result = SymbolTableMakeGlobalScope(g_TheGlobalScope);
-    g_TheUberScope.Child = g_TheGlobalScope;
-    g_TheGlobalScope->Parent = &g_TheUberScope;
-    return result;
+    return R_Success;
 }
 
 static int GlobalsInitGlobalTypeInfo(void) {
@@ -102,7 +98,7 @@ static int GlobalsInitGlobalTypeInfo(void) {
     RETURN_ON_FAIL(result);
     result = TypeTableInsert(&g_TheGlobalTypeTable, &g_TheBooleanTypeInfo);
     RETURN_ON_FAIL(result);
-    return R_OK;
+    return R_Success;
 }
 
 static int __globalValuesInitialized = 0;
@@ -111,9 +107,6 @@ int GlobalsInit(void) {
     if (__globalValuesInitialized) {
         return R_GlobalsAlreadyInitted;
     }
-    result = GlobalsInitGlobalScope();
-    RETURN_ON_FAIL(result);
-
     result = GlobalsInitTypeInfos();
     RETURN_ON_FAIL(result);
 
@@ -124,7 +117,7 @@ int GlobalsInit(void) {
     RETURN_ON_FAIL(result);
 
     __globalValuesInitialized = 1;
-    return R_OK;
+    return R_Success;
 }
 
 int GlobalsDenit(void) {
@@ -132,11 +125,6 @@ int GlobalsDenit(void) {
     if (!__globalValuesInitialized) {
         return R_OperationFailed;
     }
-    g_TheUberScope.Child = NULL;
-    
-    result = SymbolTableFree(g_TheGlobalScope);
-    RETURN_ON_FAIL(result);
-
     result = TypeInfoFree(&g_TheBaseObjectTypeInfo);
     RETURN_ON_FAIL(result);
     result = TypeInfoFree(&g_TheFunctionTypeInfo);
@@ -152,3 +140,20 @@ int GlobalsDenit(void) {
     result = TypeInfoFree(&g_TheBooleanTypeInfo);
     return result;
 }
+
+int GlobalsInsertTypeConstants(struct SymbolTable *scope) {
+    if (!scope) {
+        return R_InvalidArgument;
+    }
+    INSERT_TYPE_CONSTANT(scope, BaseObject);
+    INSERT_TYPE_CONSTANT(scope, Type);
+    INSERT_TYPE_CONSTANT(scope, Function);
+    INSERT_TYPE_CONSTANT(scope, BuiltinFn);
+    INSERT_TYPE_CONSTANT(scope, Integer);
+    INSERT_TYPE_CONSTANT(scope, Real);
+    INSERT_TYPE_CONSTANT(scope, String);
+    INSERT_TYPE_CONSTANT(scope, Boolean);
+    INSERT_TYPE_CONSTANT(scope, Vector);
+    INSERT_TYPE_CONSTANT(scope, Generator);
+    return R_Success;
+}
@@ -0,0 +1,299 @@
+#include "heap_profiler.h"
+#include "isolate.h"
+#include "profiler.h"
+#include "runtime/gc.h"
+#include "result.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define HEAP_PROFILER_INITIAL_SITES 256U
+#define HEAP_PROFILER_TOP_SITES 40U
+
+int g_HeapProfilerEnabled;
+
+struct HeapSite {
+    /* Compared by address, the same file may make more than one site,
+       they are merged when reporting. */
+    const char *FilenameKey;
+    struct BuiltinFn *BuiltinKey;
+    int LineNumber;
+    char *Filename;
+    char *Builtin;
+    unsigned long long Allocated;
+    unsigned long long Freed;
+};
+
+/* One line of a report, sites merged by name. */
+struct HeapSiteTotal {
+    const char *Filename;
+    int LineNumber;
+    const char *Builtin;
+    unsigned long long Allocated;
+    unsigned long long Live;
+};
+
+/* Only the thread running the isolate touches its table. */
+struct HeapSiteTable {
+    struct HeapSite **Sites;
+    unsigned int NumSites;
+    unsigned int Capacity;
+    /* Tables of joined workers, their objects moved here. */
+    struct HeapSiteTable *Next;
+};
+
+static unsigned int HeapSiteHash(const char *filename, int lineNumber, struct BuiltinFn *builtin) {
+    size_t h = (size_t)filename * 31 + (size_t)builtin;
+    h = h * 31 + (unsigned int)lineNumber;
+    return (unsigned int)(h ^ (h >> 16));
+}
+
+static struct HeapSite **HeapSiteSlot(struct HeapSite **sites, unsigned int capacity,
+                                      const char *filename, int lineNumber, struct BuiltinFn *builtin) {
+    unsigned int idx = HeapSiteHash(filename, lineNumber, builtin) & (capacity - 1);
+    struct HeapSite *site;
+    while ((site = sites[idx])) {
+        if (site->FilenameKey == filename && site->LineNumber == lineNumber && site->BuiltinKey == builtin) {
+            break;
+        }
+        idx = (idx + 1) & (capacity - 1);
+    }
+    return &sites[idx];
+}
+
+static struct HeapSiteTable *HeapSiteTableMake(void) {
+    struct HeapSiteTable *table = calloc(1, sizeof *table);
+    if (!table) {
+        return NULL;
+    }
+    table->Sites = calloc(HEAP_PROFILER_INITIAL_SITES, sizeof *table->Sites);
+    if (!table->Sites) {
+        free(table);
+        return NULL;
+    }
+    table->Capacity = HEAP_PROFILER_INITIAL_SITES;
+    return table;
+}
+
+static int HeapSitesGrow(struct HeapSiteTable *table) {
+    unsigned int i, capacity = table->Capacity * 2;
+    struct HeapSite **sites = calloc(capacity, sizeof *sites), *site;
+    if (!sites) {
+        return R_AllocFailed;
+    }
+    for (i = 0; i < table->Capacity; ++i) {
+        if ((site = table->Sites[i])) {
+            *HeapSiteSlot(sites, capacity, site->FilenameKey, site->LineNumber, site->BuiltinKey) = site;
+        }
+    }
+    free(table->Sites);
+    table->Sites = sites;
+    table->Capacity = capacity;
+    return R_Success;
+}
+
+static const char *HeapBasename(const char *path) {
+    const char *slash = strrchr(path, '/');
+    return slash ? slash + 1 : path;
+}
+
+static struct HeapSite *HeapSiteFor(struct HeapSiteTable *table, const char *filename, int lineNumber, struct BuiltinFn *builtin) {
+    struct HeapSite **slot, *site;
+    slot = HeapSiteSlot(table->Sites, table->Capacity, filename, lineNumber, builtin);
+    if (!*slot && (table->NumSites + 1) * 4 > table->Capacity * 3) {
+        if (R_Success != HeapSitesGrow(table)) {
+            return NULL;
+        }
+        slot = HeapSiteSlot(table->Sites, table->Capacity, filename, lineNumber, builtin);
+    }
+    if (!*slot) {
+        site = calloc(1, sizeof *site);
+        if (!site) {
+            return NULL;
+        }
+        site->FilenameKey = filename;
+        site->LineNumber = lineNumber;
+        site->BuiltinKey = builtin;
+        site->Filename = strdup(filename ? HeapBasename(filename) : "<native>");
+        site->Builtin = builtin ? strdup(builtin->Name) : NULL;
+        *slot = site;
+        ++table->NumSites;
+    }
+    return *slot;
+}
+
+static void HeapSiteTableFree(struct HeapSiteTable *table) {
+    struct HeapSite *site;
+    unsigned int i;
+    for (i = 0; i < table->Capacity; ++i) {
+        if ((site = table->Sites[i])) {
+            free(site->Filename);
+            free(site->Builtin);
+            free(site);
+        }
+    }
+    free(table->Sites);
+    free(table);
+}
+
+static int HeapSiteTotalCompareNames(const void *a, const void *b) {
+    const struct HeapSiteTotal *lhs = a, *rhs = b;
+    int cmp = strcmp(lhs->Filename, rhs->Filename);
+    if (cmp) {
+        return cmp;
+    }
+    if (lhs->LineNumber != rhs->LineNumber) {
+        return lhs->LineNumber < rhs->LineNumber ? -1 : 1;
+    }
+    if (!lhs->Builtin || !rhs->Builtin) {
+        return !lhs->Builtin - !rhs->Builtin;
+    }
+    return strcmp(lhs->Builtin, rhs->Builtin);
+}
+
+static int HeapSiteTotalCompareLive(const void *a, const void *b) {
+    const struct HeapSiteTotal *lhs = a, *rhs = b;
+    if (lhs->Live != rhs->Live) {
+        return lhs->Live > rhs->Live ? -1 : 1;
+    }
+    if (lhs->Allocated != rhs->Allocated) {
+        return lhs->Allocated > rhs->Allocated ? -1 : 1;
+    }
+    return HeapSiteTotalCompareNames(a, b);
+}
+
+/*********************** Public Functions ***********************/
+
+struct HeapSite *HeapProfilerAllocated(struct Isolate *isolate) {
+    struct ProfilerThread *thread = &g_ProfilerThread;
+    struct Ast *node = thread->Node;
+    struct Value *function = NULL;
+    struct HeapSite *site;
+    unsigned int depth = thread->Depth;
+    if (!isolate->GC.Sites && !(isolate->GC.Sites = HeapSiteTableMake())) {
+        return NULL;
+    }
+    if (depth && depth <= PROFILER_MAX_DEPTH) {
+        function = thread->Frames[depth - 1];
+    }
+    site = HeapSiteFor(isolate->GC.Sites,
+                       node ? node->SrcLoc.Filename : NULL,
+                       node ? node->SrcLoc.LineNumber : 0,
+                       function && function->IsBuiltInFn ? function->v.BuiltinFn : NULL);
+    if (site) {
+        ++site->Allocated;
+    }
+    return site;
+}
+
+void HeapProfilerFreed(struct HeapSite *site) {
+    ++site->Freed;
+}
+
+void HeapProfilerAdoptSites(struct Isolate *isolate, struct Isolate *from) {
+    struct HeapSiteTable *last = from->GC.Sites;
+    if (!last) {
+        return;
+    }
+    while (last->Next) {
+        last = last->Next;
+    }
+    last->Next = isolate->GC.Sites;
+    isolate->GC.Sites = from->GC.Sites;
+    from->GC.Sites = NULL;
+}
+
+void HeapProfilerFreeSites(struct Isolate *isolate) {
+    struct HeapSiteTable *table, *next;
+    for (table = isolate->GC.Sites; table; table = next) {
+        next = table->Next;
+        HeapSiteTableFree(table);
+    }
+    isolate->GC.Sites = NULL;
+}
+
+int HeapProfilerStart(void) {
+    g_HeapProfilerEnabled = 1;
+    ++g_ProfilerActive;
+    return R_Success;
+}
+
+int HeapProfilerReport(FILE *out) {
+    struct HeapSiteTable *table, *tables = IsolateCurrent()->GC.Sites;
+    struct HeapSiteTotal *totals;
+    struct HeapSite *site;
+    unsigned long long allocated = 0, live = 0;
+    unsigned long objectBytes = GC_ObjectBytes();
+    unsigned int i, numSites = 0, numTotals = 0, merged;
+    char location[256];
+    if (!out) {
+        return R_InvalidArgument;
+    }
+    for (table = tables; table; table = table->Next) {
+        numSites += table->NumSites;
+    }
+    totals = malloc(sizeof *totals * (numSites + 1));
+    if (!totals) {
+        return R_AllocFailed;
+    }
+    for (table = tables; table; table = table->Next) {
+        for (i = 0; i < table->Capacity; ++i) {
+            if (!(site = table->Sites[i])) {
+                continue;
+            }
+            totals[numTotals].Filename = site->Filename;
+            totals[numTotals].LineNumber = site->LineNumber;
+            totals[numTotals].Builtin = site->Builtin;
+            totals[numTotals].Allocated = site->Allocated;
+            totals[numTotals].Live = site->Allocated - site->Freed;
+            allocated += totals[numTotals].Allocated;
+            live += totals[numTotals].Live;
+            ++numTotals;
+        }
+    }
+    qsort(totals, numTotals, sizeof *totals, HeapSiteTotalCompareNames);
+    for (i = 1, merged = numTotals ? 1 : 0; i < numTotals; ++i) {
+        if (0 == HeapSiteTotalCompareNames(&totals[merged - 1], &totals[i])) {
+            totals[merged - 1].Allocated += totals[i].Allocated;
+            totals[merged - 1].Live += totals[i].Live;
+        }
+        else {
+            totals[merged++] = totals[i];
+        }
+    }
+    numTotals = merged;
+    qsort(totals, numTotals, sizeof *totals, HeapSiteTotalCompareLive);
+    fprintf(out, "\nHeap profile, %llu objects (%llu bytes) live of %llu allocated:\n",
+            live, live * objectBytes, allocated);
+    fprintf(out, "%12s %12s %12s  %s\n", "live", "live bytes", "allocated", "site");
+    for (i = 0; i < numTotals && i < HEAP_PROFILER_TOP_SITES; ++i) {
+        if (totals[i].Builtin) {
+            snprintf(location, sizeof location, "%s:%d in %s", totals[i].Filename, totals[i].LineNumber, totals[i].Builtin);
+        }
+        else {
+            snprintf(location, sizeof location, "%s:%d", totals[i].Filename, totals[i].LineNumber);
+        }
+        fprintf(out, "%12llu %12llu %12llu  %s\n",
+                totals[i].Live,
+                totals[i].Live * objectBytes,
+                totals[i].Allocated,
+                location);
+    }
+    if (numTotals > HEAP_PROFILER_TOP_SITES) {
+        fprintf(out, "%u more sites not shown.\n", numTotals - HEAP_PROFILER_TOP_SITES);
+    }
+    free(totals);
+    return R_Success;
+}
+
+int HeapProfilerStop(FILE *out) {
+    if (!g_HeapProfilerEnabled) {
+        return R_InvalidArgument;
+    }
+    g_HeapProfilerEnabled = 0;
+    --g_ProfilerActive;
+    if (out) {
+        return HeapProfilerReport(out);
+    }
+    return R_Success;
+}
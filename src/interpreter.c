@@ -2,9 +2,14 @@
 #include "symbol_table.h"
 #include "module_table.h"
 #include "globals.h"
+#include "isolate.h"
+#include "profiler.h"
+#include "tracer.h"
 #include "runtime/registrar.h"
 #include "runtime/object.h"
 #include "runtime/gc.h"
+#include "runtime/generator.h"
+#include "runtime/real.h"
 #include "value.h"
 #include "result.h"
 
@@ -12,6 +17,7 @@
 #include <stdlib.h>
 #include <math.h>
 #include <string.h>
+#include <pthread.h>
 
 #define DEREF_IF_SYMBOL(s)                      \
     do {                                        \
@@ -19,7 +25,7 @@
             (s) = (s)->v.Symbol->Value;         \
         }                                       \
         else if ((s)->IsPtrToValue) {           \
-            (s) = *(s)->v.PtrToValue;           \
+            (s) = VALUE_ELEMENT(s);             \
         }                                       \
     } while (0)
 
@@ -27,14 +33,26 @@ void at(struct SrcLoc srcLoc) {
     printf(" at %s:%d:%d\n", srcLoc.Filename, srcLoc.LineNumber, srcLoc.ColumnNumber);
 }
 
-static unsigned int IsBreaking = 0;
-static unsigned int IsContinuing = 0;
-static unsigned int IsReturning = 0;
-static unsigned int NumToInjectIntoNextCall;
-static struct Value *InjectIntoNextCall[4];
+/* How a statement finished executing. Loops consume `break' and `continue',
+   function calls consume `return', everything else is passed up to the
+   enclosing statement so no state outlives the frame that produced it. */
+enum Completion {
+    CompletionNormal,
+    CompletionBreak,
+    CompletionContinue,
+    CompletionReturn,
+};
 
 /* Forward declarations. */
 struct Value *InterpreterRunAst(struct Module *module, struct Ast *ast);
+enum Completion InterpreterExecStmt(struct Module *module, struct Ast *ast, struct Value **out_value);
+enum Completion InterpreterExecBody(struct Module *module, struct Ast *ast, struct Value **out_value);
+enum Completion InterpreterExecReturn(struct Module *module, struct Ast *ast, struct Value **out_value);
+enum Completion InterpreterExecYield(struct Module *module, struct Ast *ast, struct Value **out_value);
+enum Completion InterpreterExecFor(struct Module *module, struct Ast *ast, struct Value **out_value);
+enum Completion InterpreterExecForIn(struct Module *module, struct Ast *ast, struct Value **out_value);
+enum Completion InterpreterExecWhile(struct Module *module, struct Ast *ast, struct Value **out_value);
+enum Completion InterpreterExecIfElse(struct Module *module, struct Ast *ast, struct Value **out_value);
 struct Value *InterpreterDoBody(struct Module *module, struct Ast *ast);
 struct Value *InterpreterDoAdd(struct Module *module, struct Ast *ast);
 struct Value *InterpreterDoSub(struct Module *module, struct Ast *ast);
@@ -59,17 +77,17 @@ struct Value *InterpreterDoNegate(struct Module *module, struct Ast *ast);
 struct Value *InterpreterDoLogicNot(struct Module *module, struct Ast *ast);
 struct Value *InterpreterDoAssign(struct Module *module, struct Ast *ast);
 struct Value *InterpreterDoSymbol(struct Module *module, struct Ast *ast);
+static struct Symbol *InterpreterFindSymbol(struct Module *module, struct Ast *ast);
 struct Value *InterpreterDoDefFunction(struct Module *module, struct Ast *ast);
 struct Value *InterpreterDoDefClass(struct Module *module, struct Ast *ast);
 struct Value *InterpreterDoCall(struct Module *module, struct Ast *ast);
 struct Value *InterpreterDoArrayIdx(struct Module *module, struct Ast *ast);
 struct Value *InterpreterDoMemberAccess(struct Module *module, struct Ast *ast);
-struct Value *InterpreterDoReturn(struct Module *module, struct Ast *ast);
-struct Value *InterpreterDoBreak(struct Module *module, struct Ast *ast);
-struct Value *InterpreterDoContinue(struct Module *module, struct Ast *ast);
+struct Value *InterpreterDoControlFlow(struct Module *module, struct Ast *ast);
 struct Value *InterpreterDoMut(struct Module *module, struct Ast *ast);
 struct Value *InterpreterDoConst(struct Module *module, struct Ast *ast);
 struct Value *InterpreterDoFor(struct Module *module, struct Ast *ast);
+struct Value *InterpreterDoForIn(struct Module *module, struct Ast *ast);
 struct Value *InterpreterDoWhile(struct Module *module, struct Ast *ast);
 struct Value *InterpreterDoIfElse(struct Module *module, struct Ast *ast);
 struct Value *InterpreterDoBoolean(struct Ast *ast);
@@ -85,7 +103,8 @@ static inline struct Value *InterpreterCallCommon(struct Module *module, struct
         result = InterpreterDoCallBuiltinFn(module, method, argc, argv, srcLoc);
     }
     else if (&g_TheFunctionTypeInfo == method->TypeInfo) {
-        result = InterpreterDoCallFunction(method->v.Function->OwnerModule, method, argc, argv, srcLoc);
+        module = IsolateModuleFor(IsolateCurrent(), method->v.Function->OwnerModule);
+        result = InterpreterDoCallFunction(module, method, argc, argv, srcLoc);
     }
     else {
         result = &g_TheNilValue;
@@ -93,14 +112,138 @@ static inline struct Value *InterpreterCallCommon(struct Module *module, struct
     return result;
 }
 
-static inline struct Value *DispatchBinaryOperationMethod(struct Module *module, struct Ast *ast, char *methodName) {
-    struct Value *lhs, *rhs, *method;
+/* Evaluates an operand for its value. A symbol is read straight from its
+   table instead of through the reference InterpreterDoSymbol makes for
+   assignments to write to. */
+static inline struct Value *InterpreterRunOperand(struct Module *module, struct Ast *ast) {
+    struct Symbol *sym;
+    struct Value *value;
+    if (SymbolNode == ast->Type) {
+        sym = InterpreterFindSymbol(module, ast);
+        return sym ? sym->Value : &g_TheNilValue;
+    }
+    value = InterpreterRunAst(module, ast);
+    DEREF_IF_SYMBOL(value);
+    return value;
+}
+
+/* Whether evaluating ast may run statements and so collect, constants and
+   names can not. */
+static inline int InterpreterMayCollect(struct Ast *ast) {
+#ifdef NO_GC
+    (void)ast;
+    return 0;
+#else
+    return SymbolNode != ast->Type && (ast->Type < NilNode || ast->Type > StringNode);
+#endif
+}
+
+/* Evaluates both operands of a binary node, lhs is rooted while rhs is
+   evaluated. */
+static inline void InterpreterRunOperands(struct Module *module, struct Ast *ast, struct Value **out_lhs, struct Value **out_rhs) {
+    *out_lhs = InterpreterRunOperand(module, ast->Children[0]);
+    if (!InterpreterMayCollect(ast->Children[1])) {
+        *out_rhs = InterpreterRunOperand(module, ast->Children[1]);
+        return;
+    }
+    GC_PushRoot(*out_lhs);
+    *out_rhs = InterpreterRunOperand(module, ast->Children[1]);
+    GC_PopRoots(1);
+}
+
+#define IS_INTEGER(v) ((v)->TypeInfo == &g_TheIntegerTypeInfo)
+#define IS_REAL(v) ((v)->TypeInfo == &g_TheRealTypeInfo)
+#define BOOLEAN(b) ((b) ? &g_TheTrueValue : &g_TheFalseValue)
+
+/* Integer and Real can not be reopened, so when both sides are one of them
+   the builtin method is known and op is worked out here without looking it
+   up. Mirrors runtime/integer.c and runtime/real.c, a -1 or NULL result
+   leaves op to the methods. */
+static inline int NumericComparison(enum AstNodeType op, struct Value *lhs, struct Value *rhs) {
+    double a, b;
+    int lt, gt, eq;
+    if (IS_INTEGER(lhs) && IS_INTEGER(rhs)) {
+        lt = lhs->v.Integer < rhs->v.Integer;
+        gt = lhs->v.Integer > rhs->v.Integer;
+        eq = lhs->v.Integer == rhs->v.Integer;
+    }
+    else if (IS_INTEGER(lhs) && IS_REAL(rhs)) {
+        lt = lhs->v.Integer < rhs->v.Real;
+        gt = lhs->v.Integer > rhs->v.Real;
+        eq = 0;
+    }
+    else if (IS_REAL(lhs) && (IS_INTEGER(rhs) || IS_REAL(rhs))) {
+        a = lhs->v.Real;
+        b = IS_INTEGER(rhs) ? rhs->v.Integer : rhs->v.Real;
+        lt = a - b < 0;
+        gt = a - b > 0;
+        eq = IS_INTEGER(rhs) ? 0.0 == a - b : fabs(a - b) <= REAL_EPSILON;
+    }
+    else {
+        return -1;
+    }
+    switch (op) {
+        default: return -1;
+        case BLogicEqExpr: return eq;
+        case BLogicNotEqExpr: return !eq;
+        case BLogicLtExpr: return lt;
+        case BLogicLtEqExpr: return lt || eq;
+        case BLogicGtExpr: return gt;
+        case BLogicGtEqExpr: return gt || eq;
+    }
+}
+
+static inline struct Value *NumericBinaryOperation(enum AstNodeType op, struct Value *lhs, struct Value *rhs) {
+    struct Value *result;
+    double a, b;
+    int x, y;
+    if (IS_INTEGER(lhs) && IS_INTEGER(rhs)) {
+        x = lhs->v.Integer;
+        y = rhs->v.Integer;
+        switch (op) {
+            default: return NULL;
+            case BAddExpr: x = x + y; break;
+            case BSubExpr: x = x - y; break;
+            case BMulExpr: x = x * y; break;
+            case BDivExpr: x = x / y; break;
+            case BModExpr: x = x % y; break;
+            case BPowExpr: x = pow(x, y); break;
+            case BLShift: x = x << y; break;
+            case BRShift: x = x >> y; break;
+            case BArithOrExpr: x = x | y; break;
+            case BArithAndExpr: x = x & y; break;
+            case BArithXorExpr: x = x ^ y; break;
+        }
+        ValueMakeInteger(&result, x);
+        return result;
+    }
+    if (IS_INTEGER(lhs) && IS_REAL(rhs)) {
+        a = lhs->v.Integer;
+        b = rhs->v.Real;
+    }
+    else if (IS_REAL(lhs) && (IS_INTEGER(rhs) || IS_REAL(rhs))) {
+        a = lhs->v.Real;
+        b = IS_INTEGER(rhs) ? rhs->v.Integer : rhs->v.Real;
+    }
+    else {
+        return NULL;
+    }
+    switch (op) {
+        default: return NULL;
+        case BAddExpr: a = a + b; break;
+        case BSubExpr: a = a - b; break;
+        case BMulExpr: a = a * b; break;
+        case BDivExpr: a = a / b; break;
+        case BModExpr: a = fmod(a, b); break;
+        case BPowExpr: a = pow(a, b); break;
+    }
+    ValueMakeReal(&result, a);
+    return result;
+}
+
+static inline struct Value *CallBinaryOperationMethod(struct Module *module, struct Ast *ast, char *methodName, struct Value *lhs, struct Value *rhs) {
+    struct Value *method;
     struct Value *argv[2];
-    /* TODO: maybe these values need preservation */
-    lhs = InterpreterRunAst(module, ast->Children[0]);
-    DEREF_IF_SYMBOL(lhs);
-    rhs = InterpreterRunAst(module, ast->Children[1]);
-    DEREF_IF_SYMBOL(rhs);
     TypeInfoLookupMethod(lhs->TypeInfo, methodName, &method);
     if (!method) {
         printf("Binary method '%s' not implemented for type of '%s'",
@@ -114,6 +257,87 @@ static inline struct Value *DispatchBinaryOperationMethod(struct Module *module,
     return InterpreterCallCommon(module, method, 2, argv, ast->SrcLoc);
 }
 
+static inline struct Value *DispatchBinaryOperationMethod(struct Module *module, struct Ast *ast, enum AstNodeType op, char *methodName) {
+    struct Value *lhs, *rhs, *result;
+    InterpreterRunOperands(module, ast, &lhs, &rhs);
+    result = NumericBinaryOperation(op, lhs, rhs);
+    if (result) {
+        return result;
+    }
+    return CallBinaryOperationMethod(module, ast, methodName, lhs, rhs);
+}
+
+/* <= and >= use __le__ and __ge__ where a type has them, and __lt__ or
+   __gt__ followed by __eq__ otherwise. */
+static struct Value *FusedComparison(struct Module *module, struct Ast *ast, char *fusedName, char *strictName, struct Value *lhs, struct Value *rhs) {
+    struct Value *method;
+    struct Value *argv[2];
+    TypeInfoLookupMethod(lhs->TypeInfo, fusedName, &method);
+    if (method) {
+        argv[0] = lhs;
+        argv[1] = rhs;
+        return InterpreterCallCommon(module, method, 2, argv, ast->SrcLoc);
+    }
+    if (&g_TheTrueValue == CallBinaryOperationMethod(module, ast, strictName, lhs, rhs)) {
+        return &g_TheTrueValue;
+    }
+    if (&g_TheTrueValue == CallBinaryOperationMethod(module, ast, "__eq__", lhs, rhs)) {
+        return &g_TheTrueValue;
+    }
+    return &g_TheFalseValue;
+}
+
+/* Compares operands that have already been evaluated, once. */
+static struct Value *CompareValues(struct Module *module, struct Ast *ast, struct Value *lhs, struct Value *rhs) {
+    struct Value *eq;
+    int c = NumericComparison(ast->Type, lhs, rhs);
+    if (c >= 0) {
+        return BOOLEAN(c);
+    }
+    switch (ast->Type) {
+        default:
+        case BLogicEqExpr: return CallBinaryOperationMethod(module, ast, "__eq__", lhs, rhs);
+        case BLogicLtExpr: return CallBinaryOperationMethod(module, ast, "__lt__", lhs, rhs);
+        case BLogicGtExpr: return CallBinaryOperationMethod(module, ast, "__gt__", lhs, rhs);
+        case BLogicLtEqExpr: return FusedComparison(module, ast, "__le__", "__lt__", lhs, rhs);
+        case BLogicGtEqExpr: return FusedComparison(module, ast, "__ge__", "__gt__", lhs, rhs);
+        case BLogicNotEqExpr:
+            eq = CallBinaryOperationMethod(module, ast, "__eq__", lhs, rhs);
+            DEREF_IF_SYMBOL(eq);
+            if (&g_TheTrueValue == eq) {
+                return &g_TheFalseValue;
+            }
+            else if (&g_TheFalseValue == eq) {
+                return &g_TheTrueValue;
+            }
+            return &g_TheNilValue;
+    }
+}
+
+/* Loops and ifs only need to know whether their condition holds, so a
+   numeric comparison is answered without going through a boolean. */
+static inline int InterpreterTestCondition(struct Module *module, struct Ast *ast) {
+    struct Value *lhs, *rhs, *value;
+    int c;
+    switch (ast->Type) {
+        default:
+            value = InterpreterRunAst(module, ast);
+            break;
+        case BLogicEqExpr: case BLogicNotEqExpr:
+        case BLogicLtExpr: case BLogicLtEqExpr:
+        case BLogicGtExpr: case BLogicGtEqExpr:
+            InterpreterRunOperands(module, ast, &lhs, &rhs);
+            c = NumericComparison(ast->Type, lhs, rhs);
+            if (c >= 0) {
+                return c;
+            }
+            value = CompareValues(module, ast, lhs, rhs);
+            break;
+    }
+    DEREF_IF_SYMBOL(value);
+    return &g_TheTrueValue == value;
+}
+
 static inline struct Value *DispatchPrefixUnaryOperationMethod(struct Module *module, struct Ast *ast, char *methodName) {
     struct Value *rhs, *method;
     struct Value *argv[1];
@@ -157,59 +381,87 @@ struct Value *InterpreterDispatchMethod(struct Module *module, struct Value *obj
 }
 
 /* Function definitions */
-struct Value *InterpreterDoBody(struct Module *module, struct Ast *ast) {
+enum Completion InterpreterExecStmt(struct Module *module, struct Ast *ast, struct Value **out_value) {
+    ProfilerAt(ast);
+    switch (ast->Type) {
+        default:
+            *out_value = InterpreterRunAst(module, ast);
+            return CompletionNormal;
+        case Body: return InterpreterExecBody(module, ast, out_value);
+        case ReturnExpr: return InterpreterExecReturn(module, ast, out_value);
+        case BreakExpr:
+            *out_value = &g_TheNilValue;
+            return CompletionBreak;
+        case ContinueExpr:
+            *out_value = &g_TheNilValue;
+            return CompletionContinue;
+        case YieldExpr: return InterpreterExecYield(module, ast, out_value);
+        case ForExpr: return InterpreterExecFor(module, ast, out_value);
+        case ForInExpr: return InterpreterExecForIn(module, ast, out_value);
+        case WhileExpr: return InterpreterExecWhile(module, ast, out_value);
+        case IfElseExpr: return InterpreterExecIfElse(module, ast, out_value);
+    }
+}
+enum Completion InterpreterExecBody(struct Module *module, struct Ast *ast, struct Value **out_value) {
     unsigned int i;
+    enum Completion completion = CompletionNormal;
     struct Value *value = &g_TheNilValue;
+    struct Isolate *isolate = IsolateCurrent();
     for (i = 0; i < ast->NumChildren; ++i) {
-        if (IsContinuing || IsBreaking || IsReturning) {
+        GC_SafePoint(isolate);
+        completion = InterpreterExecStmt(module, ast->Children[i], &value);
+        if (CompletionNormal != completion) {
             break;
         }
-        value = InterpreterRunAst(module, ast->Children[i]);
     }
+    *out_value = value;
+    return completion;
+}
+struct Value *InterpreterDoBody(struct Module *module, struct Ast *ast) {
+    struct Value *value;
+    InterpreterExecBody(module, ast, &value);
     return value;
 }
 struct Value *InterpreterDoAdd(struct Module *module, struct Ast *ast) {
-    return DispatchBinaryOperationMethod(module, ast, "__add__");
+    return DispatchBinaryOperationMethod(module, ast, BAddExpr, "__add__");
 }
 struct Value *InterpreterDoSub(struct Module *module, struct Ast *ast) {
-    return DispatchBinaryOperationMethod(module, ast, "__sub__");
+    return DispatchBinaryOperationMethod(module, ast, BSubExpr, "__sub__");
 }
 struct Value *InterpreterDoMul(struct Module *module, struct Ast *ast) {
-    return DispatchBinaryOperationMethod(module, ast, "__mul__");
+    return DispatchBinaryOperationMethod(module, ast, BMulExpr, "__mul__");
 }
 struct Value *InterpreterDoDiv(struct Module *module, struct Ast *ast) {
-    return DispatchBinaryOperationMethod(module, ast, "__div__");
+    return DispatchBinaryOperationMethod(module, ast, BDivExpr, "__div__");
 }
 struct Value *InterpreterDoMod(struct Module *module, struct Ast *ast) {
-    return DispatchBinaryOperationMethod(module, ast, "__mod__");
+    return DispatchBinaryOperationMethod(module, ast, BModExpr, "__mod__");
 }
 struct Value *InterpreterDoPow(struct Module *module, struct Ast *ast) {
-    return DispatchBinaryOperationMethod(module, ast, "__pow__");
+    return DispatchBinaryOperationMethod(module, ast, BPowExpr, "__pow__");
 }
 struct Value *InterpreterDoLShift(struct Module *module, struct Ast *ast) {
-    return DispatchBinaryOperationMethod(module, ast, "__lshift__");
+    return DispatchBinaryOperationMethod(module, ast, BLShift, "__lshift__");
 }
 struct Value *InterpreterDoRShift(struct Module *module, struct Ast *ast) {
-    return DispatchBinaryOperationMethod(module, ast, "__rshift__");
+    return DispatchBinaryOperationMethod(module, ast, BRShift, "__rshift__");
 }
 struct Value *InterpreterDoArithOr(struct Module *module, struct Ast *ast) {
-    return DispatchBinaryOperationMethod(module, ast, "__or__");
+    return DispatchBinaryOperationMethod(module, ast, BArithOrExpr, "__or__");
 }
 struct Value *InterpreterDoArithAnd(struct Module *module, struct Ast *ast) {
-    return DispatchBinaryOperationMethod(module, ast, "__and__");
+    return DispatchBinaryOperationMethod(module, ast, BArithAndExpr, "__and__");
 }
 struct Value *InterpreterDoXorExpr(struct Module *module, struct Ast *ast) {
-    return DispatchBinaryOperationMethod(module, ast, "__xor__");
+    return DispatchBinaryOperationMethod(module, ast, BArithXorExpr, "__xor__");
 }
 struct Value *InterpreterDoLogicOr(struct Module *module, struct Ast *ast) {
     struct Value *lhs, *rhs;
-    lhs = InterpreterRunAst(module, ast->Children[0]);
-    DEREF_IF_SYMBOL(lhs);
+    lhs = InterpreterRunOperand(module, ast->Children[0]);
     if (&g_TheTrueValue == lhs) {
         return &g_TheTrueValue;
     }
-    rhs = InterpreterRunAst(module, ast->Children[1]);
-    DEREF_IF_SYMBOL(rhs);
+    rhs = InterpreterRunOperand(module, ast->Children[1]);
     if (&g_TheTrueValue == rhs) {
         return &g_TheTrueValue;
     }
@@ -221,13 +473,11 @@ struct Value *InterpreterDoLogicOr(struct Module *module, struct Ast *ast) {
 }
 struct Value *InterpreterDoLogicAnd(struct Module *module, struct Ast *ast) {
     struct Value *lhs, *rhs;
-    lhs = InterpreterRunAst(module, ast->Children[0]);
-    DEREF_IF_SYMBOL(lhs);
+    lhs = InterpreterRunOperand(module, ast->Children[0]);
     if (&g_TheFalseValue == lhs) {
         return &g_TheFalseValue;
     }
-    rhs = InterpreterRunAst(module, ast->Children[1]);
-    DEREF_IF_SYMBOL(rhs);
+    rhs = InterpreterRunOperand(module, ast->Children[1]);
     if (&g_TheFalseValue == rhs) {
         return &g_TheFalseValue;
     }
@@ -237,47 +487,28 @@ struct Value *InterpreterDoLogicAnd(struct Module *module, struct Ast *ast) {
     /* TODO: Runtime error */
     return &g_TheNilValue;
 }
+static struct Value *InterpreterDoComparison(struct Module *module, struct Ast *ast) {
+    struct Value *lhs, *rhs;
+    InterpreterRunOperands(module, ast, &lhs, &rhs);
+    return CompareValues(module, ast, lhs, rhs);
+}
 struct Value *InterpreterDoLogicEq(struct Module *module, struct Ast *ast) {
-    return DispatchBinaryOperationMethod(module, ast, "__eq__");
+    return InterpreterDoComparison(module, ast);
 }
 struct Value *InterpreterDoLogicNotEq(struct Module *module, struct Ast *ast) {
-    struct Value *value = InterpreterDoLogicEq(module, ast);
-    DEREF_IF_SYMBOL(value);
-    if (&g_TheTrueValue == value) {
-        return &g_TheFalseValue;
-    }
-    else if (&g_TheFalseValue == value) {
-        return &g_TheTrueValue;
-    }
-    return &g_TheNilValue;
+    return InterpreterDoComparison(module, ast);
 }
 struct Value *InterpreterDoLogicLt(struct Module *module, struct Ast *ast) {
-    return DispatchBinaryOperationMethod(module, ast, "__lt__");
+    return InterpreterDoComparison(module, ast);
 }
 struct Value *InterpreterDoLogicLtEq(struct Module *module, struct Ast *ast) {
-    struct Value *eq, *lt = InterpreterDoLogicLt(module, ast);
-    if (&g_TheTrueValue == lt) {
-        return &g_TheTrueValue;
-    }
-    eq = InterpreterDoLogicEq(module, ast);
-    if (&g_TheTrueValue == eq) {
-        return &g_TheTrueValue;
-    }
-    return &g_TheFalseValue;
+    return InterpreterDoComparison(module, ast);
 }
 struct Value *InterpreterDoLogicGt(struct Module *module, struct Ast *ast) {
-    return DispatchBinaryOperationMethod(module, ast, "__gt__");
+    return InterpreterDoComparison(module, ast);
 }
 struct Value *InterpreterDoLogicGtEq(struct Module *module, struct Ast *ast) {
-    struct Value *eq, *gt = InterpreterDoLogicGt(module, ast);
-    if (&g_TheTrueValue == gt) {
-        return &g_TheTrueValue;
-    }
-    eq = InterpreterDoLogicEq(module, ast);
-    if (&g_TheTrueValue == eq) {
-        return &g_TheTrueValue;
-    }
-    return &g_TheFalseValue;
+    return InterpreterDoComparison(module, ast);
 }
 struct Value *InterpreterDoNegate(struct Module *module, struct Ast *ast) {
     return DispatchPrefixUnaryOperationMethod(module, ast, "__neg__");
@@ -289,7 +520,10 @@ struct Value *InterpreterDoAssign(struct Module *module, struct Ast *ast) {
     struct Symbol *symbol;
     struct Value *rvalue, *lvalue;
     lvalue = InterpreterRunAst(module, ast->Children[0]);
+    /* Nothing else refers to the reference being assigned through. */
+    GC_PushRoot(lvalue);
     rvalue = InterpreterRunAst(module, ast->Children[1]);
+    GC_PopRoots(1);
     DEREF_IF_SYMBOL(rvalue);
     if (lvalue->IsSymbol) {
         symbol = lvalue->v.Symbol;
@@ -302,7 +536,7 @@ struct Value *InterpreterDoAssign(struct Module *module, struct Ast *ast) {
         return symbol->Value;
     }
     if (lvalue->IsPtrToValue) {
-        *lvalue->v.PtrToValue = rvalue;
+        VALUE_ELEMENT(lvalue) = rvalue;
         return rvalue;
     }
     return &g_TheNilValue;
@@ -319,26 +553,32 @@ struct Value *InterpreterDoInteger(struct Ast *ast){
 struct Value *InterpreterDoString(struct Ast *ast){
     return ast->u.Value;
 }
-struct Value *InterpreterDoSymbol(struct Module *module, struct Ast *ast){
+static struct Symbol *InterpreterFindSymbol(struct Module *module, struct Ast *ast) {
     struct Symbol *sym;
-    struct Value *value = ValueAlloc();
-    value->IsSymbol = 1;
     if (SymbolTableFindNearest(module->CurrentScope, ast->u.SymbolName, &sym)) {
-        value->v.Symbol = sym;
-        return value;
+        return sym;
     }
     /* Classes use a separate `ModuleScope' */
     else if (SymbolTableFindNearest(module->ModuleScope, ast->u.SymbolName, &sym)) {
-        value->v.Symbol = sym;
-        return value;
+        return sym;
     }
-    else if (SymbolTableFindLocal(g_TheGlobalScope, ast->u.SymbolName, &sym)) {
-        value->v.Symbol = sym;
-        return value;
+    else if (SymbolTableFindLocal(IsolateCurrent()->GlobalScope, ast->u.SymbolName, &sym)) {
+        return sym;
     }
     printf("Undefined symbol: '%s'", ast->u.SymbolName);
     at(ast->SrcLoc);
-    return &g_TheNilValue;
+    return NULL;
+}
+struct Value *InterpreterDoSymbol(struct Module *module, struct Ast *ast){
+    struct Symbol *sym = InterpreterFindSymbol(module, ast);
+    struct Value *value;
+    if (!sym) {
+        return &g_TheNilValue;
+    }
+    value = ValueAlloc();
+    value->IsSymbol = 1;
+    value->v.Symbol = sym;
+    return value;
 }
 struct Value *InterpreterDoDefFunction(struct Module *module, struct Ast *ast){
     return &g_TheNilValue;
@@ -428,7 +668,15 @@ struct Value *InterpreterDoCallBuiltinFn(struct Module *module, struct Value *fu
         at(srcLoc);
         return &g_TheNilValue;
     }
+    ProfilerEnter(function);
+    if (g_TracerEnabled) {
+        TracerEnterBuiltinFn(fn);
+    }
     value = function->v.BuiltinFn->Fn(module, argc, argv);
+    if (g_TracerEnabled) {
+        TracerLeave();
+    }
+    ProfilerLeave();
     return value;
 }
 struct Value *InterpreterDoCallFunction(struct Module *module, struct Value *function, unsigned int argc, struct Value **argv, struct SrcLoc srcLoc) {
@@ -447,6 +695,23 @@ struct Value *InterpreterDoCallFunction(struct Module *module, struct Value *fun
         at(srcLoc);
         return &g_TheNilValue;
     }
+    if (fn->IsGenerator) {
+        if (R_Success != GeneratorMake(&returnValue, module, function, argc, argv)) {
+            printf("Could not make a stack for generator '%s'", fn->Name);
+            at(srcLoc);
+            return &g_TheNilValue;
+        }
+        return returnValue;
+    }
+    if (R_Success != GeneratorCheckStack()) {
+        printf("Generator ran out of stack calling '%s', see --generator-stack", fn->Name);
+        at(srcLoc);
+        return &g_TheNilValue;
+    }
+    ProfilerEnter(function);
+    if (g_TracerEnabled) {
+        TracerEnterFunction(fn);
+    }
     SymbolTablePushScope(&(module->CurrentScope));
     /* Setup params */
     /* TODO: Handle varargs */
@@ -457,18 +722,15 @@ struct Value *InterpreterDoCallFunction(struct Module *module, struct Value *fun
             SymbolTableInsert(module->CurrentScope, arg, param->u.SymbolName, 1, param->SrcLoc);
         }
     }
-    /* Execute body. */
-    returnValue = &g_TheNilValue;
-    for (i = 0; i < body->NumChildren; ++i) {
-        returnValue = InterpreterRunAst(module, body->Children[i]);
-        DEREF_IF_SYMBOL(returnValue);
-        if (IsReturning) {
-            break;
-        }
-    }
-    IsReturning = 0;
+    /* Execute body, a `return' stops it early with the returned value. */
+    InterpreterExecBody(module, body, &returnValue);
+    DEREF_IF_SYMBOL(returnValue);
     ValueDuplicate(&returnValue, returnValue);
     SymbolTablePopScope(&(module->CurrentScope));
+    if (g_TracerEnabled) {
+        TracerLeave();
+    }
+    ProfilerLeave();
     return returnValue;
 }
 struct Value *InterpreterDoCall(struct Module *module, struct Ast *ast) {
@@ -476,6 +738,7 @@ struct Value *InterpreterDoCall(struct Module *module, struct Ast *ast) {
     unsigned int argc, i, argvIdx;
     struct Value **argv, *arg, *argCopyOrRef, *ret;
     struct Ast *args;
+    struct Isolate *isolate = IsolateCurrent();
     DEREF_IF_SYMBOL(func);
     if (&g_TheNilValue == func) {
         return &g_TheNilValue;
@@ -485,31 +748,38 @@ struct Value *InterpreterDoCall(struct Module *module, struct Ast *ast) {
     if (args) {
         argc += args->NumChildren;
     }
-    argc += NumToInjectIntoNextCall;
+    argc += isolate->NumToInjectIntoNextCall;
     argv = malloc(sizeof(*argv) * argc);
     argvIdx = 0;
-    if (NumToInjectIntoNextCall > 0) {
-        for (; argvIdx < NumToInjectIntoNextCall; ++argvIdx) {
-            argv[argvIdx] = InjectIntoNextCall[argvIdx];
+    /* The copies are only on the C stack until the callee's scope holds
+       them, evaluating the next argument may collect. */
+    GC_PushRoot(func);
+    if (isolate->NumToInjectIntoNextCall > 0) {
+        for (; argvIdx < isolate->NumToInjectIntoNextCall; ++argvIdx) {
+            argv[argvIdx] = isolate->InjectIntoNextCall[argvIdx];
+            GC_PushRoot(argv[argvIdx]);
         }
     }
+    /* Consumed, calls made by the arguments get receivers of their own. */
+    isolate->NumToInjectIntoNextCall = 0;
     if (args) {
         for (i = 0; i < args->NumChildren; ++i, ++argvIdx) {
             arg = InterpreterRunAst(module, args->Children[i]);
             DEREF_IF_SYMBOL(arg);
             ValueDuplicate(&argCopyOrRef, arg);
             argv[argvIdx] = argCopyOrRef;
+            GC_PushRoot(argCopyOrRef);
         }
     }
-    NumToInjectIntoNextCall = 0;
     ret = InterpreterCallCommon(module, func, argc, argv, ast->SrcLoc);
+    GC_PopRoots(argc + 1);
     DEREF_IF_SYMBOL(ret);
     SymbolTableAssign(module->CurrentScope, ret, "#_return_#", 1, ast->SrcLoc);
     free(argv);
     return ret;
 }
 struct Value *InterpreterDoArrayIdx(struct Module *module, struct Ast *ast) {
-    return DispatchBinaryOperationMethod(module, ast, "__index__");
+    return DispatchBinaryOperationMethod(module, ast, ArrayIdxExpr, "__index__");
 }
 struct Value *InterpreterDoMemberAccess(struct Module *module, struct Ast *ast) {
     struct Ast *left = ast->Children[0];
@@ -517,10 +787,15 @@ struct Value *InterpreterDoMemberAccess(struct Module *module, struct Ast *ast)
     struct Value *value, *member;
     struct Module *import;
     struct Symbol *symbol;
+    struct Isolate *isolate;
 
     if (SymbolNode == left->Type) {
         ModuleTableFind(module->Imports, left->u.SymbolName, &import);
         if (import) {
+            if (import->NeedsInit) {
+                InterpreterInitModule(import);
+            }
+            import = IsolateModuleFor(IsolateCurrent(), import);
             return InterpreterRunAst(import, memberAst);
         }
     }
@@ -536,27 +811,46 @@ struct Value *InterpreterDoMemberAccess(struct Module *module, struct Ast *ast)
     }
     TypeInfoLookupMethod(value->TypeInfo, memberAst->u.SymbolName, &member);
     if (member) {
-        NumToInjectIntoNextCall = 1;
-        InjectIntoNextCall[0] = value;
+        isolate = IsolateCurrent();
+        isolate->NumToInjectIntoNextCall = 1;
+        isolate->InjectIntoNextCall[0] = value;
         return member;
     }
     return &g_TheNilValue;
 }
-struct Value *InterpreterDoReturn(struct Module *module, struct Ast *ast) {
+enum Completion InterpreterExecReturn(struct Module *module, struct Ast *ast, struct Value **out_value) {
     struct Ast *expr = ast->Children[0];
-    IsReturning = 1;
     if (!expr) {
-        return &g_TheNilValue;
+        *out_value = &g_TheNilValue;
+    }
+    else {
+        *out_value = InterpreterRunAst(module, expr);
+        /* Resolve now, the symbol may live in a scope that is popped
+           before the call receives the value. */
+        DEREF_IF_SYMBOL(*out_value);
     }
-    return InterpreterRunAst(module, expr);
+    return CompletionReturn;
 }
-struct Value *InterpreterDoBreak(struct Module *module, struct Ast *ast) {
-    IsBreaking = 1;
-    return &g_TheNilValue;
+enum Completion InterpreterExecYield(struct Module *module, struct Ast *ast, struct Value **out_value) {
+    struct Ast *expr = ast->Children[0];
+    struct Value *value = &g_TheNilValue;
+    if (expr) {
+        value = InterpreterRunAst(module, expr);
+        DEREF_IF_SYMBOL(value);
+        ValueDuplicate(&value, value);
+    }
+    if (R_Success != GeneratorYield(value)) {
+        printf("yield outside of a generator");
+        at(ast->SrcLoc);
+    }
+    *out_value = &g_TheNilValue;
+    return CompletionNormal;
 }
-struct Value *InterpreterDoContinue(struct Module *module, struct Ast *ast) {
-    IsContinuing = 1;
-    return &g_TheNilValue;
+/* Control flow outside of a statement list has nothing to signal. */
+struct Value *InterpreterDoControlFlow(struct Module *module, struct Ast *ast) {
+    struct Value *value;
+    InterpreterExecStmt(module, ast, &value);
+    return value;
 }
 struct Value *InterpreterDoMut(struct Module *module, struct Ast *ast) {
     unsigned int i;
@@ -606,163 +900,335 @@ struct Value *InterpreterDoConst(struct Module *module, struct Ast *ast) {
     SymbolTableInsert(module->CurrentScope, value, name->u.SymbolName, 0, name->SrcLoc);
     return &g_TheNilValue;
 }
-struct Value *InterpreterDoFor(struct Module *module, struct Ast *ast) {
+enum Completion InterpreterExecFor(struct Module *module, struct Ast *ast, struct Value **out_value) {
     struct Ast *pre, *cond, *body, *post;
-    struct Value *c;
+    struct Value *value = &g_TheNilValue;
+    enum Completion completion = CompletionNormal;
     pre = ast->Children[0];
     cond = ast->Children[1];
     body = ast->Children[2];
     post = ast->Children[3];
-    SymbolTablePushScope(&(module->CurrentScope));
+    if (!ast->NoScope) {
+        SymbolTablePushScope(&(module->CurrentScope));
+    }
     InterpreterRunAst(module, pre);
-    while (1) {
-        c = InterpreterRunAst(module, cond);
-        DEREF_IF_SYMBOL(c);
-        if (&g_TheTrueValue != c) {
+    while (InterpreterTestCondition(module, cond)) {
+        completion = InterpreterExecStmt(module, body, &value);
+        if (CompletionBreak == completion) {
+            completion = CompletionNormal;
             break;
         }
-        InterpreterRunAst(module, body);
-        if (IsContinuing) {
-            IsContinuing = 0;
-            goto do_post;
+        if (CompletionReturn == completion) {
+            break;
         }
-        if (IsBreaking) {
-            IsBreaking = 0;
+        /* A continue ends here, only a return leaves the loop. */
+        completion = CompletionNormal;
+        InterpreterRunAst(module, post);
+    }
+    if (!ast->NoScope) {
+        SymbolTablePopScope(&(module->CurrentScope));
+    }
+    *out_value = CompletionReturn == completion ? value : &g_TheNilValue;
+    return completion;
+}
+struct Value *InterpreterDoFor(struct Module *module, struct Ast *ast) {
+    struct Value *value;
+    InterpreterExecFor(module, ast, &value);
+    return value;
+}
+/* Produces the next item of a for-in loop, 0 once there are none left. */
+static int InterpreterNextItem(struct Value *iterable, unsigned int *idx, struct Value **out_item) {
+    struct Generator *generator;
+    if (&g_TheGeneratorTypeInfo == iterable->TypeInfo) {
+        generator = iterable->v.Generator;
+        if (R_Success != GeneratorResume(generator, out_item)) {
+            return 0;
+        }
+        return !generator->Coroutine.IsDone;
+    }
+    if (*idx >= iterable->v.Vector->Length) {
+        return 0;
+    }
+    ValueDuplicate(out_item, iterable->v.Vector->Values[(*idx)++]);
+    return 1;
+}
+enum Completion InterpreterExecForIn(struct Module *module, struct Ast *ast, struct Value **out_value) {
+    struct Ast *name, *body;
+    struct Value *iterable, *item, *value = &g_TheNilValue;
+    struct Symbol *symbol;
+    enum Completion completion = CompletionNormal;
+    unsigned int idx = 0;
+    name = ast->Children[0];
+    body = ast->Children[2];
+    iterable = InterpreterRunAst(module, ast->Children[1]);
+    DEREF_IF_SYMBOL(iterable);
+    if (&g_TheGeneratorTypeInfo != iterable->TypeInfo && &g_TheVectorTypeInfo != iterable->TypeInfo) {
+        printf("Cannot iterate over '%s'", iterable->TypeInfo->TypeName);
+        at(ast->SrcLoc);
+        *out_value = &g_TheNilValue;
+        return CompletionNormal;
+    }
+    SymbolTablePushScope(&(module->CurrentScope));
+    /* Keeps the iterable alive for as long as the loop runs. */
+    SymbolTableInsert(module->CurrentScope, iterable, "#_for_in_#", 1, ast->SrcLoc);
+    SymbolTableInsert(module->CurrentScope, &g_TheNilValue, name->u.SymbolName, 1, name->SrcLoc);
+    SymbolTableFindLocal(module->CurrentScope, name->u.SymbolName, &symbol);
+    while (InterpreterNextItem(iterable, &idx, &item)) {
+        symbol->Value = item;
+        completion = InterpreterExecStmt(module, body, &value);
+        if (CompletionBreak == completion) {
+            completion = CompletionNormal;
             break;
         }
-        if (IsReturning) {
-            SymbolTablePopScope(&(module->CurrentScope));
-            return c;
+        if (CompletionReturn == completion) {
+            break;
         }
-    do_post:
-        InterpreterRunAst(module, post);
+        /* A continue ends here, only a return leaves the loop. */
+        completion = CompletionNormal;
     }
     SymbolTablePopScope(&(module->CurrentScope));
-    return &g_TheNilValue;
+    *out_value = CompletionReturn == completion ? value : &g_TheNilValue;
+    return completion;
 }
-struct Value *InterpreterDoWhile(struct Module *module, struct Ast *ast) {
+struct Value *InterpreterDoForIn(struct Module *module, struct Ast *ast) {
+    struct Value *value;
+    InterpreterExecForIn(module, ast, &value);
+    return value;
+}
+enum Completion InterpreterExecWhile(struct Module *module, struct Ast *ast, struct Value **out_value) {
     struct Ast *cond, *body;
-    struct Value *c;
+    struct Value *value = &g_TheNilValue;
+    enum Completion completion = CompletionNormal;
     cond = ast->Children[0];
     body = ast->Children[1];
-    SymbolTablePushScope(&(module->CurrentScope));
-    while (1) {
-        c = InterpreterRunAst(module, cond);
-        DEREF_IF_SYMBOL(c);
-        if (&g_TheTrueValue != c) {
+    if (!ast->NoScope) {
+        SymbolTablePushScope(&(module->CurrentScope));
+    }
+    while (InterpreterTestCondition(module, cond)) {
+        completion = InterpreterExecStmt(module, body, &value);
+        if (CompletionBreak == completion) {
+            completion = CompletionNormal;
             break;
         }
-        if (IsContinuing) {
-            IsContinuing = 0;
-            continue;
-        }
-        InterpreterRunAst(module, body);
-        if (IsBreaking) {
-            IsBreaking = 0;
+        if (CompletionReturn == completion) {
             break;
         }
-        if (IsReturning) {
-            SymbolTablePopScope(&(module->CurrentScope));
-            return c;
-        }
+        /* A continue ends here, only a return leaves the loop. */
+        completion = CompletionNormal;
     }
-    SymbolTablePopScope(&(module->CurrentScope));
-    return &g_TheNilValue;
+    if (!ast->NoScope) {
+        SymbolTablePopScope(&(module->CurrentScope));
+    }
+    *out_value = CompletionReturn == completion ? value : &g_TheNilValue;
+    return completion;
 }
-struct Value *InterpreterDoIfElse(struct Module *module, struct Ast *ast) {
+struct Value *InterpreterDoWhile(struct Module *module, struct Ast *ast) {
+    struct Value *value;
+    InterpreterExecWhile(module, ast, &value);
+    return value;
+}
+enum Completion InterpreterExecIfElse(struct Module *module, struct Ast *ast, struct Value **out_value) {
     struct Ast *cond, *body, *ifelse;
     struct Value *value;
+    enum Completion completion = CompletionNormal;
     cond = ast->Children[0];
     body = ast->Children[1];
     ifelse = ast->Children[2];
-    SymbolTablePushScope(&(module->CurrentScope));
-    value = InterpreterRunAst(module, cond);
-    DEREF_IF_SYMBOL(value);
-    if (&g_TheTrueValue == value) {
-        value = InterpreterRunAst(module, body);
+    if (!ast->NoScope) {
+        SymbolTablePushScope(&(module->CurrentScope));
     }
-    else if (ifelse && IfElseExpr == ifelse->Type){
-        value = InterpreterDoIfElse(module, ifelse);
+    if (InterpreterTestCondition(module, cond)) {
+        completion = InterpreterExecStmt(module, body, &value);
     }
-    else if (ifelse && Body == ifelse->Type) {
-        value = InterpreterRunAst(module, ifelse);
+    else if (ifelse) {
+        completion = InterpreterExecStmt(module, ifelse, &value);
     }
     else {
         value = &g_TheNilValue;
     }
-    SymbolTablePopScope(&(module->CurrentScope));
+    if (!ast->NoScope) {
+        SymbolTablePopScope(&(module->CurrentScope));
+    }
+    *out_value = value;
+    return completion;
+}
+struct Value *InterpreterDoIfElse(struct Module *module, struct Ast *ast) {
+    struct Value *value;
+    InterpreterExecIfElse(module, ast, &value);
     return value;
 }
 
 
 /********************* Public Functions **********************/
 
+static pthread_once_t InterpreterInitOnce = PTHREAD_ONCE_INIT;
+static int InterpreterInitResult;
+
+static void InterpreterInitProcess(void) {
+    InterpreterInitResult = GlobalsInit();
+    if (R_Success != InterpreterInitResult) {
+        return;
+    }
+    InterpreterInitResult = RegisterRuntimes();
+}
+
 int InterpreterInit(void) {
-    return RegisterRuntimes();
+    pthread_once(&InterpreterInitOnce, InterpreterInitProcess);
+    return InterpreterInitResult;
+}
+
+int InterpreterDenit(void) {
+    return GlobalsDenit();
+}
+
+struct Value *InterpreterCall(struct Module *module, struct Value *function, unsigned int argc, struct Value **argv, struct SrcLoc srcLoc) {
+    struct Value *result = InterpreterCallCommon(module, function, argc, argv, srcLoc);
+    DEREF_IF_SYMBOL(result);
+    return result;
 }
 
 int InterpreterRunProgram(struct Module *module) {
     unsigned int i;
+    struct Isolate *isolate = IsolateCurrent();
+    /* Even a module of nothing but definitions, calls into it push their
+       scopes onto its own. */
+    GC_RegisterSymbolTable(module->ModuleScope); /* TODO: Handle return */
     if (!module->Program) {
-        return R_OK;
+        return R_Success;
+    }
+    for (i = 0; i < module->Program->NumChildren; ++i) {
+        GC_SafePoint(isolate);
+        InterpreterRunAst(module, module->Program->Children[i]);
+    }
+    return R_Success;
+}
+
+int InterpreterInitModule(struct Module *module) {
+    unsigned int i;
+    struct Isolate *isolate = IsolateCurrent();
+    if (!module->NeedsInit) {
+        return R_Success;
+    }
+    /* Cleared first, the program may well reach into its own module. Its
+       scope was registered with the GC when it was imported. */
+    module->NeedsInit = 0;
+    if (!module->Program) {
+        return R_Success;
     }
-    GC_RegisterSymbolTable(module->ModuleScope); /* TODO: Handle return */
     for (i = 0; i < module->Program->NumChildren; ++i) {
+        GC_SafePoint(isolate);
         InterpreterRunAst(module, module->Program->Children[i]);
     }
-    return R_OK;
+    return R_Success;
 }
 
+int InterpreterInitImports(struct Module *module) {
+    struct ModuleTableNode *node;
+    unsigned int i;
+    if (!module || !module->Imports) {
+        return R_InvalidArgument;
+    }
+    /* Marked before recursing, an import that leads back here stops. */
+    if (module->ImportsInitialized) {
+        return R_Success;
+    }
+    module->ImportsInitialized = 1;
+    for (i = 0; i < module->Imports->NumNodes; ++i) {
+        for (node = module->Imports->Nodes[i]; node; node = node->Next) {
+            InterpreterInitModule(node->Module);
+            InterpreterInitImports(node->Module);
+        }
+    }
+    return R_Success;
+}
+
+/* The handler of every node type, in the order of enum AstNodeType. */
+#define INTERPRETER_HANDLERS(X)                                 \
+    X(UNASSIGNED, &g_TheNilValue)                               \
+    X(Body, InterpreterDoBody(module, ast))                     \
+                                                                \
+    X(BAddExpr, InterpreterDoAdd(module, ast))                  \
+    X(BSubExpr, InterpreterDoSub(module, ast))                  \
+    X(BMulExpr, InterpreterDoMul(module, ast))                  \
+    X(BDivExpr, InterpreterDoDiv(module, ast))                  \
+    X(BModExpr, InterpreterDoMod(module, ast))                  \
+    X(BPowExpr, InterpreterDoPow(module, ast))                  \
+    X(BLShift, InterpreterDoLShift(module, ast))                \
+    X(BRShift, InterpreterDoRShift(module, ast))                \
+    X(BArithOrExpr, InterpreterDoArithOr(module, ast))          \
+    X(BArithAndExpr, InterpreterDoArithAnd(module, ast))        \
+    X(BArithXorExpr, InterpreterDoXorExpr(module, ast))         \
+                                                                \
+    X(BLogicOrExpr, InterpreterDoLogicOr(module, ast))          \
+    X(BLogicAndExpr, InterpreterDoLogicAnd(module, ast))        \
+    X(BLogicEqExpr, InterpreterDoLogicEq(module, ast))          \
+    X(BLogicNotEqExpr, InterpreterDoLogicNotEq(module, ast))    \
+    X(BLogicLtExpr, InterpreterDoLogicLt(module, ast))          \
+    X(BLogicLtEqExpr, InterpreterDoLogicLtEq(module, ast))      \
+    X(BLogicGtExpr, InterpreterDoLogicGt(module, ast))          \
+    X(BLogicGtEqExpr, InterpreterDoLogicGtEq(module, ast))      \
+                                                                \
+    X(UNegExpr, InterpreterDoNegate(module, ast))               \
+    X(ULogicNotExpr, InterpreterDoLogicNot(module, ast))        \
+                                                                \
+    X(AssignExpr, InterpreterDoAssign(module, ast))             \
+                                                                \
+    X(NilNode, &g_TheNilValue)                                  \
+    X(BooleanNode, InterpreterDoBoolean(ast))                   \
+    X(RealNode, InterpreterDoReal(ast))                         \
+    X(IntegerNode, InterpreterDoInteger(ast))                   \
+    X(StringNode, InterpreterDoString(ast))                     \
+    X(SymbolNode, InterpreterDoSymbol(module, ast))             \
+    X(FunctionNode, InterpreterDoDefFunction(module, ast))      \
+    X(ClassNode, InterpreterDoDefClass(module, ast))            \
+                                                                \
+    X(CallExpr, InterpreterDoCall(module, ast))                 \
+    X(ArrayIdxExpr, InterpreterDoArrayIdx(module, ast))         \
+    X(MemberAccessExpr, InterpreterDoMemberAccess(module, ast)) \
+                                                                \
+    X(ReturnExpr, InterpreterDoControlFlow(module, ast))        \
+    X(ContinueExpr, InterpreterDoControlFlow(module, ast))      \
+    X(BreakExpr, InterpreterDoControlFlow(module, ast))         \
+    X(YieldExpr, InterpreterDoControlFlow(module, ast))         \
+    X(MutExpr, InterpreterDoMut(module, ast))                   \
+    X(ConstExpr, InterpreterDoConst(module, ast))               \
+                                                                \
+    X(ImportExpr, &g_TheNilValue)                               \
+                                                                \
+    X(ForExpr, InterpreterDoFor(module, ast))                   \
+    X(ForInExpr, InterpreterDoForIn(module, ast))               \
+    X(WhileExpr, InterpreterDoWhile(module, ast))               \
+    X(IfElseExpr, InterpreterDoIfElse(module, ast))
+
+/* GCC and clang jump straight to a node's handler through a table of label
+   addresses indexed by its type, other compilers go through the switch.
+   Define INTERPRETER_NO_THREADED_DISPATCH to use the switch anyway. Both
+   return nil for a type they do not know. */
+#if defined(__GNUC__) && !defined(INTERPRETER_NO_THREADED_DISPATCH)
+struct Value *InterpreterRunAst(struct Module *module, struct Ast *ast) {
+    /* __extension__ keeps -pedantic quiet about labels as values. */
+#define INTERPRETER_LABEL(type, handler) [type] = __extension__ &&Do##type,
+    static const void *const handlers[] = {
+        INTERPRETER_HANDLERS(INTERPRETER_LABEL)
+    };
+#undef INTERPRETER_LABEL
+    ProfilerAt(ast);
+    if ((unsigned int)ast->Type >= sizeof handlers / sizeof *handlers) {
+        return &g_TheNilValue;
+    }
+    __extension__ ({ goto *handlers[ast->Type]; });
+#define INTERPRETER_CASE(type, handler) Do##type: return handler;
+    INTERPRETER_HANDLERS(INTERPRETER_CASE)
+#undef INTERPRETER_CASE
+}
+#else
 struct Value *InterpreterRunAst(struct Module *module, struct Ast *ast) {
+    ProfilerAt(ast);
     switch (ast->Type) {
-        case Body: return InterpreterDoBody(module, ast);
-        
-        case BAddExpr: return InterpreterDoAdd(module, ast);
-        case BSubExpr: return InterpreterDoSub(module, ast);
-        case BMulExpr: return InterpreterDoMul(module, ast);
-        case BDivExpr: return InterpreterDoDiv(module, ast);
-        case BModExpr: return InterpreterDoMod(module, ast);
-        case BPowExpr: return InterpreterDoPow(module, ast);
-        case BLShift: return InterpreterDoLShift(module, ast);
-        case BRShift: return InterpreterDoRShift(module, ast);
-        case BArithOrExpr: return InterpreterDoArithOr(module, ast);
-        case BArithAndExpr: return InterpreterDoArithAnd(module, ast);
-        case BArithXorExpr: return InterpreterDoXorExpr(module, ast);
-
-        case BLogicOrExpr: return InterpreterDoLogicOr(module, ast);
-        case BLogicAndExpr: return InterpreterDoLogicAnd(module, ast);
-        case BLogicEqExpr: return InterpreterDoLogicEq(module, ast);
-        case BLogicNotEqExpr: return InterpreterDoLogicNotEq(module, ast);
-        case BLogicLtExpr: return InterpreterDoLogicLt(module, ast);
-        case BLogicLtEqExpr: return InterpreterDoLogicLtEq(module, ast);
-        case BLogicGtExpr: return InterpreterDoLogicGt(module, ast);
-        case BLogicGtEqExpr: return InterpreterDoLogicGtEq(module, ast);
-
-        case UNegExpr: return InterpreterDoNegate(module, ast);
-        case ULogicNotExpr: return InterpreterDoLogicNot(module, ast);
-
-        case AssignExpr: return InterpreterDoAssign(module, ast);
-
-        case BooleanNode: return InterpreterDoBoolean(ast);
-        case RealNode: return InterpreterDoReal(ast);
-        case IntegerNode: return InterpreterDoInteger(ast);
-        case StringNode: return InterpreterDoString(ast);
-        case SymbolNode: return InterpreterDoSymbol(module, ast);
-        case FunctionNode: return InterpreterDoDefFunction(module, ast);
-        case ClassNode: return InterpreterDoDefClass(module, ast);
-
-        case CallExpr: return InterpreterDoCall(module, ast);
-        case ArrayIdxExpr: return InterpreterDoArrayIdx(module, ast);
-        case MemberAccessExpr: return InterpreterDoMemberAccess(module, ast);
-        case ReturnExpr: return InterpreterDoReturn(module, ast);
-        case ContinueExpr: return InterpreterDoContinue(module, ast);
-        case BreakExpr: return InterpreterDoBreak(module, ast);
-        case MutExpr: return InterpreterDoMut(module, ast);
-        case ConstExpr: return InterpreterDoConst(module, ast);
-
-        case ForExpr: return InterpreterDoFor(module, ast);
-        case WhileExpr: return InterpreterDoWhile(module, ast);
-        case IfElseExpr: return InterpreterDoIfElse(module, ast);
+#define INTERPRETER_CASE(type, handler) case type: return handler;
+        INTERPRETER_HANDLERS(INTERPRETER_CASE)
+#undef INTERPRETER_CASE
     }
     return &g_TheNilValue;
 }
+#endif
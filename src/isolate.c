@@ -0,0 +1,142 @@
+#include "isolate.h"
+#include "globals.h"
+#include "module_table.h"
+#include "result.h"
+
+#include "runtime/gc.h"
+#include "runtime/runtime_core.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static __thread struct Isolate *TheCurrentIsolate;
+
+static int IsolateMakeGlobalScope(struct Isolate *isolate) {
+    int result;
+    isolate->GlobalScope = calloc(sizeof *isolate->GlobalScope, 1);
+    result = SymbolTableMakeGlobalScope(isolate->GlobalScope);
+    if (R_Success != result) {
+        return result;
+    }
+    isolate->UberScope.Child = isolate->GlobalScope;
+    isolate->GlobalScope->Parent = &isolate->UberScope;
+
+    result = GlobalsInsertTypeConstants(isolate->GlobalScope);
+    if (R_Success != result) {
+        return result;
+    }
+    return RegisterRuntime_coreGlobals(isolate->GlobalScope);
+}
+
+static struct Module *IsolateMakeWorkerModule(struct Isolate *worker, struct Module *shared) {
+    struct IsolateWorkerModule *wm = calloc(sizeof *wm, 1);
+    struct Module *local = malloc(sizeof *local);
+    memcpy(local, shared, sizeof *local);
+    /* Not pushed with SymbolTablePushScope, that would link it in as the
+       module scope's child. Parented to the module scope rather than the
+       scope the parent thread is in, whose locals may change or be
+       popped while the worker runs. */
+    local->CurrentScope = malloc(sizeof *local->CurrentScope);
+    SymbolTableMake(local->CurrentScope);
+    local->CurrentScope->Parent = shared->ModuleScope;
+    wm->Shared = shared;
+    wm->Private = local;
+    wm->Next = worker->WorkerModules;
+    worker->WorkerModules = wm;
+    return local;
+}
+
+/************************ Public Functions *************************/
+
+int IsolateMake(struct Isolate *isolate) {
+    if (!isolate) {
+        return R_InvalidArgument;
+    }
+    memset(isolate, 0, sizeof *isolate);
+    return IsolateMakeGlobalScope(isolate);
+}
+
+int IsolateFree(struct Isolate *isolate) {
+    struct Isolate *previous = TheCurrentIsolate;
+    int result;
+    if (!isolate) {
+        return R_InvalidArgument;
+    }
+    TheCurrentIsolate = isolate;
+    result = GC_FreeHeap();
+    TheCurrentIsolate = previous == isolate ? NULL : previous;
+    if (R_Success != result) {
+        return result;
+    }
+    isolate->UberScope.Child = NULL;
+    result = SymbolTableFree(isolate->GlobalScope);
+    free(isolate->GlobalScope);
+    isolate->GlobalScope = NULL;
+    free(isolate->CameFrom);
+    isolate->CameFrom = NULL;
+    return result;
+}
+
+int IsolateMakeWorker(struct Isolate *worker, struct Isolate *parent) {
+    if (!worker || !parent) {
+        return R_InvalidArgument;
+    }
+    memset(worker, 0, sizeof *worker);
+    worker->Parent = parent;
+    worker->GlobalScope = parent->GlobalScope;
+    worker->GC.Disabled = 1;
+    return R_Success;
+}
+
+int IsolateJoinWorker(struct Isolate *worker) {
+    struct IsolateWorkerModule *wm, *next;
+    int result;
+    if (!worker || !worker->Parent || worker->Parent != TheCurrentIsolate) {
+        return R_InvalidArgument;
+    }
+    result = GC_AdoptHeap(worker);
+    for (wm = worker->WorkerModules; wm; wm = next) {
+        next = wm->Next;
+        SymbolTableFree(wm->Private->CurrentScope);
+        free(wm->Private->CurrentScope);
+        free(wm->Private);
+        free(wm);
+    }
+    worker->WorkerModules = NULL;
+    worker->GlobalScope = NULL;
+    worker->Parent = NULL;
+    return result;
+}
+
+struct Module *IsolateModuleFor(struct Isolate *isolate, struct Module *module) {
+    struct IsolateWorkerModule *wm;
+    if (!isolate || !isolate->Parent || !module) {
+        return module;
+    }
+    for (wm = isolate->WorkerModules; wm; wm = wm->Next) {
+        if (module == wm->Shared) {
+            return wm->Private;
+        }
+    }
+    return IsolateMakeWorkerModule(isolate, module);
+}
+
+int IsolateEnter(struct Isolate *isolate) {
+    if (!isolate) {
+        return R_InvalidArgument;
+    }
+    TheCurrentIsolate = isolate;
+    return R_Success;
+}
+
+int IsolateExit(struct Isolate *isolate) {
+    if (!isolate || isolate != TheCurrentIsolate) {
+        return R_InvalidArgument;
+    }
+    TheCurrentIsolate = NULL;
+    return R_Success;
+}
+
+struct Isolate *IsolateCurrent(void) {
+    return TheCurrentIsolate;
+}
@@ -45,99 +45,255 @@ int LexerIsInvalid(struct Lexer *lexer) {
     return !LexerIsValid(lexer);
 }
 
+/* Character classes of every byte, bytes past 127 belong to none. */
+#define CC_SPACE 1 /* Whitespace other than newlines */
+#define CC_DIGIT 2
+#define CC_ALPHA 4
+#define CC_IDENT 8
+#define CC_HEX 16
+
+static const unsigned char CharClasses[256] = {
+     0,  0,  0,  0,  0,  0,  0,  0,
+     0,  1,  0,  1,  1,  1,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,
+     1,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,
+    26, 26, 26, 26, 26, 26, 26, 26,
+    26, 26,  0,  0,  0,  0,  0,  0,
+     0, 28, 28, 28, 28, 28, 28, 12,
+    12, 12, 12, 12, 12, 12, 12, 12,
+    12, 12, 12, 12, 12, 12, 12, 12,
+    12, 12, 12,  0,  0,  0,  0,  8,
+     0, 28, 28, 28, 28, 28, 28, 12,
+    12, 12, 12, 12, 12, 12, 12, 12,
+    12, 12, 12, 12, 12, 12, 12, 12,
+    12, 12, 12,  0,  0,  0,  0,  0,
+};
+
+#define CHAR_CLASS(c) (CharClasses[(unsigned char)(c)])
+
 int IsWhitespace(int c) {
-    if ('\n' == c) return 0;
-    return isspace(c);
+    return CHAR_CLASS(c) & CC_SPACE;
 }
 int IsDigit(int c) {
-    return '0' <= c && c <= '9';
+    return CHAR_CLASS(c) & CC_DIGIT;
 }
 int IsHexDigit(int c) {
-    return IsDigit(c) ||
-        ('a' <= c && c <= 'f') ||
-        ('A' <= c && c <= 'F');
+    return CHAR_CLASS(c) & CC_HEX;
 }
 int IsAlpha(int c) {
-    return ('a' <= c && c <= 'z') ||
-        ('A' <= c && c <= 'Z');
+    return CHAR_CLASS(c) & CC_ALPHA;
 }
 int IsAlphaNum(int c) {
-    return IsAlpha(c) || IsDigit(c);
+    return CHAR_CLASS(c) & (CC_ALPHA | CC_DIGIT);
 }
 int IsIdentStartChar(int c) {
-    return '_' == c || IsAlpha(c);
+    return (CHAR_CLASS(c) & CC_IDENT) && !(CHAR_CLASS(c) & CC_DIGIT);
 }
 int IsIdentChar(int c) {
-    return IsIdentStartChar(c) || IsDigit(c);
+    return CHAR_CLASS(c) & CC_IDENT;
 }
 
-int LexerParseString(struct Lexer *lexer, enum TokenType *out_type, char **out_str) {
-    char *begin, *end, *str, *tmp;
-    unsigned int len;
-    end = begin = lexer->Pos;
-    LEX_ADVE(lexer, end); /* Eat the beginning " */
-    while (*end && *end != '"') {
-        if ('\\' == *end && '"' == *(end+1)) {
-            LEX_ADVE(lexer, end);
+/* The scanners below return the length of the run of bytes starting at p
+   that belong to a class, the nul terminator belongs to none of them. */
+#ifdef __SSE2__
+#include <emmintrin.h>
+
+/* Loads are 16 byte aligned so they never cross into the next page, the
+   bytes before p or after the terminator they read are masked off. */
+#if defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define LEXER_NO_ASAN __attribute__((no_sanitize_address))
+#endif
+#elif defined(__SANITIZE_ADDRESS__)
+#define LEXER_NO_ASAN __attribute__((no_sanitize_address))
+#endif
+#ifndef LEXER_NO_ASAN
+#define LEXER_NO_ASAN
+#endif
+
+#define SCAN_RUN(name, match)                                           \
+    LEXER_NO_ASAN static unsigned int name(const char *p) {             \
+        const char *block = (const char*)((size_t)p & ~(size_t)15);     \
+        unsigned int off = p - block, miss;                             \
+        __m128i c;                                                      \
+        c = _mm_load_si128((const __m128i*)block);                      \
+        miss = ~(unsigned int)_mm_movemask_epi8(match) & 0xffff;        \
+        miss >>= off;                                                   \
+        while (!miss) {                                                 \
+            block += 16;                                                \
+            c = _mm_load_si128((const __m128i*)block);                  \
+            miss = ~(unsigned int)_mm_movemask_epi8(match) & 0xffff;    \
+            off = 0;                                                    \
+        }                                                               \
+        return (block - p) + off + __builtin_ctz(miss);                 \
+    }
+
+/* Bytes past 127 compare as negative so they fall outside every range. */
+#define IN_RANGE(c, lo, hi) \
+    _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8((lo) - 1)), _mm_cmplt_epi8(c, _mm_set1_epi8((hi) + 1)))
+#define IS_BYTE(c, b) _mm_cmpeq_epi8(c, _mm_set1_epi8(b))
+
+SCAN_RUN(ScanIdent,
+         _mm_or_si128(_mm_or_si128(IN_RANGE(c, '0', '9'),
+                                   IN_RANGE(_mm_or_si128(c, _mm_set1_epi8(0x20)), 'a', 'z')),
+                      IS_BYTE(c, '_')))
+SCAN_RUN(ScanSpace,
+         _mm_or_si128(IS_BYTE(c, ' '),
+                      _mm_andnot_si128(IS_BYTE(c, '\n'), IN_RANGE(c, '\t', '\r'))))
+/* Everything but the closing quote, escapes and the terminator. */
+SCAN_RUN(ScanStringBody,
+         _mm_xor_si128(_mm_or_si128(_mm_or_si128(IS_BYTE(c, '"'), IS_BYTE(c, '\\')), IS_BYTE(c, 0)),
+                       _mm_set1_epi8(-1)))
+
+static unsigned int CountNewlines(const char *p, unsigned int n) {
+    const __m128i nl = _mm_set1_epi8('\n');
+    unsigned int count = 0, i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i c = _mm_loadu_si128((const __m128i*)(p + i));
+        count += __builtin_popcount(_mm_movemask_epi8(_mm_cmpeq_epi8(c, nl)));
+    }
+    for (; i < n; ++i) {
+        count += '\n' == p[i];
+    }
+    return count;
+}
+
+#else
+
+static unsigned int ScanIdent(const char *p) {
+    const char *q = p;
+    while (CHAR_CLASS(*q) & CC_IDENT) {
+        ++q;
+    }
+    return q - p;
+}
+static unsigned int ScanSpace(const char *p) {
+    const char *q = p;
+    while (CHAR_CLASS(*q) & CC_SPACE) {
+        ++q;
+    }
+    return q - p;
+}
+static unsigned int ScanStringBody(const char *p) {
+    return strcspn(p, "\"\\");
+}
+static unsigned int CountNewlines(const char *p, unsigned int n) {
+    unsigned int count = 0, i;
+    for (i = 0; i < n; ++i) {
+        count += '\n' == p[i];
+    }
+    return count;
+}
+
+#endif
+
+/* Advances over n bytes, none of them the terminator. */
+static void LexerSkip(struct Lexer *lexer, unsigned int n) {
+    unsigned int lines = CountNewlines(lexer->Pos, n);
+    char *p = lexer->Pos + n;
+    if (lines) {
+        lexer->CurrentLineNumber += lines;
+        while ('\n' != *(p - 1)) {
+            --p;
         }
-        LEX_ADVE(lexer, end);
+        lexer->CurrentColumnNumber = 1 + (lexer->Pos + n - p);
     }
-    LEX_ADVE(lexer, end);
-    len = end - begin;
-    str = malloc(len+1);
-    tmp = str;
-    /* Copy into str */
-    while (begin < end) {
-        *tmp++ = *begin++;
+    else {
+        lexer->CurrentColumnNumber += n;
     }
-    *tmp = 0;
-    lexer->Pos = begin;
+    lexer->Pos += n;
+}
+
+/* Like LexerSkip for bytes known not to be newlines. */
+static void LexerSkipLine(struct Lexer *lexer, unsigned int n) {
+    lexer->CurrentColumnNumber += n;
+    lexer->Pos += n;
+}
+
+int LexerParseString(struct Lexer *lexer, enum TokenType *out_type, char **out_text, unsigned int *out_length) {
+    char *begin, *end;
+    begin = lexer->Pos;
+    LEX_ADV(lexer); /* Eat the beginning " */
+    while (1) {
+        LexerSkip(lexer, ScanStringBody(lexer->Pos));
+        if ('\\' != *lexer->Pos) {
+            break;
+        }
+        LexerSkip(lexer, '"' == *(lexer->Pos + 1) ? 2 : 1);
+    }
+    LEX_ADV(lexer);
+    end = lexer->Pos;
+    lexer->Pos = end;
     *out_type = TokenStringLiteral;
-    *out_str = str;
+    *out_text = begin;
+    *out_length = end - begin;
     return 0;
 }
-int LexerParseIdentOrKeyword(struct Lexer *lexer, enum TokenType *out_type, char **out_str) {
-    char *begin, *end, *str, *tmp;
-    unsigned int len;
-    enum TokenType type;
-    end = begin = lexer->Pos;
-    while (*end && IsIdentChar(*end)) {
-        LEX_ADVE(lexer, end);
+
+#define KEYWORD_MIN_LENGTH 2
+#define KEYWORD_MAX_LENGTH 8
+#define KEYWORD_HASH(str, len) (((len) + (str)[0] + (str)[1] + 12 * (str)[(len) - 1]) & 31)
+
+struct Keyword {
+    const char *Text;
+    unsigned int Length;
+    enum TokenType Type;
+};
+
+/* Indexed by KEYWORD_HASH, which is perfect over the keywords so an
+   identifier needs at most one comparison. A new keyword may need new
+   constants in the hash. */
+static const struct Keyword Keywords[32] = {
+    [ 0] = {"while",    5, TokenWhile},
+    [ 5] = {"return",   6, TokenReturn},
+    [ 6] = {"true",     4, TokenTrue},
+    [ 7] = {"const",    5, TokenConst},
+    [ 8] = {"false",    5, TokenFalse},
+    [10] = {"nil",      3, TokenNil},
+    [12] = {"import",   6, TokenImport},
+    [16] = {"for",      3, TokenFor},
+    [17] = {"else",     4, TokenElse},
+    [20] = {"def",      3, TokenDef},
+    [21] = {"mut",      3, TokenMut},
+    [22] = {"continue", 8, TokenContinue},
+    [23] = {"yield",    5, TokenYield},
+    [24] = {"class",    5, TokenClass},
+    [25] = {"if",       2, TokenIf},
+    [26] = {"as",       2, TokenAs},
+    [29] = {"break",    5, TokenBreak},
+};
+
+static enum TokenType LexerKeywordType(const char *str, unsigned int len) {
+    const struct Keyword *kw;
+    if (len < KEYWORD_MIN_LENGTH || len > KEYWORD_MAX_LENGTH) {
+        return TokenIdentifer;
     }
-    len = end - begin;
-    str = malloc(len+1);
-    tmp = str;
-    /* Copy into str */
-    while (begin < end) {
-        *tmp++ = *begin++;
-    }
-    *tmp = 0;
-    if (STR_EQ(str, "def")) { type = TokenDef; }
-    else if (STR_EQ(str, "import")) { type = TokenImport; }
-    else if (STR_EQ(str, "as")) { type = TokenAs; }
-    else if (STR_EQ(str, "mut")) { type = TokenMut; }
-    else if (STR_EQ(str, "const")) { type = TokenConst; }
-    else if (STR_EQ(str, "return")) { type = TokenReturn; }
-    else if (STR_EQ(str, "break")) { type = TokenBreak; }
-    else if (STR_EQ(str, "continue")) { type = TokenContinue; }
-    else if (STR_EQ(str, "class")) { type = TokenClass; }
-    else if (STR_EQ(str, "if")) { type = TokenIf; }
-    else if (STR_EQ(str, "else")) { type = TokenElse; }
-    else if (STR_EQ(str, "for")) { type = TokenFor; }
-    else if (STR_EQ(str, "while")) { type = TokenWhile; }
-    else if (STR_EQ(str, "true")) { type = TokenTrue; }
-    else if (STR_EQ(str, "false")) { type = TokenFalse; }
-    else if (STR_EQ(str, "nil")) { type = TokenNil; }
-    else { type = TokenIdentifer; }
-    lexer->Pos = begin;
-    *out_type = type;
-    *out_str = str;
-    return R_OK;
+    kw = &Keywords[KEYWORD_HASH(str, len)];
+    if (kw->Length == len && 0 == memcmp(kw->Text, str, len)) {
+        return kw->Type;
+    }
+    return TokenIdentifer;
 }
-int LexerParseNumber(struct Lexer *lexer, enum TokenType *out_type, char **out_str) {
-    char *begin, *end, *str, *tmp;
+
+int LexerParseIdentOrKeyword(struct Lexer *lexer, enum TokenType *out_type, char **out_text, unsigned int *out_length) {
+    char *begin, *end;
     unsigned int len;
     enum TokenType type;
+    begin = lexer->Pos;
+    len = ScanIdent(begin);
+    LexerSkipLine(lexer, len);
+    end = lexer->Pos;
+    type = LexerKeywordType(begin, len);
+    lexer->Pos = end;
+    *out_type = type;
+    *out_text = begin;
+    *out_length = len;
+    return R_Success;
+}
+int LexerParseNumber(struct Lexer *lexer, enum TokenType *out_type, char **out_text, unsigned int *out_length) {
+    char *begin, *end;
     int fp = 0;
     end = begin = lexer->Pos;
 
@@ -154,34 +310,23 @@ int LexerParseNumber(struct Lexer *lexer, enum TokenType *out_type, char **out_s
     }
 
 done:
-    len = end - begin;
-    str = malloc(len+1);
-    tmp = str;
-    /* Copy into str */
-    while (begin < end) {
-        *tmp++ = *begin++;
-    }
-    *tmp = 0;
-    type = fp ? TokenRealConstant : TokenIntegerConstant;
-
-    lexer->Pos = begin;
-    *out_type = type;
-    *out_str = str;
-    return R_OK;
+    lexer->Pos = end;
+    *out_type = fp ? TokenRealConstant : TokenIntegerConstant;
+    *out_text = begin;
+    *out_length = end - begin;
+    return R_Success;
 }
 
 #define OPER_CHK(lit, token) \
     if (STRN_EQ(lit, str, STRLEN_LIT(lit))) {type = token; adv = STRLEN_LIT(lit);}
 #define OPER_CHKe(lit, token) else OPER_CHK(lit, token)
 
-int LexerParseOther(struct Lexer *lexer, enum TokenType *out_type, char **out_str) {
+int LexerParseOther(struct Lexer *lexer, enum TokenType *out_type, char **out_text, unsigned int *out_length) {
     char *str;
     unsigned int adv = 0;
     enum TokenType type;
+    LexerSkipLine(lexer, ScanSpace(lexer->Pos));
     str = lexer->Pos;
-    while (*str && IsWhitespace(*str)) {
-        LEX_ADVE(lexer, str);
-    }
 
     OPER_CHK("...", TokenDotDotDot)
     OPER_CHKe("<<=", TokenLtLtEq)
@@ -232,88 +377,106 @@ int LexerParseOther(struct Lexer *lexer, enum TokenType *out_type, char **out_st
     else if (!*str) { goto end_of_stream; }
     else { type = TokenUnknown; }
 
-    str = strndup(str, adv);
     LEX_ADVN(lexer, adv);
     *out_type = type;
-    *out_str = str;
-    return R_OK;
+    *out_text = str;
+    *out_length = adv;
+    return R_Success;
 
 handle_newline:
     LEX_ADVN(lexer, 1);
     *out_type = TokenNewline;
-    *out_str = strdup("<newline>");
-    return R_OK;
+    *out_text = (char*)"<newline>";
+    *out_length = STRLEN_LIT("<newline>");
+    return R_Success;
 
 end_of_stream:
-    str = strdup("<EOS>");
     *out_type = TokenEOS;
-    *out_str = str;
+    *out_text = (char*)"<EOS>";
+    *out_length = STRLEN_LIT("<EOS>");
     lexer->REPLPrompt = REPLPrompt_Begin;
-    return R_OK;
+    return R_Success;
 }
 
-int LexerParseThing(struct Lexer *lexer, enum TokenType *out_type, char **out_str) {
+int LexerParseThing(struct Lexer *lexer, enum TokenType *out_type, char **out_text, unsigned int *out_length) {
     char *p = lexer->Pos;
     if ('"' == *p) {
-        return LexerParseString(lexer, out_type, out_str);
+        return LexerParseString(lexer, out_type, out_text, out_length);
     }
     else if (IsIdentStartChar(*p)) {
-        return LexerParseIdentOrKeyword(lexer, out_type, out_str);
+        return LexerParseIdentOrKeyword(lexer, out_type, out_text, out_length);
     }
     else if (IsDigit(*p)) {
-        return LexerParseNumber(lexer, out_type, out_str);
+        return LexerParseNumber(lexer, out_type, out_text, out_length);
     }
-    return LexerParseOther(lexer, out_type, out_str);
+    return LexerParseOther(lexer, out_type, out_text, out_length);
 }
 
-struct Token *LexerGetNextToken(struct Lexer *lexer, int consumeToken) {
-    struct Token *token;
+int LexerGetNextToken(struct Lexer *lexer, struct Token *token, int consumeToken) {
     int line, column;
-    char *out_str, *oldPos;
-    unsigned int oldCurrentLineNumber, oldCurrentColumnNumber;
+    char *out_text, *oldPos;
+    unsigned int out_length, oldCurrentLineNumber, oldCurrentColumnNumber;
     enum TokenType out_type;
 non_recursive_call:
-    while (*lexer->Pos && IsWhitespace(*lexer->Pos)) 
-        LEX_ADV(lexer);
+    LexerSkipLine(lexer, ScanSpace(lexer->Pos));
     if (*lexer->Pos == '#') {
-        while (*lexer->Pos && '\n' != *lexer->Pos) {
-            LEX_ADV(lexer);
-        }
+        LexerSkipLine(lexer, strcspn(lexer->Pos, "\n"));
         goto non_recursive_call;
     }
-    token = malloc(sizeof *token);
     oldPos = lexer->Pos;
     oldCurrentLineNumber = line = lexer->CurrentLineNumber;
     oldCurrentColumnNumber = column = lexer->CurrentColumnNumber;
-    if (R_OK != LexerParseThing(lexer, &out_type, &out_str)) {
-        free(token);
-        return NULL;
+    if (R_Success != LexerParseThing(lexer, &out_type, &out_text, &out_length)) {
+        return R_OperationFailed;
     }
     if (!consumeToken) {
         lexer->Pos = oldPos;
         lexer->CurrentLineNumber = oldCurrentLineNumber;
         lexer->CurrentColumnNumber = oldCurrentColumnNumber;
     }
-    TokenMake(token, out_type, out_str, lexer->Filename, line, column);
-    free(out_str);
-    return token;
+    return TokenMake(token, out_type, out_text, out_length, lexer->Filename, line, column);
 }
 
-int LexerSharedGetNext(struct Lexer *lexer, struct Token **out_token, int consume) {
-    struct Token *token;
+int LexerSharedGetNext(struct Lexer *lexer, struct Token *token, int consume) {
     if (LexerIsInvalid(lexer)) {
         return R_InvalidArgument;
     }
-    token = LexerGetNextToken(lexer, consume);
-    if (!out_token) {
-        TokenFree(token);
-        free(token);
+    if (!token) {
         return -1; /* TODO: Maybe this should be fine? */
     }
-    *out_token = token;
-    return R_OK;
+    return LexerGetNextToken(lexer, token, consume);
+}
+/* Tokens of a statement that spans several lines still point into the
+   earlier lines, keep them until the statement is thrown away. */
+void LexerRetireCode(struct Lexer *lexer) {
+    struct LexerChunk *chunk;
+    if (!lexer->Code || !lexer->OwnsCode) {
+        return;
+    }
+    chunk = malloc(sizeof *chunk);
+    chunk->Code = lexer->Code;
+    chunk->Next = lexer->Retired;
+    lexer->Retired = chunk;
+    lexer->Code = NULL;
+    lexer->OwnsCode = 0;
+}
+
+void LexerFreeCode(struct Lexer *lexer) {
+    struct LexerChunk *chunk, *next;
+    for (chunk = lexer->Retired; chunk; chunk = next) {
+        next = chunk->Next;
+        free(chunk->Code);
+        free(chunk);
+    }
+    lexer->Retired = NULL;
+    if (lexer->OwnsCode) {
+        free(lexer->Code);
+    }
+    lexer->Code = NULL;
+    lexer->OwnsCode = 0;
 }
-int LexerSharedGetNextREPL(struct Lexer *lexer, struct Token **out_token, int consume) {
+
+int LexerSharedGetNextREPL(struct Lexer *lexer, struct Token *token, int consume) {
     char *buf;
     const int inc = 1024;
     int c, i, len, size = inc;
@@ -321,9 +484,9 @@ int LexerSharedGetNextREPL(struct Lexer *lexer, struct Token **out_token, int co
         LEX_ADV(lexer);
     }
     if (lexer->Pos && *lexer->Pos) {
-        return LexerSharedGetNext(lexer, out_token, consume);
+        return LexerSharedGetNext(lexer, token, consume);
     }
-    free(lexer->Code);
+    LexerRetireCode(lexer);
     buf = malloc(size);
     printf("%03d > ", lexer->CurrentLineNumber);
     lexer->REPLPrompt = REPLPrompt_Secondary;
@@ -341,9 +504,10 @@ int LexerSharedGetNextREPL(struct Lexer *lexer, struct Token **out_token, int co
     len = strlen(buf);
     buf = realloc(buf, 1 + len);
     lexer->Code = buf;
+    lexer->OwnsCode = 1;
     lexer->Pos = lexer->Code;
     lexer->Length = len;
-    return LexerSharedGetNext(lexer, out_token, consume);
+    return LexerSharedGetNext(lexer, token, consume);
 }
 
 /*********************** Public Functions ************************/
@@ -353,14 +517,16 @@ int LexerMake(struct Lexer *lexer, char *filename, char *code) {
         return R_InvalidArgument;
     }
     lexer->Filename = strdup(filename);
-    lexer->Code = code ? strdup(code) : NULL;
+    lexer->Code = code;
+    lexer->OwnsCode = 0;
+    lexer->Retired = NULL;
     lexer->Pos = lexer->Code;
     lexer->Length = !lexer->Code ? 0 : strlen(lexer->Code);
     lexer->CurrentLineNumber = 1;
     lexer->CurrentColumnNumber = 1;
     lexer->REPL = 0;
     lexer->REPLPrompt = REPLPrompt_Begin;
-    return R_OK;
+    return R_Success;
 }
 
 int LexerFree(struct Lexer *lexer) {
@@ -368,31 +534,56 @@ int LexerFree(struct Lexer *lexer) {
         return R_InvalidArgument;
     }
     //free(lexer->Filename); /* TODO: Handle freeing the filenames better */
-    free(lexer->Code);
-    return R_OK;
+    LexerFreeCode(lexer);
+    return R_Success;
 }
 
 int LexerThrowAwayCode(struct Lexer *lexer) {
     if (LexerIsInvalid(lexer)) {
         return R_InvalidArgument;
     }
-    free(lexer->Code);
-    lexer->Code = NULL;
+    LexerFreeCode(lexer);
     lexer->Pos = lexer->Code;
     lexer->Length = 0;
-    return R_OK;
+    return R_Success;
 }
 
-int LexerNextToken(struct Lexer *lexer, struct Token **out_token) {
+int LexerNextTokenInPlace(struct Lexer *lexer, struct Token *token) {
     if (!lexer->REPL) {
-        return LexerSharedGetNext(lexer, out_token, 1);
+        return LexerSharedGetNext(lexer, token, 1);
     }
-    return LexerSharedGetNextREPL(lexer, out_token, 1);
+    return LexerSharedGetNextREPL(lexer, token, 1);
+}
+
+int LexerNextToken(struct Lexer *lexer, struct Token **out_token) {
+    int result;
+    if (!out_token) {
+        return R_InvalidArgument;
+    }
+    *out_token = malloc(sizeof **out_token);
+    result = LexerNextTokenInPlace(lexer, *out_token);
+    if (R_Success != result) {
+        free(*out_token);
+        *out_token = NULL;
+    }
+    return result;
 }
 
 int LexerPeekToken(struct Lexer *lexer, struct Token **out_token) {
+    int result;
+    if (!out_token) {
+        return R_InvalidArgument;
+    }
+    *out_token = malloc(sizeof **out_token);
     if (!lexer->REPL) {
-        return LexerSharedGetNext(lexer, out_token, 0);
+        result = LexerSharedGetNext(lexer, *out_token, 0);
+    }
+    else {
+        result = LexerSharedGetNextREPL(lexer, *out_token, 0);
+    }
+    if (R_Success != result) {
+        free(*out_token);
+        *out_token = NULL;
     }
-    return LexerSharedGetNextREPL(lexer, out_token, 0);
+    return result;
 }
@@ -1,4 +1,5 @@
 #include "little_lang_machine.h"
+#include "interpreter.h"
 #include "ast.h"
 
 #include <stdlib.h>
@@ -12,5 +13,6 @@ int main(int argc, char **argv) {
     }
     result = LittleLangMachineRun(&llm);
     LittleLangMachineDenit(&llm);
+    InterpreterDenit();
     return result;
 }
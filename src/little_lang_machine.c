@@ -1,12 +1,21 @@
 #include "little_lang_machine.h"
 #include "parser.h"
+#include "module_cache.h"
+#include "optimizer.h"
 #include "globals.h"
 #include "interpreter.h"
+#include "isolate.h"
 #include "helpers/strings.h"
 #include "helpers/ast_pretty_printer.h"
+#include "helpers/io.h"
 #include "runtime/gc.h"
+#include "runtime/generator.h"
 #include "value.h"
 #include "path_resolver.h"
+#include "profiler.h"
+#include "tracer.h"
+#include "heap_profiler.h"
+#include "thread_pool.h"
 #include "result.h"
 
 #include <limits.h>
@@ -15,37 +24,27 @@
 #include <string.h>
 #include <time.h>
 
-char *CameFrom;
 char *StdinString = "<stdin>";
 
+#define PROFILE_DEFAULT_OUTPUT "profile.folded"
+
 static struct SrcLoc srcLoc = {"<little_lang_machine.c>", -1, -1};
 
 int LittleLangMachineIsValid(struct LittleLangMachine *llm) {
-    return llm && llm->Lexer && llm->AllImportedModules;
+    return llm && llm->Lexer && llm->AllImportedModules && llm->Isolate;
 }
 
 int LittleLangMachineIsInvalid(struct LittleLangMachine *llm) {
     return !LittleLangMachineIsValid(llm);
 }
 
-char *ReadFile(char *filename) {
-    unsigned int len;
-    int c;
-    char *tmp, *code = NULL;
-    FILE *file = fopen(filename, "rb");
-    if (file) {
-        fseek(file, 0, SEEK_END);
-        len = ftell(file);
-        rewind(file);
-        code = malloc(len+1);
-        tmp = code;
-        while (EOF != (c = fgetc(file))) {
-            *tmp++ = c;
-        }
-        *tmp = 0;
-        fclose(file);
-    }
-    return code;
+/* Maps the source of filename, the lexer works on it in place. NULL if it
+   could not be read. */
+char *ReadFile(char *filename, struct MappedFile *out_file) {
+    if (0 != MappedFileOpen(out_file, filename)) {
+        return NULL;
+    }
+    return out_file->Data;
 }
 
 void ShowHelpMsg(void) {
@@ -56,6 +55,17 @@ void ShowHelpMsg(void) {
             "\n-P --pretty-print-ast         Pretty print the program's AST."
             "\n-T --time-execution           Times the execution of the program."
             "\n-i                            Enters REPL mode after program execution."
+            "\n--no-module-cache             Always parse modules, never read or write .llc caches."
+            "\n--lazy-imports                Runs an imported module's top level code on first use."
+            "\n--profile[=file]              Samples the program as it runs, prints a flat profile and"
+            "\n                              writes collapsed stacks to file, " PROFILE_DEFAULT_OUTPUT " by default."
+            "\n--trace[=file]                Counts calls and times every function, prints a table"
+            "\n                              sorted by self time and writes the counts to file as JSON."
+            "\n--gc-stats                    Prints collection counts, pause times and heap sizes at exit."
+            "\n--heap-profile                Records where objects are allocated and prints the lines"
+            "\n                              holding the most live objects at exit, see __heap_profile()."
+            "\n--generator-stack=KB          Stack of every generator, 8192 KB by default. Calls made"
+            "\n                              by a generator that would overflow it fail with an error."
             "\nfile                          The program source to run."
             "\n-args ...                     Passes anything after this flag to the program."
             "\n"
@@ -86,6 +96,34 @@ int LittleLangMachineDoOpts(struct LittleLangMachine *llm, int argc, char **argv
         else if (STR_EQ("-i", arg)) {
             llm->CmdOpts.ReplMode = 1;
         }
+        else if (STR_EQ("--no-module-cache", arg)) {
+            llm->CmdOpts.NoModuleCache = 1;
+        }
+        else if (STR_EQ("--lazy-imports", arg)) {
+            llm->CmdOpts.LazyImports = 1;
+        }
+        else if (STR_EQ("--profile", arg)) {
+            llm->CmdOpts.ProfileOutput = PROFILE_DEFAULT_OUTPUT;
+        }
+        else if (0 == strncmp("--profile=", arg, strlen("--profile="))) {
+            llm->CmdOpts.ProfileOutput = arg + strlen("--profile=");
+        }
+        else if (STR_EQ("--trace", arg)) {
+            llm->CmdOpts.Trace = 1;
+        }
+        else if (0 == strncmp("--trace=", arg, strlen("--trace="))) {
+            llm->CmdOpts.Trace = 1;
+            llm->CmdOpts.TraceOutput = arg + strlen("--trace=");
+        }
+        else if (STR_EQ("--gc-stats", arg)) {
+            llm->CmdOpts.GCStats = 1;
+        }
+        else if (STR_EQ("--heap-profile", arg)) {
+            llm->CmdOpts.HeapProfile = 1;
+        }
+        else if (0 == strncmp("--generator-stack=", arg, strlen("--generator-stack="))) {
+            llm->CmdOpts.GeneratorStack = strtoul(arg + strlen("--generator-stack="), NULL, 10);
+        }
         else if (!filename && FileExists(arg)) {
             filename = arg;
         }
@@ -93,14 +131,14 @@ int LittleLangMachineDoOpts(struct LittleLangMachine *llm, int argc, char **argv
     llm->CmdOpts.argc = argc;
     llm->CmdOpts.argv = argv;
     if (filename) {
-        llm->CmdOpts.code = ReadFile(filename);
+        llm->CmdOpts.code = ReadFile(filename, &llm->CmdOpts.source);
         llm->CmdOpts.filename = filename;
     }
     else {
         llm->CmdOpts.ReplMode = 1;
         llm->CmdOpts.filename = StdinString;
     }
-    return R_OK;
+    return R_Success;
 }
 
 int DefineFunction(struct Module *module, struct Ast *function) {
@@ -113,11 +151,11 @@ int DefineTopLevelFunctions(struct Module *module, struct Ast *functionDefs) {
     unsigned int i;
     int result;
     if (!functionDefs) {
-        return R_OK;
+        return R_Success;
     }
     for (i = 0; i < functionDefs->NumChildren; ++i) {
         result = DefineFunction(module, functionDefs->Children[i]);
-        if (R_OK != result) {
+        if (R_Success != result) {
             break;
         }
     }
@@ -126,17 +164,17 @@ int DefineTopLevelFunctions(struct Module *module, struct Ast *functionDefs) {
 
 int DefineClass(struct Module *module, struct Ast *class) {
     InterpreterRunAst(module, class);
-    return R_OK;
+    return R_Success;
 }
 int DefineClasses(struct Module *module, struct Ast *classDefs) {
     unsigned int i;
     int result;
     if (!classDefs) {
-        return R_OK;
+        return R_Success;
     }
     for (i = 0; i < classDefs->NumChildren; ++i) {
         result = DefineClass(module, classDefs->Children[i]);
-        if (R_OK != result) {
+        if (R_Success != result) {
             break;
         }
     }
@@ -148,12 +186,12 @@ int LittleLangMachineMakeLexer(struct LittleLangMachine *llm) {
     int result;
     llm->Lexer = malloc(sizeof(*llm->Lexer));
     result = LexerMake(llm->Lexer, llm->CmdOpts.filename, llm->CmdOpts.code);
-    if (R_OK != result) {
+    if (R_Success != result) {
         free(llm->Lexer);
         llm->Lexer = NULL;
         return result;
     }
-    return R_OK;
+    return R_Success;
 }
 
 int LittleLangMachineMakeThisModule(struct LittleLangMachine *llm) {
@@ -171,6 +209,7 @@ int LittleLangMachineREPLMode(struct LittleLangMachine *llm) {
     struct TokenStream *tokenStream;
     int result;
     struct Ast *stmt = NULL;
+    struct AstArena *previousArena;
     struct Value *value;
     struct Module *mod;
     char *filename, *as;
@@ -183,10 +222,13 @@ int LittleLangMachineREPLMode(struct LittleLangMachine *llm) {
         LexerThrowAwayCode(llm->Lexer);
         TokenStreamFree(tokenStream);
         TokenStreamMake(tokenStream, llm->Lexer);
-        AstFree(stmt);
 
+        /* Functions defined here live as long as the session, so every
+           statement is kept in the module's arena. */
+        previousArena = AstArenaUse(&llm->ThisModule->Arena);
         result = ParseThing(&stmt, tokenStream);
-        if (R_OK != result || !stmt) {
+        AstArenaUse(previousArena);
+        if (R_Success != result || !stmt) {
             continue;
         }
         if (llm->CmdOpts.PrettyPrintAst) {
@@ -212,31 +254,139 @@ int LittleLangMachineREPLMode(struct LittleLangMachine *llm) {
     return result;
 }
 
-int ParseProgramTrees(char *absPath, struct ParsedTrees **out_programTrees) {
+int ParseProgramTrees(char *absPath, int useCache, struct ParsedTrees **out_programTrees) {
     int result;
     struct ParsedTrees *programTrees;
     struct Lexer *lexer;
+    struct MappedFile source;
     char *code;
     if (!absPath || !out_programTrees) {
         return R_InvalidArgument;
     }
-    code = ReadFile(absPath);
+    code = ReadFile(absPath, &source);
+    programTrees = calloc(sizeof *programTrees, 1);
+    if (useCache && code && R_Success == ModuleCacheLoad(programTrees, absPath, code, source.Length)) {
+        MappedFileClose(&source);
+        *out_programTrees = programTrees;
+        return R_Success;
+    }
     lexer = calloc(sizeof *lexer, 1);
     result = LexerMake(lexer, absPath, code);
-    free(code);
-    if (R_OK != result) {
+    if (R_Success != result) {
+        MappedFileClose(&source);
+        free(lexer);
+        /* Empty trees, callers print and free them like failed parses. */
+        *out_programTrees = programTrees;
         return result;
     }
-    programTrees = calloc(sizeof *programTrees, 1);
     result = Parse(programTrees, lexer);
-    if (R_OK != result) {
-        *out_programTrees = programTrees;
-        return result;
+    if (R_Success == result) {
+        OptimizeTrees(programTrees);
     }
+    if (R_Success == result && useCache) {
+        ModuleCacheStore(programTrees, absPath, code, source.Length);
+    }
+    /* The trees own copies of everything they took from the tokens. */
+    MappedFileClose(&source);
     LexerFree(lexer);
     free(lexer);
+    if (R_Success != result) {
+        *out_programTrees = programTrees;
+        return result;
+    }
     *out_programTrees = programTrees;
-    return R_OK;
+    return R_Success;
+}
+
+/* A module whose trees were parsed before it was loaded. */
+struct PreparsedModule {
+    char *AbsPath;
+    char *Directory;
+    struct ParsedTrees *Trees;
+    int Result;
+};
+
+struct PreparseJob {
+    struct PreparsedModule *Modules;
+    int UseCache;
+};
+
+static void PreparseRange(void *context, unsigned int worker, unsigned int begin, unsigned int end) {
+    struct PreparseJob *job = context;
+    struct PreparsedModule *module;
+    unsigned int i;
+    (void)worker;
+    for (i = begin; i < end; ++i) {
+        module = &job->Modules[i];
+        module->Result = ParseProgramTrees(module->AbsPath, job->UseCache, &module->Trees);
+    }
+}
+
+static struct PreparsedModule *LittleLangMachineFindPreparsed(struct LittleLangMachine *llm, char *absPath) {
+    unsigned int i;
+    for (i = 0; i < llm->NumPreparsed; ++i) {
+        if (0 == strcmp(llm->Preparsed[i].AbsPath, absPath)) {
+            return &llm->Preparsed[i];
+        }
+    }
+    return NULL;
+}
+
+/* Queues every import that was neither loaded nor queued before. */
+static void LittleLangMachineQueueImports(struct LittleLangMachine *llm, char *directory, struct Ast *imports) {
+    struct PreparsedModule *module;
+    struct Module *loaded;
+    char *filename, *absPath;
+    unsigned int i;
+    if (!imports) {
+        return;
+    }
+    for (i = 0; i < imports->NumChildren; ++i) {
+        filename = imports->Children[i]->Children[0]->u.Value->v.String->CString;
+        absPath = ResolvePath(directory, filename);
+        if (!absPath) {
+            continue;
+        }
+        loaded = NULL;
+        ModuleTableFind(llm->AllImportedModules, absPath, &loaded);
+        if (loaded || LittleLangMachineFindPreparsed(llm, absPath)) {
+            free(absPath);
+            continue;
+        }
+        llm->Preparsed = realloc(llm->Preparsed, sizeof *llm->Preparsed * (llm->NumPreparsed + 1));
+        module = &llm->Preparsed[llm->NumPreparsed++];
+        module->AbsPath = absPath;
+        module->Directory = GetDirectory(absPath);
+        module->Trees = NULL;
+        module->Result = R_Success;
+    }
+}
+
+/* Walks the import graph below trees a level at a time. Every module of a
+   level is lexed and parsed on the shared thread pool, they are still run
+   one by one and in the usual order when they are imported. */
+static void LittleLangMachinePreparseImports(struct LittleLangMachine *llm, char *directory, struct ParsedTrees *trees) {
+    struct PreparseJob job;
+    unsigned int i, begin, end;
+    begin = llm->NumPreparsed;
+    LittleLangMachineQueueImports(llm, directory, trees->Imports);
+    while (begin < llm->NumPreparsed) {
+        end = llm->NumPreparsed;
+        job.Modules = llm->Preparsed;
+        job.UseCache = !llm->CmdOpts.NoModuleCache;
+        if (end - begin > 1) {
+            ThreadPoolParallelFor(ThreadPoolShared(), begin, end, 1, PreparseRange, &job);
+        }
+        else {
+            PreparseRange(&job, 0, begin, end);
+        }
+        for (i = begin; i < end; ++i) {
+            if (R_Success == llm->Preparsed[i].Result) {
+                LittleLangMachineQueueImports(llm, llm->Preparsed[i].Directory, llm->Preparsed[i].Trees->Imports);
+            }
+        }
+        begin = end;
+    }
 }
 
 int ImportModules(struct LittleLangMachine *llm, struct Ast *imports, struct ModuleTable **out_imports) {
@@ -244,21 +394,24 @@ int ImportModules(struct LittleLangMachine *llm, struct Ast *imports, struct Mod
     struct Ast *moduleName, *as, *import;
     struct ModuleTable *moduleTable;
     struct Module *module;
-    char *filename, *absPath;
+    char *filename, *absPath, *cameFrom;
     unsigned int i;
     if (!llm || !imports || !out_imports) {
         return R_InvalidArgument;
     }
     moduleTable = calloc(sizeof *moduleTable, 1);
     result = ModuleTableMake(moduleTable);
-    if (R_OK != result) {
+    if (R_Success != result) {
         goto cleanup;
     }
+    /* Loading an import moves CameFrom to its directory, every import here
+       is relative to the importing module though. */
+    cameFrom = strdup(llm->Isolate->CameFrom);
     for (i = 0; i < imports->NumChildren; ++i) {
         import = imports->Children[i];
         moduleName = import->Children[0];
         filename = moduleName->u.Value->v.String->CString;
-        absPath = ResolvePath(CameFrom, filename);
+        absPath = ResolvePath(cameFrom, filename);
         ModuleTableFind(llm->AllImportedModules, absPath, &module);
         if (!module) {
             result = LittleLangMachineLoadModule(llm, absPath, &module);   
@@ -276,9 +429,10 @@ int ImportModules(struct LittleLangMachine *llm, struct Ast *imports, struct Mod
         }
         free(absPath);
     }
+    free(cameFrom);
 
     *out_imports = moduleTable;
-    return R_OK;
+    return R_Success;
 
 cleanup:
     ModuleTableFree(moduleTable);
@@ -289,6 +443,7 @@ cleanup:
 int LittleLangMachineLoadModule(struct LittleLangMachine *llm, char *filename, struct Module **out_module) {
     int result;
     struct ParsedTrees *programTrees;
+    struct PreparsedModule *preparsed;
     struct ModuleTable *imports;
     struct Module *module;
     char *absPath;
@@ -296,12 +451,23 @@ int LittleLangMachineLoadModule(struct LittleLangMachine *llm, char *filename, s
         return R_InvalidArgument;
     }
     absPath = AbsolutePath(filename);
-    free(CameFrom);
-    CameFrom = GetDirectory(absPath);
+    free(llm->Isolate->CameFrom);
+    llm->Isolate->CameFrom = GetDirectory(absPath);
     if (!absPath) {
         return R_FileNotFound;
     }
-    result = ParseProgramTrees(absPath, &programTrees);
+    preparsed = LittleLangMachineFindPreparsed(llm, absPath);
+    if (preparsed && preparsed->Trees) {
+        programTrees = preparsed->Trees;
+        result = preparsed->Result;
+        preparsed->Trees = NULL;
+    }
+    else {
+        result = ParseProgramTrees(absPath, !llm->CmdOpts.NoModuleCache, &programTrees);
+    }
+    if (R_Success == result) {
+        LittleLangMachinePreparseImports(llm, llm->Isolate->CameFrom, programTrees);
+    }
     if (llm->CmdOpts.PrettyPrintAst) {
         printf("Imports:\n");
         AstPrettyPrint(programTrees->Imports);
@@ -313,31 +479,65 @@ int LittleLangMachineLoadModule(struct LittleLangMachine *llm, char *filename, s
         AstPrettyPrint(programTrees->Program);
         printf("\n\n");
     }
-    if (R_OK != result) {
+    if (R_Success != result) {
         goto cleanup;
     }
     result = ImportModules(llm, programTrees->Imports, &imports);
-    if (R_OK != result) {
+    if (R_Success != result) {
         goto cleanup;
     }
     module = calloc(sizeof *module, 1);
     result = ModuleMake(module, programTrees->Program, imports);
-    if (R_OK != result) {
+    if (R_Success != result) {
         free(module);
         goto cleanup;
     }
+    /* The module takes over the arena its trees live in, the one
+       ModuleMake gave it goes first. */
+    AstArenaFree(&module->Arena);
+    module->Arena = programTrees->Arena;
     DefineTopLevelFunctions(module, programTrees->TopLevelFunctions);
     DefineClasses(module, programTrees->Classes);
-    InterpreterRunProgram(module);
+    if (llm->CmdOpts.LazyImports && out_module != &llm->ThisModule) {
+        /* Functions and classes are there already, the rest waits for the
+           first member access into the module. */
+        GC_RegisterSymbolTable(module->ModuleScope);
+        module->NeedsInit = 1;
+    }
+    else {
+        InterpreterRunProgram(module);
+    }
 
     *out_module = module;
-    result = R_OK;
-    free(programTrees);
+    result = R_Success;
 cleanup:
+    if (R_Success != result) {
+        AstArenaFree(&programTrees->Arena);
+    }
+    free(programTrees);
     free(absPath);
     return result;
 }
 
+int LittleLangMachineMakeIsolate(struct LittleLangMachine *llm) {
+    int result;
+    if (!llm) {
+        return R_InvalidArgument;
+    }
+    result = InterpreterInit();
+    if (R_Success != result) {
+        return result;
+    }
+    llm->Isolate = malloc(sizeof *llm->Isolate);
+    result = IsolateMake(llm->Isolate);
+    if (R_Success != result) {
+        free(llm->Isolate);
+        llm->Isolate = NULL;
+        return result;
+    }
+    return R_Success;
+}
+
 int LittleLangMachineMakeModuleLookupTable(struct LittleLangMachine *llm) {
     if (!llm) {
         return R_InvalidArgument;
@@ -358,23 +558,40 @@ int LittleLangMachineInit(struct LittleLangMachine *llm, int argc, char **argv)
     llm->Lexer = NULL;
     llm->AllImportedModules = NULL;
     llm->ThisModule = NULL;
+    llm->Isolate = NULL;
+    llm->Preparsed = NULL;
+    llm->NumPreparsed = 0;
     result = LittleLangMachineDoOpts(llm, argc, argv);
-    if (R_OK != result) {
+    if (R_Success != result) {
         return result;
     }
     result = LittleLangMachineMakeLexer(llm);
-    if (R_OK != result) {
+    if (R_Success != result) {
         return result;
     }
     result = LittleLangMachineMakeModuleLookupTable(llm);
-    if (R_OK != result) {
+    if (R_Success != result) {
+        return result;
+    }
+    result = LittleLangMachineMakeIsolate(llm);
+    if (R_Success != result) {
         return result;
     }
     return result;
 }
 
 int LittleLangMachineDenit(struct LittleLangMachine *llm) {
-    free(llm->CmdOpts.code);
+    unsigned int i;
+    for (i = 0; i < llm->NumPreparsed; ++i) {
+        /* Trees of modules that were never imported after all. */
+        if (llm->Preparsed[i].Trees) {
+            AstArenaFree(&llm->Preparsed[i].Trees->Arena);
+            free(llm->Preparsed[i].Trees);
+        }
+        free(llm->Preparsed[i].AbsPath);
+        free(llm->Preparsed[i].Directory);
+    }
+    free(llm->Preparsed);
 
     ModuleTableFree(llm->AllImportedModules);
     free(llm->AllImportedModules);
@@ -384,12 +601,43 @@ int LittleLangMachineDenit(struct LittleLangMachine *llm) {
 
     LexerFree(llm->Lexer);
     free(llm->Lexer);
+    MappedFileClose(&llm->CmdOpts.source);
 
-    GlobalsDenit();
-    return R_OK;
+    IsolateFree(llm->Isolate);
+    free(llm->Isolate);
+    return R_Success;
 }
 
 
+/* Stops the profiler, the flat profile goes to stderr. */
+static void LittleLangMachineWriteProfile(char *output) {
+    FILE *stacks = fopen(output, "w");
+    if (!stacks) {
+        fprintf(stderr, "Could not write the profile to '%s'\n", output);
+    }
+    ProfilerStop(stderr, stacks);
+    if (stacks) {
+        fclose(stacks);
+        fprintf(stderr, "Collapsed stacks written to '%s'\n", output);
+    }
+}
+
+/* Stops the tracer, the table goes to stderr. */
+static void LittleLangMachineWriteTrace(char *output) {
+    FILE *json = NULL;
+    if (output) {
+        json = fopen(output, "w");
+        if (!json) {
+            fprintf(stderr, "Could not write the trace to '%s'\n", output);
+        }
+    }
+    TracerStop(stderr, json);
+    if (json) {
+        fclose(json);
+        fprintf(stderr, "Call counts written to '%s'\n", output);
+    }
+}
+
 int LittleLangMachineRun(struct LittleLangMachine *llm) {
     int result;
     clock_t start, end;
@@ -397,14 +645,37 @@ int LittleLangMachineRun(struct LittleLangMachine *llm) {
     if (LittleLangMachineIsInvalid(llm)) {
         return R_InvalidArgument;
     }
-    result = GlobalsInit();
-    if (R_OK != result) {
+    result = IsolateEnter(llm->Isolate);
+    if (R_Success != result) {
         return result;
     }
-    InterpreterInit();
+    if (llm->CmdOpts.ProfileOutput) {
+        ProfilerStart(PROFILER_DEFAULT_HZ);
+    }
+    if (llm->CmdOpts.Trace) {
+        TracerStart();
+    }
+    if (llm->CmdOpts.HeapProfile) {
+        HeapProfilerStart();
+    }
+    if (llm->CmdOpts.GeneratorStack && R_Success != GeneratorSetStackSize(llm->CmdOpts.GeneratorStack * 1024U)) {
+        fprintf(stderr, "A generator stack of %luKB is too small, keeping the default\n", llm->CmdOpts.GeneratorStack);
+    }
     start = clock();
     LittleLangMachineLoadModule(llm, llm->CmdOpts.filename, &llm->ThisModule);
     end = clock();
+    if (llm->CmdOpts.ProfileOutput) {
+        LittleLangMachineWriteProfile(llm->CmdOpts.ProfileOutput);
+    }
+    if (llm->CmdOpts.Trace) {
+        LittleLangMachineWriteTrace(llm->CmdOpts.TraceOutput);
+    }
+    if (llm->CmdOpts.HeapProfile) {
+        HeapProfilerStop(stderr);
+    }
+    if (llm->CmdOpts.GCStats) {
+        GC_PrintStats(stderr);
+    }
     if (llm->CmdOpts.TimeExecution) {
         time = (end - start) * 1.0 / CLOCKS_PER_SEC;
         printf("\nfinished program execution in %fs\n", time);
@@ -412,5 +683,6 @@ int LittleLangMachineRun(struct LittleLangMachine *llm) {
     if (llm->CmdOpts.ReplMode) {
         LittleLangMachineREPLMode(llm);
     }
+    IsolateExit(llm->Isolate);
     return result;
 }
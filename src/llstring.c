@@ -18,7 +18,7 @@ int LLStringMake(struct LLString *string, char *cString) {
         *s++ = *cString++;
     }
     *s = 0;
-    return R_OK;
+    return R_Success;
 }
 int LLStringFree(struct LLString *string) {
     if (!string) {
@@ -27,7 +27,7 @@ int LLStringFree(struct LLString *string) {
     string->Length = 0;
     free(string->CString);
     string->CString = NULL;
-    return R_OK;
+    return R_Success;
 }
 
 int LLStringCharAt(struct LLString *string, unsigned int idx, struct LLString **out_string) {
@@ -44,7 +44,7 @@ int LLStringCharAt(struct LLString *string, unsigned int idx, struct LLString **
     out = malloc(sizeof *out);
     LLStringMake(out, c);
     *out_string = out;
-    return R_OK;
+    return R_Success;
 }
 int LLStringConcatenate(struct LLString *s1, struct LLString *s2, struct LLString **out_string) {
     struct LLString *out;
@@ -68,7 +68,7 @@ int LLStringConcatenate(struct LLString *s1, struct LLString *s2, struct LLStrin
     }
     *s = 0;
     *out_string = out;
-    return R_OK;
+    return R_Success;
 }
 int LLStringSlice(struct LLString *string, unsigned int start, unsigned int end, struct LLString **out_string) {
     struct LLString *out;
@@ -95,5 +95,5 @@ int LLStringSlice(struct LLString *string, unsigned int start, unsigned int end,
     }
     *s = 0;
     *out_string = out;
-    return R_OK;
+    return R_Success;
 }
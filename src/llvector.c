@@ -21,7 +21,7 @@ int LLVectorMake(struct LLVector *vector, unsigned int capacity) {
     for (i = 0; i < capacity; ++i) {
         vector->Values[i] = &g_TheNilValue;
     }
-    return R_OK;
+    return R_Success;
 }
 int LLVectorFree(struct LLVector *vector) {
     if (!vector) {
@@ -31,7 +31,7 @@ int LLVectorFree(struct LLVector *vector) {
     vector->Length = 0;
     vector->Capacity = 0;
     free(vector->Values);
-    return R_OK;
+    return R_Success;
 }
 int LLVectorResize(struct LLVector *vector, unsigned int newSize) {
     struct Value **newValues;
@@ -41,17 +41,21 @@ int LLVectorResize(struct LLVector *vector, unsigned int newSize) {
     }
     if (newSize < vector->Capacity && newSize > vector->Length) {
         vector->Capacity = newSize;
-        return R_OK;
+        return R_Success;
     }
     newValues = calloc(sizeof *vector->Values, newSize);
+    if (!newValues) {
+        return R_AllocFailed;
+    }
     limit = min(vector->Length, newSize);
     for (i = 0; i < limit; ++i) {
         newValues[i] = vector->Values[i];
     }
+    free(vector->Values);
     vector->Length = limit;
     vector->Capacity = newSize;
     vector->Values = newValues;
-    return R_OK;
+    return R_Success;
 }
 int LLVectorAppendValue(struct LLVector *vector, struct Value *value) {
     if (!vector) {
@@ -64,7 +68,7 @@ int LLVectorAppendValue(struct LLVector *vector, struct Value *value) {
         vector->Length++;
     }
     vector->Values[vector->Index++] = value;
-    return R_OK;
+    return R_Success;
 }
 int LLVectorSlice(struct LLVector *vector, unsigned int s, unsigned int e, struct LLVector **out_vector) {
     struct LLVector *slice;
@@ -88,5 +92,5 @@ int LLVectorSlice(struct LLVector *vector, unsigned int s, unsigned int e, struc
         s++;
     }
     *out_vector = slice;
-    return R_OK;
+    return R_Success;
 }
@@ -0,0 +1,678 @@
+#include "module_cache.h"
+#include "ast.h"
+#include "globals.h"
+#include "optimizer.h"
+#include "result.h"
+#include "value.h"
+
+#include "helpers/io.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* Bump whenever the trees the parser makes change. */
+#define MODULE_CACHE_VERSION 4U
+#define MODULE_CACHE_NULL_NODE 0xffffffffU
+#define MODULE_CACHE_INITIAL_STRINGS 64U
+
+struct ModuleCacheHeader {
+    char Magic[4];
+    unsigned int Version;
+    long long MtimeSec;
+    long long MtimeNsec;
+    unsigned long long Size;
+    unsigned long long Hash;
+    unsigned int NumStrings;
+    unsigned int StringsLength;
+    unsigned int NodesLength;
+    unsigned int Unused;
+    /* Hash of everything after the header. */
+    unsigned long long Checksum;
+};
+
+struct ModuleCacheBuffer {
+    char *Data;
+    unsigned int Length;
+    unsigned int Capacity;
+};
+
+struct ModuleCacheWriter {
+    struct ModuleCacheBuffer Strings;
+    struct ModuleCacheBuffer Nodes;
+    /* Open addressing table of the strings written so far. */
+    const char **Keys;
+    unsigned int *Indices;
+    unsigned int NumStrings;
+    unsigned int Capacity;
+};
+
+struct ModuleCacheReader {
+    const char *Pos;
+    const char *End;
+    char **Strings;
+    unsigned int NumStrings;
+    char *Filename;
+    /* Literals come back shared the way OptimizeTrees left them. */
+    struct ConstantPool Pool;
+    int Failed;
+};
+
+/* What the parser promises about each kind of node. A cache is only as
+   trustworthy as the disk it sits on, the interpreter follows children
+   without checking them so every node read back is held to this. */
+#define MODULE_CACHE_ANY_ARITY 0xffU
+
+struct ModuleCacheShape {
+    unsigned char Arity;
+    /* Bit i is set if child i may be missing. */
+    unsigned char Optional;
+    /* Bit i is set if child i is a symbol, or a list of them. */
+    unsigned char Symbols;
+    /* Bit i is set if child i is a list rather than a node. */
+    unsigned char Lists;
+};
+
+#define MODULE_CACHE_LIST(type) (UNASSIGNED == (type) || Body == (type))
+
+static const struct ModuleCacheShape ModuleCacheShapes[IfElseExpr + 1] = {
+    [UNASSIGNED]       = {MODULE_CACHE_ANY_ARITY, 0, 0, 0},
+    [Body]             = {MODULE_CACHE_ANY_ARITY, 0, 0, 0},
+    [BAddExpr]         = {2, 0, 0, 0},
+    [BSubExpr]         = {2, 0, 0, 0},
+    [BMulExpr]         = {2, 0, 0, 0},
+    [BDivExpr]         = {2, 0, 0, 0},
+    [BModExpr]         = {2, 0, 0, 0},
+    [BPowExpr]         = {2, 0, 0, 0},
+    [BLShift]          = {2, 0, 0, 0},
+    [BRShift]          = {2, 0, 0, 0},
+    [BArithOrExpr]     = {2, 0, 0, 0},
+    [BArithAndExpr]    = {2, 0, 0, 0},
+    [BArithXorExpr]    = {2, 0, 0, 0},
+    [BLogicOrExpr]     = {2, 0, 0, 0},
+    [BLogicAndExpr]    = {2, 0, 0, 0},
+    [BLogicEqExpr]     = {2, 0, 0, 0},
+    [BLogicNotEqExpr]  = {2, 0, 0, 0},
+    [BLogicLtExpr]     = {2, 0, 0, 0},
+    [BLogicLtEqExpr]   = {2, 0, 0, 0},
+    [BLogicGtExpr]     = {2, 0, 0, 0},
+    [BLogicGtEqExpr]   = {2, 0, 0, 0},
+    [UNegExpr]         = {1, 0, 0, 0},
+    [ULogicNotExpr]    = {1, 0, 0, 0},
+    [AssignExpr]       = {2, 0, 0, 0},
+    [NilNode]          = {0, 0, 0, 0},
+    [BooleanNode]      = {0, 0, 0, 0},
+    [RealNode]         = {0, 0, 0, 0},
+    [IntegerNode]      = {0, 0, 0, 0},
+    [StringNode]       = {0, 0, 0, 0},
+    [SymbolNode]       = {0, 0, 0, 0},
+    [FunctionNode]     = {0, 0, 0, 0},
+    [ClassNode]        = {2, 0, 1, 2},
+    [CallExpr]         = {2, 0, 0, 2},
+    [ArrayIdxExpr]     = {2, 0, 0, 0},
+    [MemberAccessExpr] = {2, 0, 2, 0},
+    [ReturnExpr]       = {1, 1, 0, 0},
+    [ContinueExpr]     = {0, 0, 0, 0},
+    [BreakExpr]        = {0, 0, 0, 0},
+    [YieldExpr]        = {1, 1, 0, 0},
+    [MutExpr]          = {2, 2, 1, 3},
+    [ConstExpr]        = {2, 0, 1, 0},
+    [ImportExpr]       = {2, 0, 2, 0},
+    [ForExpr]          = {4, 0, 0, 4},
+    [ForInExpr]        = {3, 0, 1, 4},
+    [WhileExpr]        = {2, 0, 0, 2},
+    [IfElseExpr]       = {3, 4, 0, 2},
+};
+
+/* FNV-1a, continued from hash. */
+static unsigned long long ModuleCacheHashMore(unsigned long long hash, const char *data, unsigned int length) {
+    unsigned int i;
+    for (i = 0; i < length; ++i) {
+        hash ^= (unsigned char)data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static unsigned long long ModuleCacheHash(const char *data, unsigned int length) {
+    return ModuleCacheHashMore(14695981039346656037ULL, data, length);
+}
+
+static char *ModuleCachePath(const char *path) {
+    size_t len = strlen(path);
+    char *cachePath = malloc(len + sizeof ".llc");
+    strcpy(cachePath, path);
+    if (len > 3 && 0 == strcmp(path + len - 3, ".ll")) {
+        strcat(cachePath, "c");
+    }
+    else {
+        strcat(cachePath, ".llc");
+    }
+    return cachePath;
+}
+
+static void ModuleCacheStamp(struct ModuleCacheHeader *header, struct stat *st, unsigned int length) {
+    memset(header, 0, sizeof *header);
+    memcpy(header->Magic, "LLC", sizeof header->Magic);
+    header->Version = MODULE_CACHE_VERSION;
+    header->MtimeSec = st->st_mtim.tv_sec;
+    header->MtimeNsec = st->st_mtim.tv_nsec;
+    header->Size = length;
+}
+
+/************************ Writing ************************/
+
+static void ModuleCacheBufferWrite(struct ModuleCacheBuffer *buffer, const void *data, unsigned int length) {
+    if (buffer->Length + length > buffer->Capacity) {
+        do {
+            buffer->Capacity = buffer->Capacity ? 2 * buffer->Capacity : 4096;
+        } while (buffer->Length + length > buffer->Capacity);
+        buffer->Data = realloc(buffer->Data, buffer->Capacity);
+    }
+    memcpy(buffer->Data + buffer->Length, data, length);
+    buffer->Length += length;
+}
+
+static void ModuleCacheBufferWriteU32(struct ModuleCacheBuffer *buffer, unsigned int u) {
+    ModuleCacheBufferWrite(buffer, &u, sizeof u);
+}
+
+static void ModuleCacheWriterGrow(struct ModuleCacheWriter *writer) {
+    const char **keys = writer->Keys;
+    unsigned int *indices = writer->Indices;
+    unsigned int i, j, capacity = writer->Capacity;
+    writer->Capacity = capacity ? 2 * capacity : MODULE_CACHE_INITIAL_STRINGS;
+    writer->Keys = calloc(sizeof *writer->Keys, writer->Capacity);
+    writer->Indices = malloc(sizeof *writer->Indices * writer->Capacity);
+    for (i = 0; i < capacity; ++i) {
+        if (!keys[i]) {
+            continue;
+        }
+        j = ModuleCacheHash(keys[i], strlen(keys[i])) & (writer->Capacity - 1);
+        while (writer->Keys[j]) {
+            j = (j + 1) & (writer->Capacity - 1);
+        }
+        writer->Keys[j] = keys[i];
+        writer->Indices[j] = indices[i];
+    }
+    free(keys);
+    free(indices);
+}
+
+/* Each distinct string is written once, nodes refer to it by index. */
+static unsigned int ModuleCacheIntern(struct ModuleCacheWriter *writer, const char *str) {
+    unsigned int i, len = strlen(str);
+    if (2 * (writer->NumStrings + 1) > writer->Capacity) {
+        ModuleCacheWriterGrow(writer);
+    }
+    i = ModuleCacheHash(str, len) & (writer->Capacity - 1);
+    while (writer->Keys[i]) {
+        if (0 == strcmp(writer->Keys[i], str)) {
+            return writer->Indices[i];
+        }
+        i = (i + 1) & (writer->Capacity - 1);
+    }
+    writer->Keys[i] = str;
+    writer->Indices[i] = writer->NumStrings;
+    ModuleCacheBufferWriteU32(&writer->Strings, len);
+    ModuleCacheBufferWrite(&writer->Strings, str, len + 1);
+    return writer->NumStrings++;
+}
+
+/* <type> <line> <column> <num-children> <payload> <children> */
+static void ModuleCacheWriteNode(struct ModuleCacheWriter *writer, struct Ast *ast) {
+    struct ModuleCacheBuffer *out = &writer->Nodes;
+    struct Function *fn;
+    unsigned int i;
+    if (!ast) {
+        ModuleCacheBufferWriteU32(out, MODULE_CACHE_NULL_NODE);
+        return;
+    }
+    ModuleCacheBufferWriteU32(out, ast->Type);
+    ModuleCacheBufferWriteU32(out, ast->SrcLoc.LineNumber);
+    ModuleCacheBufferWriteU32(out, ast->SrcLoc.ColumnNumber);
+    ModuleCacheBufferWriteU32(out, ast->NumChildren);
+    switch (ast->Type) {
+        default:
+            break;
+        case SymbolNode:
+            ModuleCacheBufferWriteU32(out, ModuleCacheIntern(writer, ast->u.SymbolName));
+            break;
+        case IntegerNode:
+            ModuleCacheBufferWriteU32(out, ast->u.Value->v.Integer);
+            break;
+        case RealNode:
+            ModuleCacheBufferWrite(out, &ast->u.Value->v.Real, sizeof ast->u.Value->v.Real);
+            break;
+        case StringNode:
+            ModuleCacheBufferWriteU32(out, ModuleCacheIntern(writer, ast->u.Value->v.String->CString));
+            break;
+        case BooleanNode:
+            ModuleCacheBufferWriteU32(out, &g_TheTrueValue == ast->u.Value);
+            break;
+        case IfElseExpr:
+        case WhileExpr:
+        case ForExpr:
+            ModuleCacheBufferWriteU32(out, ast->NoScope);
+            break;
+        case FunctionNode:
+            fn = ast->u.Value->v.Function;
+            ModuleCacheBufferWriteU32(out, ModuleCacheIntern(writer, fn->Name));
+            ModuleCacheBufferWriteU32(out, fn->NumArgs);
+            ModuleCacheBufferWriteU32(out, fn->IsVarArgs);
+            ModuleCacheBufferWriteU32(out, fn->IsGenerator);
+            ModuleCacheWriteNode(writer, fn->Params);
+            ModuleCacheWriteNode(writer, fn->Body);
+            break;
+    }
+    for (i = 0; i < ast->NumChildren; ++i) {
+        ModuleCacheWriteNode(writer, ast->Children[i]);
+    }
+}
+
+static void ModuleCacheWriterFree(struct ModuleCacheWriter *writer) {
+    free(writer->Strings.Data);
+    free(writer->Nodes.Data);
+    free(writer->Keys);
+    free(writer->Indices);
+}
+
+/************************ Reading ************************/
+
+static void ModuleCacheRead(struct ModuleCacheReader *reader, void *out, unsigned int length) {
+    if ((size_t)(reader->End - reader->Pos) < length) {
+        reader->Failed = 1;
+        memset(out, 0, length);
+        return;
+    }
+    memcpy(out, reader->Pos, length);
+    reader->Pos += length;
+}
+
+static unsigned int ModuleCacheReadU32(struct ModuleCacheReader *reader) {
+    unsigned int u;
+    ModuleCacheRead(reader, &u, sizeof u);
+    return u;
+}
+
+static char *ModuleCacheReadString(struct ModuleCacheReader *reader) {
+    unsigned int i = ModuleCacheReadU32(reader);
+    if (i >= reader->NumStrings) {
+        reader->Failed = 1;
+        return NULL;
+    }
+    return reader->Strings[i];
+}
+
+static int ModuleCacheIsSymbols(struct Ast *ast) {
+    unsigned int i;
+    if (!MODULE_CACHE_LIST(ast->Type)) {
+        return SymbolNode == ast->Type;
+    }
+    for (i = 0; i < ast->NumChildren; ++i) {
+        if (SymbolNode != ast->Children[i]->Type) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* Holds ast to the shape of its type, its children have been checked
+   already. */
+static int ModuleCacheIsWellFormed(struct Ast *ast) {
+    const struct ModuleCacheShape *shape = &ModuleCacheShapes[ast->Type];
+    struct Function *fn;
+    struct Ast *child;
+    unsigned int i, bit;
+    if (MODULE_CACHE_ANY_ARITY != shape->Arity && ast->NumChildren != shape->Arity) {
+        return 0;
+    }
+    for (i = 0; i < ast->NumChildren; ++i) {
+        child = ast->Children[i];
+        bit = MODULE_CACHE_ANY_ARITY == shape->Arity ? 0 : 1U << i;
+        if (!child) {
+            if (!(shape->Optional & bit)) {
+                return 0;
+            }
+            continue;
+        }
+        if ((shape->Lists & bit) && !MODULE_CACHE_LIST(child->Type)) {
+            return 0;
+        }
+        if ((shape->Symbols & bit) && !ModuleCacheIsSymbols(child)) {
+            return 0;
+        }
+    }
+    if (ImportExpr == ast->Type && StringNode != ast->Children[0]->Type) {
+        return 0;
+    }
+    if (FunctionNode == ast->Type) {
+        fn = ast->u.Value->v.Function;
+        if (fn->Params && (!MODULE_CACHE_LIST(fn->Params->Type) || !ModuleCacheIsSymbols(fn->Params))) {
+            return 0;
+        }
+        if ((fn->Params ? fn->Params->NumChildren : 0) != fn->NumArgs || !fn->Body || Body != fn->Body->Type) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* Every child of list must be of the given type. */
+static int ModuleCacheIsListOf(struct Ast *list, enum AstNodeType type) {
+    unsigned int i;
+    if (!list || !MODULE_CACHE_LIST(list->Type)) {
+        return 0;
+    }
+    for (i = 0; i < list->NumChildren; ++i) {
+        if (type != list->Children[i]->Type) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* Frees the string and function values of a tree that is being dropped,
+   the nodes are the arena's and the numbers the pool's. */
+static void ModuleCacheFreeValues(struct Ast *ast) {
+    struct Function *fn;
+    unsigned int i;
+    if (!ast) {
+        return;
+    }
+    for (i = 0; i < ast->NumChildren; ++i) {
+        ModuleCacheFreeValues(ast->Children[i]);
+    }
+    if (StringNode == ast->Type && ast->u.Value) {
+        ValueFree(ast->u.Value);
+        free(ast->u.Value->v.String);
+        free(ast->u.Value);
+    }
+    else if (FunctionNode == ast->Type && ast->u.Value) {
+        fn = ast->u.Value->v.Function;
+        ModuleCacheFreeValues(fn->Params);
+        ModuleCacheFreeValues(fn->Body);
+        /* FunctionMake's stand in for no params. */
+        if (!fn->Params->InArena) {
+            free(fn->Params);
+        }
+        ValueFree(ast->u.Value);
+        free(fn);
+        free(ast->u.Value);
+    }
+}
+
+static int ModuleCacheReadNode(struct ModuleCacheReader *reader, struct Ast **out_ast) {
+    struct Ast *ast, *params, *body;
+    struct Function *fn;
+    struct Value *function;
+    struct SrcLoc srcLoc;
+    unsigned int type, numChildren, numArgs, i;
+    int isVarArgs, isGenerator;
+    double real;
+    char *str;
+    type = ModuleCacheReadU32(reader);
+    if (MODULE_CACHE_NULL_NODE == type) {
+        *out_ast = NULL;
+        return reader->Failed ? R_OperationFailed : R_Success;
+    }
+    srcLoc.Filename = reader->Filename;
+    srcLoc.LineNumber = ModuleCacheReadU32(reader);
+    srcLoc.ColumnNumber = ModuleCacheReadU32(reader);
+    numChildren = ModuleCacheReadU32(reader);
+    /* Every child takes at least a word, which bounds a corrupt count. */
+    if (reader->Failed || type > IfElseExpr || numChildren > (size_t)(reader->End - reader->Pos) / sizeof numChildren) {
+        return R_OperationFailed;
+    }
+    AstMakeNode(&ast, type, numChildren, srcLoc);
+    /* Until they are read, so a failure frees only what was. */
+    ast->NumChildren = 0;
+    switch (type) {
+        default:
+            break;
+        case SymbolNode:
+            ast->u.SymbolName = ModuleCacheReadString(reader);
+            break;
+        case IntegerNode:
+            ast->u.Value = ConstantPoolInteger(&reader->Pool, (int)ModuleCacheReadU32(reader));
+            break;
+        case RealNode:
+            ModuleCacheRead(reader, &real, sizeof real);
+            ast->u.Value = ConstantPoolReal(&reader->Pool, real);
+            break;
+        case StringNode:
+            str = ModuleCacheReadString(reader);
+            if (str) {
+                ValueMakeLLStringLiteralWithCString(&ast->u.Value, str);
+            }
+            break;
+        case BooleanNode:
+            ast->u.Value = ModuleCacheReadU32(reader) ? &g_TheTrueValue : &g_TheFalseValue;
+            break;
+        case NilNode:
+            ast->u.Value = &g_TheNilValue;
+            break;
+        case IfElseExpr:
+        case WhileExpr:
+        case ForExpr:
+            ast->NoScope = ModuleCacheReadU32(reader);
+            break;
+        case FunctionNode:
+            str = ModuleCacheReadString(reader);
+            numArgs = ModuleCacheReadU32(reader);
+            isVarArgs = ModuleCacheReadU32(reader);
+            isGenerator = ModuleCacheReadU32(reader);
+            if (reader->Failed || R_Success != ModuleCacheReadNode(reader, &params)) {
+                return R_OperationFailed;
+            }
+            if (R_Success != ModuleCacheReadNode(reader, &body)) {
+                ModuleCacheFreeValues(params);
+                return R_OperationFailed;
+            }
+            FunctionMake(&fn, str, numArgs, isVarArgs, params, body);
+            fn->IsGenerator = isGenerator;
+            function = malloc(sizeof *function);
+            ValueMakeFunction(function, fn);
+            ast->u.Value = function;
+            break;
+    }
+    if (reader->Failed) {
+        ModuleCacheFreeValues(ast);
+        return R_OperationFailed;
+    }
+    for (i = 0; i < numChildren; ++i) {
+        if (R_Success != ModuleCacheReadNode(reader, &ast->Children[i])) {
+            ModuleCacheFreeValues(ast);
+            return R_OperationFailed;
+        }
+        ++ast->NumChildren;
+    }
+    if (!ModuleCacheIsWellFormed(ast)) {
+        ModuleCacheFreeValues(ast);
+        return R_OperationFailed;
+    }
+    *out_ast = ast;
+    return R_Success;
+}
+
+/* The string table is a run of <length> <bytes> <nul>. */
+static int ModuleCacheReadStrings(struct ModuleCacheReader *reader, struct AstArena *arena, const char *strings, unsigned int length) {
+    const char *pos = strings, *end = strings + length;
+    unsigned int i, len;
+    for (i = 0; i < reader->NumStrings; ++i) {
+        if ((size_t)(end - pos) < sizeof len) {
+            return R_OperationFailed;
+        }
+        memcpy(&len, pos, sizeof len);
+        pos += sizeof len;
+        if ((size_t)(end - pos) <= len || 0 != pos[len]) {
+            return R_OperationFailed;
+        }
+        reader->Strings[i] = AstArenaStrdup(arena, pos);
+        pos += len + 1;
+    }
+    return pos == end ? R_Success : R_OperationFailed;
+}
+
+/*********************** Public Functions ***********************/
+
+int ModuleCacheLoad(struct ParsedTrees *trees, char *path, const char *source, unsigned int length) {
+    struct ModuleCacheHeader header, expected;
+    struct ModuleCacheReader reader;
+    struct MappedFile cache;
+    struct AstArena *previousArena;
+    struct stat st;
+    const char *nodes;
+    char *cachePath;
+    int result = R_FileNotFound;
+    if (!trees || !path || !source) {
+        return R_InvalidArgument;
+    }
+    if (0 != stat(path, &st)) {
+        return R_FileNotFound;
+    }
+    cachePath = ModuleCachePath(path);
+    if (0 != MappedFileOpen(&cache, cachePath)) {
+        free(cachePath);
+        return R_FileNotFound;
+    }
+    free(cachePath);
+    if (cache.Length < sizeof header) {
+        goto cleanup;
+    }
+    memcpy(&header, cache.Data, sizeof header);
+    ModuleCacheStamp(&expected, &st, length);
+    /* Only hash the source once everything cheaper has matched. */
+    if (0 != memcmp(header.Magic, expected.Magic, sizeof header.Magic) ||
+        header.Version != expected.Version ||
+        header.MtimeSec != expected.MtimeSec ||
+        header.MtimeNsec != expected.MtimeNsec ||
+        header.Size != expected.Size ||
+        (unsigned long long)header.StringsLength + header.NodesLength != cache.Length - sizeof header ||
+        header.NumStrings > header.StringsLength ||
+        header.Hash != ModuleCacheHash(source, length) ||
+        header.Checksum != ModuleCacheHash(cache.Data + sizeof header, cache.Length - sizeof header)) {
+        goto cleanup;
+    }
+
+    AstArenaMake(&trees->Arena);
+    reader.NumStrings = header.NumStrings;
+    reader.Strings = malloc(sizeof *reader.Strings * (header.NumStrings + 1));
+    if (R_Success != ModuleCacheReadStrings(&reader, &trees->Arena, cache.Data + sizeof header, header.StringsLength)) {
+        free(reader.Strings);
+        AstArenaFree(&trees->Arena);
+        goto cleanup;
+    }
+    nodes = cache.Data + sizeof header + header.StringsLength;
+    reader.Pos = nodes;
+    reader.End = nodes + header.NodesLength;
+    reader.Filename = AstArenaStrdup(&trees->Arena, path);
+    reader.Failed = 0;
+    ConstantPoolMake(&reader.Pool);
+
+    trees->Imports = trees->Classes = trees->TopLevelFunctions = trees->Program = NULL;
+    previousArena = AstArenaUse(&trees->Arena);
+    if (R_Success == ModuleCacheReadNode(&reader, &trees->Imports) &&
+        R_Success == ModuleCacheReadNode(&reader, &trees->Classes) &&
+        R_Success == ModuleCacheReadNode(&reader, &trees->TopLevelFunctions) &&
+        R_Success == ModuleCacheReadNode(&reader, &trees->Program) &&
+        reader.Pos == reader.End &&
+        ModuleCacheIsListOf(trees->Imports, ImportExpr) &&
+        ModuleCacheIsListOf(trees->Classes, ClassNode) &&
+        ModuleCacheIsListOf(trees->TopLevelFunctions, FunctionNode) &&
+        trees->Program && MODULE_CACHE_LIST(trees->Program->Type)) {
+        result = R_Success;
+    }
+    AstArenaUse(previousArena);
+    free(reader.Strings);
+    if (R_Success == result) {
+        ConstantPoolFree(&reader.Pool);
+    }
+    else {
+        ModuleCacheFreeValues(trees->Imports);
+        ModuleCacheFreeValues(trees->Classes);
+        ModuleCacheFreeValues(trees->TopLevelFunctions);
+        ModuleCacheFreeValues(trees->Program);
+        ConstantPoolFreeValues(&reader.Pool);
+        AstArenaFree(&trees->Arena);
+        memset(trees, 0, sizeof *trees);
+        result = R_FileNotFound;
+    }
+
+cleanup:
+    MappedFileClose(&cache);
+    return result;
+}
+
+static pthread_once_t ModuleCacheUmaskOnce = PTHREAD_ONCE_INIT;
+static mode_t ModuleCacheUmask;
+
+/* umask can only be read by setting it, once so other threads creating
+   files see it changed for as short as possible. */
+static void ModuleCacheReadUmask(void) {
+    ModuleCacheUmask = umask(0);
+    umask(ModuleCacheUmask);
+}
+
+int ModuleCacheStore(struct ParsedTrees *trees, char *path, const char *source, unsigned int length) {
+    struct ModuleCacheWriter writer;
+    struct ModuleCacheHeader header;
+    struct stat st;
+    char *cachePath, *tmpPath;
+    FILE *file;
+    int fd, ok;
+    if (!trees || !path || !source) {
+        return R_InvalidArgument;
+    }
+    if (0 != stat(path, &st)) {
+        return R_FileNotFound;
+    }
+    memset(&writer, 0, sizeof writer);
+    ModuleCacheWriteNode(&writer, trees->Imports);
+    ModuleCacheWriteNode(&writer, trees->Classes);
+    ModuleCacheWriteNode(&writer, trees->TopLevelFunctions);
+    ModuleCacheWriteNode(&writer, trees->Program);
+
+    ModuleCacheStamp(&header, &st, length);
+    header.Hash = ModuleCacheHash(source, length);
+    header.NumStrings = writer.NumStrings;
+    header.StringsLength = writer.Strings.Length;
+    header.NodesLength = writer.Nodes.Length;
+    header.Checksum = ModuleCacheHash(writer.Strings.Data, writer.Strings.Length);
+    header.Checksum = ModuleCacheHashMore(header.Checksum, writer.Nodes.Data, writer.Nodes.Length);
+
+    /* Written aside and renamed into place so a reader never sees half a
+       cache. */
+    cachePath = ModuleCachePath(path);
+    tmpPath = malloc(strlen(cachePath) + sizeof ".XXXXXX");
+    sprintf(tmpPath, "%s.XXXXXX", cachePath);
+    fd = mkstemp(tmpPath);
+    /* mkstemp makes it 0600, a cache is as readable as any other file. */
+    pthread_once(&ModuleCacheUmaskOnce, ModuleCacheReadUmask);
+    if (fd >= 0 && 0 != fchmod(fd, 0666 & ~ModuleCacheUmask)) {
+        close(fd);
+        fd = -1;
+        remove(tmpPath);
+    }
+    file = fd < 0 ? NULL : fdopen(fd, "wb");
+    ok = NULL != file &&
+        1 == fwrite(&header, sizeof header, 1, file) &&
+        writer.Strings.Length == fwrite(writer.Strings.Data, 1, writer.Strings.Length, file) &&
+        writer.Nodes.Length == fwrite(writer.Nodes.Data, 1, writer.Nodes.Length, file);
+    if (file && 0 != fclose(file)) {
+        ok = 0;
+    }
+    if (ok) {
+        ok = 0 == rename(tmpPath, cachePath);
+    }
+    if (fd >= 0 && !ok) {
+        remove(tmpPath);
+    }
+    free(tmpPath);
+    free(cachePath);
+    ModuleCacheWriterFree(&writer);
+    return ok ? R_Success : R_OperationFailed;
+}
@@ -14,7 +14,7 @@ int ModuleTableNodeMake(struct ModuleTableNode *moduleTableNode, char *key, stru
     moduleTableNode->Key = strdup(key);
     moduleTableNode->Module = module;
     moduleTableNode->Next = NULL;
-    return R_OK;
+    return R_Success;
 }
 int ModuleTableNodeFree(struct ModuleTableNode *moduleTableNode) {
     struct ModuleTableNode *next;
@@ -33,7 +33,7 @@ int ModuleTableNodeFree(struct ModuleTableNode *moduleTableNode) {
         moduleTableNode = next;
     }
     
-    return R_OK;
+    return R_Success;
 }
 
 /******************** Public Functions *********************/
@@ -45,7 +45,7 @@ int ModuleMake(struct Module *module, struct Ast *program, struct ModuleTable *i
     }
     module->ModuleScope = calloc(sizeof *(module->ModuleScope), 1);
     result = SymbolTableMakeGlobalScope(module->ModuleScope);
-    if (R_OK != result) {
+    if (R_Success != result) {
         free(module->ModuleScope);
         return result;
     }
@@ -53,12 +53,15 @@ int ModuleMake(struct Module *module, struct Ast *program, struct ModuleTable *i
 
     module->TypeTable = calloc(sizeof *(module->TypeTable), 1);
     result = TypeTableMake(module->TypeTable, 0);
-    if (R_OK != result) {
+    if (R_Success != result) {
         free(module->TypeTable);
         return result;
     }
     module->Program = program;
     module->Imports = imports;
+    module->NeedsInit = 0;
+    module->ImportsInitialized = 0;
+    AstArenaMake(&module->Arena);
     return result;
 }
 int ModuleFree(struct Module *module) {
@@ -67,7 +70,9 @@ int ModuleFree(struct Module *module) {
     }
 
     AstFree(module->Program);
-    free(module->Program);
+    if (module->Program && !module->Program->InArena) {
+        free(module->Program);
+    }
 
     SymbolTableFree(module->ModuleScope);
     free(module->ModuleScope);
@@ -78,12 +83,14 @@ int ModuleFree(struct Module *module) {
     ModuleTableFree(module->Imports);
     free(module->Imports);
 
+    AstArenaFree(&module->Arena);
+
     module->ModuleScope = NULL;
     module->CurrentScope = NULL;
     module->TypeTable = NULL;
     module->Program = NULL;
     module->Imports = NULL;
-    return R_OK;
+    return R_Success;
 }
 
 int ModuleTableMake(struct ModuleTable *moduleTable) {
@@ -92,7 +99,7 @@ int ModuleTableMake(struct ModuleTable *moduleTable) {
     }
     moduleTable->NumNodes = MODULE_TABLE_DEFAULT_LENGTH;
     moduleTable->Nodes = calloc(sizeof *(moduleTable->Nodes), MODULE_TABLE_DEFAULT_LENGTH);
-    return R_OK;
+    return R_Success;
 }
 int ModuleTableFree(struct ModuleTable *moduleTable) {
     unsigned int i;
@@ -106,7 +113,7 @@ int ModuleTableFree(struct ModuleTable *moduleTable) {
         }
     }
     free(moduleTable->Nodes);
-    return R_OK;
+    return R_Success;
 }
 int ModuleTableInsert(struct ModuleTable *moduleTable, char *key, struct Module *module) {
     unsigned int idx;
@@ -119,7 +126,7 @@ int ModuleTableInsert(struct ModuleTable *moduleTable, char *key, struct Module
         node = malloc(sizeof *node);
         ModuleTableNodeMake(node, key, module);
         moduleTable->Nodes[idx] = node;
-        return R_OK;
+        return R_Success;
     }
     /* Check if the module already exists in the chain */
     prev = tmp = moduleTable->Nodes[idx];
@@ -133,7 +140,7 @@ int ModuleTableInsert(struct ModuleTable *moduleTable, char *key, struct Module
     node = malloc(sizeof *node);
     ModuleTableNodeMake(node, key, module);
     prev->Next = node;
-    return R_OK;
+    return R_Success;
 }
 int ModuleTableFind(struct ModuleTable *moduleTable, char *key, struct Module **out_module) {
     unsigned int idx;
@@ -0,0 +1,395 @@
+#include "optimizer.h"
+#include "globals.h"
+#include "result.h"
+
+#include "runtime/real.h"
+
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CONSTANT_POOL_INITIAL_CAPACITY 64U
+#define INT_BITS ((int)(sizeof(int) * CHAR_BIT))
+
+#define IS_INTEGER(x) ((x)->TypeInfo == &g_TheIntegerTypeInfo)
+#define IS_REAL(x) ((x)->TypeInfo == &g_TheRealTypeInfo)
+#define IS_NUMERIC(x) (IS_INTEGER(x) || IS_REAL(x))
+#define AS_REAL(x) (IS_INTEGER(x) ? (double)(x)->v.Integer : (x)->v.Real)
+#define IS_LITERAL(ast) \
+    (IntegerNode == (ast)->Type || RealNode == (ast)->Type || BooleanNode == (ast)->Type || NilNode == (ast)->Type)
+
+/************************ Constant pool ************************/
+
+static unsigned int ConstantPoolHash(struct Value *value) {
+    unsigned long long bits = 0;
+    if (IS_INTEGER(value)) {
+        bits = (unsigned int)value->v.Integer;
+    }
+    else {
+        memcpy(&bits, &value->v.Real, sizeof bits);
+        bits = ~bits;
+    }
+    bits ^= bits >> 33;
+    bits *= 0xff51afd7ed558ccdULL;
+    bits ^= bits >> 33;
+    return (unsigned int)bits;
+}
+
+/* Reals are told apart by their bits, 0.0 and -0.0 print differently. */
+static int ConstantPoolSame(struct Value *a, struct Value *b) {
+    if (a->TypeInfo != b->TypeInfo) {
+        return 0;
+    }
+    if (IS_INTEGER(a)) {
+        return a->v.Integer == b->v.Integer;
+    }
+    return 0 == memcmp(&a->v.Real, &b->v.Real, sizeof a->v.Real);
+}
+
+static void ConstantPoolGrow(struct ConstantPool *pool) {
+    struct Value **values = pool->Values;
+    unsigned int i, j, capacity = pool->Capacity;
+    pool->Capacity = capacity ? 2 * capacity : CONSTANT_POOL_INITIAL_CAPACITY;
+    pool->Values = calloc(sizeof *pool->Values, pool->Capacity);
+    for (i = 0; i < capacity; ++i) {
+        if (!values[i]) {
+            continue;
+        }
+        j = ConstantPoolHash(values[i]) & (pool->Capacity - 1);
+        while (pool->Values[j]) {
+            j = (j + 1) & (pool->Capacity - 1);
+        }
+        pool->Values[j] = values[i];
+    }
+    free(values);
+}
+
+static struct Value *ConstantPoolIntern(struct ConstantPool *pool, struct Value *key) {
+    struct Value *value;
+    unsigned int i;
+    if (2 * (pool->NumValues + 1) > pool->Capacity) {
+        ConstantPoolGrow(pool);
+    }
+    i = ConstantPoolHash(key) & (pool->Capacity - 1);
+    while (pool->Values[i]) {
+        if (ConstantPoolSame(pool->Values[i], key)) {
+            return pool->Values[i];
+        }
+        i = (i + 1) & (pool->Capacity - 1);
+    }
+    if (IS_INTEGER(key)) {
+        ValueMakeIntegerLiteral(&value, key->v.Integer);
+    }
+    else {
+        ValueMakeRealLiteral(&value, key->v.Real);
+    }
+    pool->Values[i] = value;
+    ++pool->NumValues;
+    return value;
+}
+
+/************************ Folding ************************/
+
+static struct Value *FoldBoolean(int b) {
+    return b ? &g_TheTrueValue : &g_TheFalseValue;
+}
+
+/* Integer.__eq__ and Real.__eq__, -1 for anything else. */
+static int FoldEq(struct Value *lhs, struct Value *rhs) {
+    if (IS_INTEGER(lhs)) {
+        return IS_INTEGER(rhs) && lhs->v.Integer == rhs->v.Integer;
+    }
+    if (IS_REAL(lhs)) {
+        if (IS_INTEGER(rhs)) {
+            return 0.0 == lhs->v.Real - rhs->v.Integer;
+        }
+        return IS_REAL(rhs) && fabs(lhs->v.Real - rhs->v.Real) <= REAL_EPSILON;
+    }
+    if (&g_TheTrueValue == lhs || &g_TheFalseValue == lhs) {
+        return lhs == rhs;
+    }
+    return -1;
+}
+
+/* Integer.__lt__ and Real.__lt__, or __gt__ when gt is set. */
+static int FoldLtOrGt(struct Value *lhs, struct Value *rhs, int gt) {
+    double diff;
+    if (!IS_NUMERIC(lhs)) {
+        return -1;
+    }
+    if (!IS_NUMERIC(rhs)) {
+        return 0;
+    }
+    if (IS_INTEGER(lhs)) {
+        if (IS_INTEGER(rhs)) {
+            return gt ? lhs->v.Integer > rhs->v.Integer : lhs->v.Integer < rhs->v.Integer;
+        }
+        return gt ? lhs->v.Integer > rhs->v.Real : lhs->v.Integer < rhs->v.Real;
+    }
+    diff = lhs->v.Real - AS_REAL(rhs);
+    return gt ? diff > 0 : diff < 0;
+}
+
+static struct Value *FoldIntegers(struct ConstantPool *pool, enum AstNodeType op, int a, int b) {
+    double p;
+    switch (op) {
+        default:
+            return NULL;
+        /* Wraps around like the runtime's arithmetic does. */
+        case BAddExpr: return ConstantPoolInteger(pool, (int)((unsigned int)a + (unsigned int)b));
+        case BSubExpr: return ConstantPoolInteger(pool, (int)((unsigned int)a - (unsigned int)b));
+        case BMulExpr: return ConstantPoolInteger(pool, (int)((unsigned int)a * (unsigned int)b));
+        case BDivExpr:
+        case BModExpr:
+            if (0 == b || (INT_MIN == a && -1 == b)) {
+                return NULL;
+            }
+            return ConstantPoolInteger(pool, BDivExpr == op ? a / b : a % b);
+        case BPowExpr:
+            p = pow(a, b);
+            if (!(p >= INT_MIN && p <= INT_MAX)) {
+                return NULL;
+            }
+            return ConstantPoolInteger(pool, (int)p);
+        case BLShift:
+        case BRShift:
+            if (b < 0 || b >= INT_BITS) {
+                return NULL;
+            }
+            return ConstantPoolInteger(pool, BLShift == op ? (int)((unsigned int)a << b) : a >> b);
+        case BArithOrExpr: return ConstantPoolInteger(pool, a | b);
+        case BArithAndExpr: return ConstantPoolInteger(pool, a & b);
+        case BArithXorExpr: return ConstantPoolInteger(pool, a ^ b);
+    }
+}
+
+static struct Value *FoldReals(struct ConstantPool *pool, enum AstNodeType op, double x, double y) {
+    switch (op) {
+        default:
+            return NULL;
+        case BAddExpr: return ConstantPoolReal(pool, x + y);
+        case BSubExpr: return ConstantPoolReal(pool, x - y);
+        case BMulExpr: return ConstantPoolReal(pool, x * y);
+        case BDivExpr: return ConstantPoolReal(pool, x / y);
+        case BModExpr: return ConstantPoolReal(pool, fmod(x, y));
+        case BPowExpr: return ConstantPoolReal(pool, pow(x, y));
+    }
+}
+
+static struct Value *FoldBinary(struct ConstantPool *pool, enum AstNodeType op, struct Value *lhs, struct Value *rhs) {
+    int lt, eq;
+    switch (op) {
+        default:
+            break;
+        case BLogicEqExpr:
+        case BLogicNotEqExpr:
+            eq = FoldEq(lhs, rhs);
+            return eq < 0 ? NULL : FoldBoolean(BLogicEqExpr == op ? eq : !eq);
+        case BLogicLtExpr:
+        case BLogicGtExpr:
+            lt = FoldLtOrGt(lhs, rhs, BLogicGtExpr == op);
+            return lt < 0 ? NULL : FoldBoolean(lt);
+        /* Like the interpreter, these ask __lt__ or __gt__ and then __eq__. */
+        case BLogicLtEqExpr:
+        case BLogicGtEqExpr:
+            lt = FoldLtOrGt(lhs, rhs, BLogicGtEqExpr == op);
+            eq = FoldEq(lhs, rhs);
+            return lt < 0 || eq < 0 ? NULL : FoldBoolean(1 == lt || 1 == eq);
+    }
+    if (IS_INTEGER(lhs) && IS_INTEGER(rhs)) {
+        return FoldIntegers(pool, op, lhs->v.Integer, rhs->v.Integer);
+    }
+    if (IS_NUMERIC(lhs) && IS_NUMERIC(rhs)) {
+        return FoldReals(pool, op, AS_REAL(lhs), AS_REAL(rhs));
+    }
+    return NULL;
+}
+
+/* `||' and `&&' only look at their right side when the left one does not
+   decide, so `true || f()' folds even though f() is not a literal. */
+static struct Value *FoldLogic(enum AstNodeType op, struct Ast *lhs, struct Ast *rhs) {
+    struct Value *decides = BLogicOrExpr == op ? &g_TheTrueValue : &g_TheFalseValue;
+    if (!IS_LITERAL(lhs)) {
+        return NULL;
+    }
+    if (decides == lhs->u.Value) {
+        return decides;
+    }
+    if (!IS_LITERAL(rhs)) {
+        return NULL;
+    }
+    if (&g_TheTrueValue == rhs->u.Value || &g_TheFalseValue == rhs->u.Value) {
+        if (BLogicOrExpr == op || rhs->u.Value == &g_TheFalseValue || lhs->u.Value == rhs->u.Value) {
+            return rhs->u.Value;
+        }
+    }
+    return &g_TheNilValue;
+}
+
+static struct Value *FoldUnary(struct ConstantPool *pool, enum AstNodeType op, struct Value *value) {
+    if (UNegExpr == op) {
+        if (IS_INTEGER(value) && INT_MIN != value->v.Integer) {
+            return ConstantPoolInteger(pool, -value->v.Integer);
+        }
+        if (IS_REAL(value)) {
+            return ConstantPoolReal(pool, -value->v.Real);
+        }
+    }
+    else if (&g_TheTrueValue == value || &g_TheFalseValue == value) {
+        return FoldBoolean(&g_TheFalseValue == value);
+    }
+    return NULL;
+}
+
+/* Turns ast into the literal for value in place, its parent keeps
+   pointing at it. */
+static void ReplaceWithLiteral(struct Ast *ast, struct Value *value) {
+    if (IS_INTEGER(value)) {
+        ast->Type = IntegerNode;
+    }
+    else if (IS_REAL(value)) {
+        ast->Type = RealNode;
+    }
+    else if (&g_TheNilValue == value) {
+        ast->Type = NilNode;
+    }
+    else {
+        ast->Type = BooleanNode;
+    }
+    ast->NumChildren = 0;
+    ast->u.Value = value;
+}
+
+/* Returns whether ast declares a symbol in the scope it runs in. */
+static int OptimizeNode(struct ConstantPool *pool, struct Ast *ast) {
+    struct Function *fn;
+    struct Value *literal, *folded = NULL;
+    unsigned int i;
+    int declares = 0;
+    if (!ast) {
+        return 0;
+    }
+    for (i = 0; i < ast->NumChildren; ++i) {
+        declares |= OptimizeNode(pool, ast->Children[i]);
+    }
+    switch (ast->Type) {
+        default:
+            break;
+        case MutExpr:
+        case ConstExpr:
+            declares = 1;
+            break;
+        /* Only what these declare lives in the scope they push, a body
+           without declarations can share the enclosing one. */
+        case IfElseExpr:
+        case WhileExpr:
+        case ForExpr:
+            ast->NoScope = !declares;
+            declares = 0;
+            break;
+        case ForInExpr:
+            declares = 0;
+            break;
+        /* Nothing but the node refers to the literal the parser made. */
+        case IntegerNode:
+            literal = ast->u.Value;
+            ast->u.Value = ConstantPoolInteger(pool, literal->v.Integer);
+            free(literal);
+            break;
+        case RealNode:
+            literal = ast->u.Value;
+            ast->u.Value = ConstantPoolReal(pool, literal->v.Real);
+            free(literal);
+            break;
+        case FunctionNode:
+            fn = ast->u.Value->v.Function;
+            OptimizeNode(pool, fn->Params);
+            OptimizeNode(pool, fn->Body);
+            break;
+        case UNegExpr:
+        case ULogicNotExpr:
+            if (IS_LITERAL(ast->Children[0])) {
+                folded = FoldUnary(pool, ast->Type, ast->Children[0]->u.Value);
+            }
+            break;
+        case BLogicOrExpr:
+        case BLogicAndExpr:
+            folded = FoldLogic(ast->Type, ast->Children[0], ast->Children[1]);
+            break;
+        case BAddExpr: case BSubExpr: case BMulExpr: case BDivExpr:
+        case BModExpr: case BPowExpr: case BLShift: case BRShift:
+        case BArithOrExpr: case BArithAndExpr: case BArithXorExpr:
+        case BLogicEqExpr: case BLogicNotEqExpr: case BLogicLtExpr:
+        case BLogicLtEqExpr: case BLogicGtExpr: case BLogicGtEqExpr:
+            if (IS_LITERAL(ast->Children[0]) && IS_LITERAL(ast->Children[1])) {
+                folded = FoldBinary(pool, ast->Type, ast->Children[0]->u.Value, ast->Children[1]->u.Value);
+            }
+            break;
+    }
+    if (folded) {
+        ReplaceWithLiteral(ast, folded);
+    }
+    return declares;
+}
+
+/*********************** Public Functions ***********************/
+
+int ConstantPoolMake(struct ConstantPool *pool) {
+    if (!pool) {
+        return R_InvalidArgument;
+    }
+    pool->Values = NULL;
+    pool->NumValues = 0;
+    pool->Capacity = 0;
+    return R_Success;
+}
+
+int ConstantPoolFree(struct ConstantPool *pool) {
+    if (!pool) {
+        return R_InvalidArgument;
+    }
+    free(pool->Values);
+    pool->Values = NULL;
+    pool->NumValues = 0;
+    pool->Capacity = 0;
+    return R_Success;
+}
+
+int ConstantPoolFreeValues(struct ConstantPool *pool) {
+    unsigned int i;
+    if (!pool) {
+        return R_InvalidArgument;
+    }
+    for (i = 0; i < pool->Capacity; ++i) {
+        free(pool->Values[i]);
+    }
+    return ConstantPoolFree(pool);
+}
+
+struct Value *ConstantPoolInteger(struct ConstantPool *pool, int integer) {
+    struct Value key;
+    key.TypeInfo = &g_TheIntegerTypeInfo;
+    key.v.Integer = integer;
+    return ConstantPoolIntern(pool, &key);
+}
+
+struct Value *ConstantPoolReal(struct ConstantPool *pool, double real) {
+    struct Value key;
+    key.TypeInfo = &g_TheRealTypeInfo;
+    key.v.Real = real;
+    return ConstantPoolIntern(pool, &key);
+}
+
+int OptimizeTrees(struct ParsedTrees *trees) {
+    struct ConstantPool pool;
+    if (!trees) {
+        return R_InvalidArgument;
+    }
+    ConstantPoolMake(&pool);
+    OptimizeNode(&pool, trees->Classes);
+    OptimizeNode(&pool, trees->TopLevelFunctions);
+    OptimizeNode(&pool, trees->Program);
+    ConstantPoolFree(&pool);
+    return R_Success;
+}
@@ -8,6 +8,7 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 
 const char *tokenStrings[Token_NUM_TOKENS] = {
@@ -35,8 +36,9 @@ const char *tokenStrings[Token_NUM_TOKENS] = {
     [TokenEquals] = "=",
 };
 
-static unsigned int isInsideLoop = 0;
-static unsigned int isInsideFunction = 0;
+static __thread unsigned int isInsideLoop = 0;
+static __thread unsigned int isInsideFunction = 0;
+static __thread unsigned int hasYielded = 0;
 
 #define SAVE(ts, sp) sp = (ts)->Current
 
@@ -44,7 +46,7 @@ static unsigned int isInsideFunction = 0;
 
 #define EXPECT_NO_MSG(typ, ts)                      \
     do {                                            \
-        if ((typ) != (ts)->Current->Token->Type) {  \
+        if ((typ) != TOKEN_STREAM_CURRENT(ts)->Type) {  \
             return R_UnexpectedToken;               \
         }                                           \
         else {                                      \
@@ -54,8 +56,8 @@ static unsigned int isInsideFunction = 0;
 
 #define EXPECT(typ, ts)                                                 \
     do {                                                                \
-        if ((typ) != (ts)->Current->Token->Type) {                      \
-            return ParseErrorUnexpectedTokenExpected(typ, (ts)->Current->Token); \
+        if ((typ) != TOKEN_STREAM_CURRENT(ts)->Type) {                      \
+            return ParseErrorUnexpectedTokenExpected(typ, TOKEN_STREAM_CURRENT(ts)); \
         }                                                               \
         else {                                                          \
             TokenStreamAdvance((ts));                                   \
@@ -64,8 +66,8 @@ static unsigned int isInsideFunction = 0;
 
 #define EXPECT_EITHER(typ1, typ2, ts)                                   \
     do {                                                                \
-        if ((typ1) != (ts)->Current->Token->Type && (typ2) != (ts->Current->Token->Type)) { \
-            return ParseErrorUnexpectedTokenExpectedEither(typ1, typ2, (ts)->Current->Token); \
+        if ((typ1) != TOKEN_STREAM_CURRENT(ts)->Type && (typ2) != TOKEN_STREAM_CURRENT(ts)->Type) { \
+            return ParseErrorUnexpectedTokenExpectedEither(typ1, typ2, TOKEN_STREAM_CURRENT(ts)); \
         }                                                               \
         else {                                                          \
             TokenStreamAdvance((ts));                                   \
@@ -74,17 +76,17 @@ static unsigned int isInsideFunction = 0;
 
 #define OPT_EXPECT(typ, ts)                         \
     do {                                            \
-        if ((typ) == (ts)->Current->Token->Type) {  \
+        if ((typ) == TOKEN_STREAM_CURRENT(ts)->Type) {  \
             TokenStreamAdvance((ts));               \
         }                                           \
     } while(0)
 
 #define IF_FAIL_RETURN_PARSE_ERROR(result, ts, save, out_ast)       \
     do {                                                            \
-        if (R_OK != (result)) {                                     \
+        if (R_Success != (result)) {                                     \
             RESTORE((ts), (save));                                  \
             *(out_ast) = NULL;                                      \
-            return ParseErrorUnexpectedToken((ts)->Current->Token); \
+            return ParseErrorUnexpectedToken(TOKEN_STREAM_CURRENT(ts)); \
         }                                                           \
     } while(0)
 
@@ -96,7 +98,7 @@ static unsigned int isInsideFunction = 0;
     } while (0)
 
 int opt_expect(enum TokenType type, struct TokenStream *ts) {
-    int result = ts->Current->Token && ts->Current->Token->Type == type;
+    int result = ts->Current < ts->Count && TOKEN_STREAM_CURRENT(ts)->Type == type;
     if (result) {
         TokenStreamAdvance(ts);
     }
@@ -104,12 +106,33 @@ int opt_expect(enum TokenType type, struct TokenStream *ts) {
 }
 
 int check(enum TokenType type, struct TokenStream *ts) {
-    return ts->Current->Token && ts->Current->Token->Type == type;
+    return ts->Current < ts->Count && TOKEN_STREAM_CURRENT(ts)->Type == type;
+}
+
+/* `in' is only a keyword after `for <identifier>', elsewhere it is free
+   to name things. */
+static int check_in(struct TokenStream *ts) {
+    struct Token *token;
+    if (!check(TokenIdentifer, ts)) {
+        return 0;
+    }
+    token = TOKEN_STREAM_CURRENT(ts);
+    return 2 == token->Length && 0 == memcmp(token->Text, "in", 2);
+}
+
+/* AstMakeSymbol named after the token's text. */
+int ParseMakeSymbol(struct Ast **out_ast, struct Token *token) {
+    int result;
+    char *name = TokenTextDup(token);
+    result = AstMakeSymbol(out_ast, name, token->SrcLoc);
+    free(name);
+    return result;
 }
 
 int ParseErrorUnexpectedToken(struct Token *token) {
-    fprintf(stderr, "Unexpected token: '%s' at %s:%d:%d\n",
-            token->TokenStr,
+    fprintf(stderr, "Unexpected token: '%.*s' at %s:%d:%d\n",
+            (int)token->Length,
+            token->Text,
             token->SrcLoc.Filename,
             token->SrcLoc.LineNumber,
             token->SrcLoc.ColumnNumber);
@@ -117,8 +140,9 @@ int ParseErrorUnexpectedToken(struct Token *token) {
 }
 
 int ParseErrorUnexpectedTokenExpected(enum TokenType type, struct Token *token) {
-    fprintf(stderr, "Unexpected token: '%s' at %s:%d:%d, expected '%s'\n",
-            token->TokenStr,
+    fprintf(stderr, "Unexpected token: '%.*s' at %s:%d:%d, expected '%s'\n",
+            (int)token->Length,
+            token->Text,
             token->SrcLoc.Filename,
             token->SrcLoc.LineNumber,
             token->SrcLoc.ColumnNumber,
@@ -127,8 +151,9 @@ int ParseErrorUnexpectedTokenExpected(enum TokenType type, struct Token *token)
 }
 
 int ParseErrorUnexpectedTokenExpectedEither(enum TokenType type1, enum TokenType type2, struct Token *token) {
-    fprintf(stderr, "Unexpected token: '%s' at %s:%d:%d, expected either '%s' or '%s'\n",
-            token->TokenStr,
+    fprintf(stderr, "Unexpected token: '%.*s' at %s:%d:%d, expected either '%s' or '%s'\n",
+            (int)token->Length,
+            token->Text,
             token->SrcLoc.Filename,
             token->SrcLoc.LineNumber,
             token->SrcLoc.ColumnNumber,
@@ -291,12 +316,16 @@ int ParseExpr(struct Ast **out_ast, struct TokenStream *tokenStream);
 int ParseReturn(struct Ast **out_ast, struct TokenStream *tokenStream);
 int ParseContinue(struct Ast **out_ast, struct TokenStream *tokenStream);
 int ParseBreak(struct Ast **out_ast, struct TokenStream *tokenStream);
-int ParseOpAssign(struct Ast **out_ast, struct TokenStream *tokenStream);
+int ParseYield(struct Ast **out_ast, struct TokenStream *tokenStream);
+int ParseOpAssignFrom(struct Ast **out_ast, struct TokenStream *tokenStream, struct Ast *lhs, unsigned int start);
+int ParseAssignFrom(struct Ast **out_ast, struct TokenStream *tokenStream, struct Ast *lhs, unsigned int start);
 int ParseAssign(struct Ast **out_ast, struct TokenStream *tokenStream);
+int ParseAssignOrOpAssign(struct Ast **out_ast, struct TokenStream *tokenStream);
 int ParseIfElse(struct Ast **out_ast, struct TokenStream *tokenStream);
 int ParseFunction(struct Ast **out_ast, struct TokenStream *tokenStream);
 int ParseWhile(struct Ast **out_ast, struct TokenStream *tokenStream);
 int ParseFor(struct Ast **out_ast, struct TokenStream *tokenStream);
+int ParseForIn(struct Ast **out_ast, struct TokenStream *tokenStream);
 int ParseDeclStmt(struct Ast **out_ast, struct TokenStream *tokenStream);
 //int ParseStmt(struct Ast **out_ast, struct TokenStream *tokenStream);
 int ParseStmtList(struct Ast **out_ast, struct TokenStream *tokenStream);
@@ -305,7 +334,7 @@ int ParseIdentifier(struct Ast **out_ast, struct TokenStream *tokenStream);
 int ParseParenExpr(struct Ast **out_ast, struct TokenStream *tokenStream);
 int ParsePrimary(struct Ast **out_ast, struct TokenStream *tokenStream);
 int ParseBinaryRhs(struct Ast **out_ast, struct TokenStream *tokenStream, int prec, struct Ast *lhs);
-int ParseBinaryExpr(struct Ast **out_ast, struct TokenStream *tokenStream);
+int ParseBinaryExprFrom(struct Ast **out_ast, struct TokenStream *tokenStream, struct Ast *lhs);
 int ParseUnaryExpr(struct Ast **out_ast, struct TokenStream *tokenStream);
 int ParseConst(struct Ast **out_ast, struct TokenStream *tokenStream);
 int ParseMut(struct Ast **out_ast, struct TokenStream *tokenStream);
@@ -316,17 +345,16 @@ int ParseCommaSeparatedExprs(struct Ast **out_ast, struct TokenStream *tokenStre
 int ParseConst(struct Ast **out_ast, struct TokenStream *tokenStream) {
     /* TODO: Validate 'const-expr' */
     int result;
-    char *identifier;
+    unsigned int identifier;
     struct Ast *expr;
-    struct Node *save;
+    unsigned int save;
     SAVE(tokenStream, save);
     EXPECT_NO_MSG(TokenConst, tokenStream);
-    identifier = tokenStream->Current->Token->TokenStr;
+    SAVE(tokenStream, identifier);
     EXPECT(TokenIdentifer, tokenStream);
     EXPECT(TokenEquals, tokenStream);
     result = ParseAssign(&expr, tokenStream);
-    identifier = strdup(identifier);
-    return AstMakeConst(out_ast, identifier, expr, save->Token->SrcLoc);
+    return AstMakeConst(out_ast, TokenTextDup(TOKEN_STREAM_AT(tokenStream, identifier)), expr, TOKEN_STREAM_AT(tokenStream, save)->SrcLoc);
 }
 
 /* <comma-separated-identifers> := <identifier>
@@ -336,15 +364,15 @@ int ParseCommaSeparatedIdentifiers(struct Ast **out_ast, struct TokenStream *tok
     int result;
     struct Ast *names, *curName;
     AstMakeBlank(&names);
-    while(R_OK == (result = ParseIdentifier(&curName, tokenStream))) {
+    while(R_Success == (result = ParseIdentifier(&curName, tokenStream))) {
         AstAppendChild(names, curName);
         if (!opt_expect(TokenComma, tokenStream)) {
             break;
         }
     }
-    if (R_OK == result) {
+    if (R_Success == result) {
         *out_ast = names;
-        return R_OK;
+        return R_Success;
     }
     AstFree(names);
     *out_ast = NULL;
@@ -358,15 +386,15 @@ int ParseCommaSeparatedExprs(struct Ast **out_ast, struct TokenStream *tokenStre
     int result;
     struct Ast *exprs, *curExpr;
     AstMakeBlank(&exprs);
-    while(R_OK == (result = ParseAssign(&curExpr, tokenStream))) {
+    while(R_Success == (result = ParseAssign(&curExpr, tokenStream))) {
         AstAppendChild(exprs, curExpr);
         if (!opt_expect(TokenComma, tokenStream)) {
             break;
         }
     }
-    if (R_OK == result) {
+    if (R_Success == result) {
         *out_ast = exprs;
-        return R_OK;
+        return R_Success;
     }
     AstFree(exprs);
     *out_ast = NULL;
@@ -381,16 +409,16 @@ int ParseMut(struct Ast **out_ast, struct TokenStream *tokenStream) {
     /* TODO: Validate 'mut-expr' */
     int result;
     struct Ast *names, *exprs;
-    struct Node *save;
+    unsigned int save;
     SAVE(tokenStream, save);
     EXPECT_NO_MSG(TokenMut, tokenStream);
     result = ParseCommaSeparatedIdentifiers(&names, tokenStream);
     if (check(TokenEquals, tokenStream)) {
         EXPECT(TokenEquals, tokenStream);
         result = ParseCommaSeparatedExprs(&exprs, tokenStream);
-        return AstMakeMut(out_ast, names, exprs, save->Token->SrcLoc);
+        return AstMakeMut(out_ast, names, exprs, TOKEN_STREAM_AT(tokenStream, save)->SrcLoc);
     }
-    return AstMakeMut(out_ast, names, NULL, save->Token->SrcLoc);
+    return AstMakeMut(out_ast, names, NULL, TOKEN_STREAM_AT(tokenStream, save)->SrcLoc);
 }
 
 /* <for> := for <assign> ; <assign> ; <assign> { <stmt-list> } */
@@ -399,30 +427,63 @@ int ParseFor(struct Ast **out_ast, struct TokenStream *tokenStream) {
     /* TODO: Validate 'for' parsing. */
     int result;
     struct Ast *pre, *cond, *post, *body;
-    struct Node *save;
+    unsigned int save;
     SAVE(tokenStream, save);
 
     EXPECT_NO_MSG(TokenFor, tokenStream);
+    if (opt_expect(TokenIdentifer, tokenStream)) {
+        if (check_in(tokenStream)) {
+            RESTORE(tokenStream, save);
+            return ParseForIn(out_ast, tokenStream);
+        }
+        TokenStreamRewind(tokenStream);
+    }
 
-    result = ParseAssign(&pre, tokenStream);
-    if (R_OK != result) {
+    if (check(TokenMut, tokenStream) || check(TokenConst, tokenStream)) {
         result = ParseDeclStmt(&pre, tokenStream);
     }
+    else {
+        result = ParseAssign(&pre, tokenStream);
+    }
     EXPECT(TokenSemicolon, tokenStream);
 
     result = ParseAssign(&cond, tokenStream);
     EXPECT(TokenSemicolon, tokenStream);
 
-    result = ParseOpAssign(&post, tokenStream);
-    if (R_OK != result) {
-        result = ParseAssign(&post, tokenStream);
+    result = ParseAssignOrOpAssign(&post, tokenStream);
+
+    isInsideLoop = 1;
+    result = ParseStmtList(&body, tokenStream);
+    isInsideLoop = 0;
+
+    return AstMakeFor(out_ast, pre, cond, body, post, TOKEN_STREAM_AT(tokenStream, save)->SrcLoc);
+}
+
+/* <for-in> := for <identifier> in <expr> { <stmt-list> } */
+int ParseForIn(struct Ast **out_ast, struct TokenStream *tokenStream) {
+    int result;
+    struct Ast *name, *iterable, *body;
+    unsigned int save;
+    SAVE(tokenStream, save);
+
+    EXPECT_NO_MSG(TokenFor, tokenStream);
+    result = ParseMakeSymbol(&name, TOKEN_STREAM_CURRENT(tokenStream));
+    IF_FAIL_RETURN_PARSE_ERROR(result, tokenStream, save, out_ast);
+    EXPECT(TokenIdentifer, tokenStream);
+    if (!check_in(tokenStream)) {
+        return ParseErrorUnexpectedToken(TOKEN_STREAM_CURRENT(tokenStream));
     }
+    TokenStreamAdvance(tokenStream);
+
+    result = ParseAssign(&iterable, tokenStream);
+    IF_FAIL_RETURN_PARSE_ERROR(result, tokenStream, save, out_ast);
 
     isInsideLoop = 1;
     result = ParseStmtList(&body, tokenStream);
     isInsideLoop = 0;
+    IF_FAIL_RETURN_PARSE_ERROR(result, tokenStream, save, out_ast);
 
-    return AstMakeFor(out_ast, pre, cond, body, post, save->Token->SrcLoc);
+    return AstMakeForIn(out_ast, name, iterable, body, TOKEN_STREAM_AT(tokenStream, save)->SrcLoc);
 }
 
 /* <while> := while <expr> { <stmt-list> } */
@@ -430,7 +491,7 @@ int ParseWhile(struct Ast **out_ast, struct TokenStream *tokenStream) {
     /* TODO: Validate 'while' parsing. */
     int result;
     struct Ast *cond, *body;
-    struct Node *save;
+    unsigned int save;
     SAVE(tokenStream, save);
 
     EXPECT_NO_MSG(TokenWhile, tokenStream);
@@ -441,7 +502,7 @@ int ParseWhile(struct Ast **out_ast, struct TokenStream *tokenStream) {
     result = ParseStmtList(&body, tokenStream);
     isInsideLoop = 0;
 
-    return AstMakeWhile(out_ast, cond, body, save->Token->SrcLoc);
+    return AstMakeWhile(out_ast, cond, body, TOKEN_STREAM_AT(tokenStream, save)->SrcLoc);
 }
 
 /*
@@ -454,11 +515,9 @@ int ParseParamList(struct Ast **out_ast, struct TokenStream *tokenStream) {
     struct Ast *params, *param;
     result = AstMakeBlank(&params); /* FIXME: Do something with result. */
     while (check(TokenIdentifer, tokenStream)) {
-        result = AstMakeSymbol(&param,
-                               tokenStream->Current->Token->TokenStr,
-                               tokenStream->Current->Token->SrcLoc);
+        result = ParseMakeSymbol(&param, TOKEN_STREAM_CURRENT(tokenStream));
         TokenStreamAdvance(tokenStream);
-        if (R_OK != result) {
+        if (R_Success != result) {
             break;
         }
         AstAppendChild(params, param);
@@ -479,7 +538,7 @@ int ParseArgList(struct Ast **out_ast, struct TokenStream *tokenStream) {
     int result;
     struct Ast *args, *arg;
     result = AstMakeBlank(&args); /* FIXME: Do something with result. */
-    while (R_OK == (result = ParseAssign(&arg, tokenStream))) {
+    while (R_Success == (result = ParseAssign(&arg, tokenStream))) {
         AstAppendChild(args, arg);
         if (!opt_expect(TokenComma, tokenStream)) {
             break;
@@ -496,31 +555,31 @@ int ParsePostfixRhs(struct Ast **out_ast, struct TokenStream *tokenStream, struc
         struct Ast *expr;
         struct Ast *identifer;
     } u;
-    struct Node *save;
+    unsigned int save;
     SAVE(tokenStream, save);
     if (opt_expect(TokenLeftParen, tokenStream)) {
         if (opt_expect(TokenRightParen, tokenStream)) { /* No arguments. */
-            return AstMakeCall(out_ast, expr, NULL, save->Token->SrcLoc);
+            return AstMakeCall(out_ast, expr, NULL, TOKEN_STREAM_AT(tokenStream, save)->SrcLoc);
         }
         result = ParseArgList(&u.arglist, tokenStream);
         EXPECT(TokenRightParen, tokenStream);
-        if (R_OK == result) {
-            return AstMakeCall(out_ast, expr, u.arglist, save->Token->SrcLoc);
+        if (R_Success == result) {
+            return AstMakeCall(out_ast, expr, u.arglist, TOKEN_STREAM_AT(tokenStream, save)->SrcLoc);
         }
     }
     else if(opt_expect(TokenLeftSqBracket, tokenStream)) {
         result = ParseAssign(&u.expr, tokenStream);
         EXPECT(TokenRightSqBracket, tokenStream);
-        if (R_OK == result) {
-            return AstMakeArrayIdx(out_ast, expr, u.expr, save->Token->SrcLoc);
+        if (R_Success == result) {
+            return AstMakeArrayIdx(out_ast, expr, u.expr, TOKEN_STREAM_AT(tokenStream, save)->SrcLoc);
         }
     }
     else if (opt_expect(TokenDot, tokenStream)) {
         EXPECT(TokenIdentifer, tokenStream); /* Expect here because we know an identifier should follow. */
         TokenStreamRewind(tokenStream);
         result = ParseIdentifier(&u.identifer, tokenStream);
-        if (R_OK == result) {
-            return AstMakeMemberAccess(out_ast, expr, u.identifer, save->Token->SrcLoc);
+        if (R_Success == result) {
+            return AstMakeMemberAccess(out_ast, expr, u.identifer, TOKEN_STREAM_AT(tokenStream, save)->SrcLoc);
         }
     }
     *out_ast = NULL;
@@ -536,67 +595,65 @@ int ParsePostfixRhs(struct Ast **out_ast, struct TokenStream *tokenStream, struc
 int ParsePostfix(struct Ast **out_ast, struct TokenStream *tokenStream) {
     int result;
     struct Ast *expr, *tmp;
-    struct Node *save;
+    unsigned int save;
     result = ParsePrimary(&expr, tokenStream);
-    if (R_OK != result) {
+    if (R_Success != result) {
         *out_ast = NULL;
         return R_UnexpectedToken;
     }
 
-    SAVE(tokenStream, save);
-    result = ParsePostfixRhs(&tmp, tokenStream, expr);
-    if (R_OK != result) {
-        RESTORE(tokenStream, save);
-        *out_ast = expr;
-        return R_OK;
-    }
-
     while (check(TokenLeftParen, tokenStream) ||
            check(TokenLeftSqBracket, tokenStream) ||
            check(TokenDot, tokenStream)) { /* Parse the right side of the postfix expr */
-        result = ParsePostfixRhs(&tmp, tokenStream, tmp);
+        SAVE(tokenStream, save);
+        result = ParsePostfixRhs(&tmp, tokenStream, expr);
+        if (R_Success != result) {
+            RESTORE(tokenStream, save);
+            break;
+        }
+        expr = tmp;
     }
-    *out_ast = tmp;
-    return R_OK;
+    *out_ast = expr;
+    return R_Success;
 }
 /*
  * <literal>
  */
 int ParseLiteral(struct Ast **out_ast, struct TokenStream *tokenStream) {
     int result;
-    struct Node *save;
+    unsigned int save;
     struct Value *value;
-    struct Token *token = tokenStream->Current->Token;
+    struct Token *token = TOKEN_STREAM_CURRENT(tokenStream);
     SAVE(tokenStream, save);
     switch (token->Type) {
         default:
             goto fail_cleanup;
         case TokenIntegerConstant:
-            if (R_OK != ValueMakeIntegerLiteral(&value, token->v.Integer)) {
+            if (R_Success != ValueMakeIntegerLiteral(&value, token->v.Integer)) {
                 goto fail_cleanup;
             }
-            result = AstMakeInteger(out_ast, value, save->Token->SrcLoc);
+            result = AstMakeInteger(out_ast, value, TOKEN_STREAM_AT(tokenStream, save)->SrcLoc);
             goto success;
         case TokenRealConstant:
-            if (R_OK != ValueMakeRealLiteral(&value, token->v.Real)) {
+            if (R_Success != ValueMakeRealLiteral(&value, token->v.Real)) {
                 goto fail_cleanup;
             }
-            result = AstMakeReal(out_ast, value, save->Token->SrcLoc);
+            result = AstMakeReal(out_ast, value, TOKEN_STREAM_AT(tokenStream, save)->SrcLoc);
             goto success;
         case TokenStringLiteral:
-            if (R_OK != ValueMakeLLStringLiteralWithCString(&value, token->v.String)) {
+            if (R_Success != ValueMakeLLStringLiteralWithCString(&value, token->v.String)) {
                 goto fail_cleanup;
             }
-            result = AstMakeString(out_ast, value, save->Token->SrcLoc);
+            result = AstMakeString(out_ast, value, TOKEN_STREAM_AT(tokenStream, save)->SrcLoc);
             goto success;
         case TokenTrue:
-            result = AstMakeTrue(out_ast, save->Token->SrcLoc);
+            result = AstMakeTrue(out_ast, TOKEN_STREAM_AT(tokenStream, save)->SrcLoc);
             goto success;
         case TokenFalse:
-            result = AstMakeFalse(out_ast, save->Token->SrcLoc);
+            result = AstMakeFalse(out_ast, TOKEN_STREAM_AT(tokenStream, save)->SrcLoc);
             goto success;
         case TokenNil:
-            result = AstMakeNil(out_ast, save->Token->SrcLoc);
+            result = AstMakeNil(out_ast, TOKEN_STREAM_AT(tokenStream, save)->SrcLoc);
             goto success;
     }
 
@@ -613,11 +670,10 @@ fail_cleanup:
  * <identifier>
  */
 int ParseIdentifier(struct Ast **out_ast, struct TokenStream *tokenStream) {
-    struct Node *save;
-    char *identifier = tokenStream->Current->Token->TokenStr;
+    unsigned int save;
     SAVE(tokenStream, save);
     EXPECT_NO_MSG(TokenIdentifer, tokenStream);
-    return AstMakeSymbol(out_ast, identifier, save->Token->SrcLoc);
+    return ParseMakeSymbol(out_ast, TOKEN_STREAM_AT(tokenStream, save));
 }
 
 /*
@@ -641,27 +697,27 @@ int ParseBinaryRhs(struct Ast **out_ast, struct TokenStream *tokenStream, int pr
     enum AstNodeType binOp;
     struct Ast *rhs;
     while (1) {
-        tokenPrec = GetBinaryOperatorPrecedence(tokenStream->Current->Token);
+        tokenPrec = GetBinaryOperatorPrecedence(TOKEN_STREAM_CURRENT(tokenStream));
         if (tokenPrec < prec) {
             *out_ast = lhs;
-            return R_OK;
+            return R_Success;
         }
-        binOp = GetBinaryOperatorType(tokenStream->Current->Token);
+        binOp = GetBinaryOperatorType(TOKEN_STREAM_CURRENT(tokenStream));
         TokenStreamAdvance(tokenStream);
         result = ParseUnaryExpr(&rhs, tokenStream);
-        if (R_OK != result) {
+        if (R_Success != result) {
             return result;
         }
         /* ParsePrimary should set us on an operator unless it failed... */
-        nextPrec = GetBinaryOperatorPrecedence(tokenStream->Current->Token);
+        nextPrec = GetBinaryOperatorPrecedence(TOKEN_STREAM_CURRENT(tokenStream));
         if (tokenPrec < nextPrec) {
             result = ParseBinaryRhs(&rhs, tokenStream, tokenPrec + 1, rhs);
-            if (R_OK != result) {
+            if (R_Success != result) {
                 return result;
             }
         }
-        result = AstMakeBinaryOp(&lhs, lhs, binOp, rhs, tokenStream->Current->Token->SrcLoc);
-        if (R_OK != result) {
+        result = AstMakeBinaryOp(&lhs, lhs, binOp, rhs, TOKEN_STREAM_CURRENT(tokenStream)->SrcLoc);
+        if (R_Success != result) {
             return result;
         }
     }
@@ -674,24 +730,22 @@ int ParseBinaryRhs(struct Ast **out_ast, struct TokenStream *tokenStream, int pr
 int ParsePrimary(struct Ast **out_ast, struct TokenStream *tokenStream) {
     int result;
     struct Ast *primary;
-    struct Node *save;
+    unsigned int save;
     SAVE(tokenStream, save);
-    result = ParseIdentifier(&primary, tokenStream);
-    if (R_OK == result) {
-        *out_ast = primary;
-        return R_OK;
-    }
-    RESTORE(tokenStream, save);
-    result = ParseLiteral(&primary, tokenStream);
-    if (R_OK == result) {
-        *out_ast = primary;
-        return R_OK;
+    switch (TOKEN_STREAM_CURRENT(tokenStream)->Type) {
+        default:
+            result = ParseLiteral(&primary, tokenStream);
+            break;
+        case TokenIdentifer:
+            result = ParseIdentifier(&primary, tokenStream);
+            break;
+        case TokenLeftParen:
+            result = ParseParenExpr(&primary, tokenStream);
+            break;
     }
-    RESTORE(tokenStream, save);
-    result = ParseParenExpr(&primary, tokenStream);
-    if (R_OK == result) {
+    if (R_Success == result) {
         *out_ast = primary;
-        return R_OK;
+        return R_Success;
     }
     RESTORE(tokenStream, save);
     *out_ast = NULL;
@@ -706,22 +760,22 @@ int ParseUnaryExpr(struct Ast **out_ast, struct TokenStream *tokenStream) {
     int result;
     enum AstNodeType unOp;
     struct Ast *postfix, *expr;
-    struct Node *save;
+    unsigned int save;
     SAVE(tokenStream, save);
-    result = ParsePostfix(&postfix, tokenStream);
-    if (R_OK == result) {
-        *out_ast = postfix;
-        return R_OK;
-    }
-    RESTORE(tokenStream, save);
-    if (!IsUnaryOperator(tokenStream->Current->Token)) {
+    if (!IsUnaryOperator(TOKEN_STREAM_CURRENT(tokenStream))) {
+        result = ParsePostfix(&postfix, tokenStream);
+        if (R_Success == result) {
+            *out_ast = postfix;
+            return R_Success;
+        }
+        RESTORE(tokenStream, save);
         return R_UnexpectedToken;
     }
-    unOp = GetUnaryOperatorType(tokenStream->Current->Token);
+    unOp = GetUnaryOperatorType(TOKEN_STREAM_CURRENT(tokenStream));
     TokenStreamAdvance(tokenStream);
     result = ParseUnaryExpr(&expr, tokenStream);
-    if (R_OK == result) {
-        return AstMakeUnaryOp(out_ast, unOp, expr, save->Token->SrcLoc);
+    if (R_Success == result) {
+        return AstMakeUnaryOp(out_ast, unOp, expr, TOKEN_STREAM_AT(tokenStream, save)->SrcLoc);
     }
     *out_ast = NULL;
     return result;
@@ -730,100 +784,125 @@ int ParseUnaryExpr(struct Ast **out_ast, struct TokenStream *tokenStream) {
 
 /*
  * <binary-expr> := <unary-expr> <binary-op> <binary-rhs> 
+ *
+ * lhs is the <unary-expr> already parsed by the caller.
  */
-int ParseBinaryExpr(struct Ast **out_ast, struct TokenStream *tokenStream) {
+int ParseBinaryExprFrom(struct Ast **out_ast, struct TokenStream *tokenStream, struct Ast *lhs) {
     /* TODO: Parse right associativity such as 3 ** 3 ** 3 should be equal
      * to 3 ** (3 ** 3) or 3 ** 27 not (3 ** 3) ** 3 */
     int result;
     int opPrec;
-    struct Ast *lhs, *ast;
-    struct Node *save;
-    SAVE(tokenStream, save);
-    result = ParseUnaryExpr(&lhs, tokenStream);
-    if (R_OK != result) {
-        return result;
-    }
-    if(!IsBinaryOperator(tokenStream->Current->Token)) {
+    struct Ast *ast;
+    if(!IsBinaryOperator(TOKEN_STREAM_CURRENT(tokenStream))) {
         *out_ast = lhs;
-        return R_OK;
+        return R_Success;
     }
-    opPrec = GetBinaryOperatorPrecedence(tokenStream->Current->Token);
+    opPrec = GetBinaryOperatorPrecedence(TOKEN_STREAM_CURRENT(tokenStream));
     result = ParseBinaryRhs(&ast, tokenStream, opPrec, lhs);
     while (1) {
-        opPrec = GetBinaryOperatorPrecedence(tokenStream->Current->Token);
+        opPrec = GetBinaryOperatorPrecedence(TOKEN_STREAM_CURRENT(tokenStream));
         if (-1 == opPrec) {
             break;
         }
         result = ParseBinaryRhs(&ast, tokenStream, opPrec, ast);
     }
-    if (R_OK == result) {
+    if (R_Success == result) {
         *out_ast = ast;
-        return R_OK;
+        return R_Success;
     }
     *out_ast = NULL;
     return result;
 }
 
 
-int ParseOpAssign(struct Ast **out_ast, struct TokenStream *tokenStream) {
+/*
+ * <op-assign> := <unary-expr> <assignment-operator> <assign>
+ *
+ * lhs is the <unary-expr> that began at start.
+ */
+int ParseOpAssignFrom(struct Ast **out_ast, struct TokenStream *tokenStream, struct Ast *lhs, unsigned int start) {
     int result;
-    struct Ast *lhs, *rhs, *op, *assign, *tmp;
-    struct Node *save;
+    struct Ast *rhs, *op, *assign, *tmp;
+    unsigned int operator;
     struct Token *token;
     enum AstNodeType opType;
-    SAVE(tokenStream, save);
-    result = ParseUnaryExpr(&lhs, tokenStream);
-    if (R_OK != result) {
-        *out_ast = NULL;
-        return result;
-    }
-    if (!IsAssignmentOperator(tokenStream->Current->Token)) {
-        RESTORE(tokenStream, save);
-        *out_ast = NULL;
-        return R_UnexpectedToken;
-    }
-    token = tokenStream->Current->Token;
+    SAVE(tokenStream, operator);
     TokenStreamAdvance(tokenStream);
 
     result = ParseAssign(&rhs, tokenStream);
-    if (R_OK != result) {
-        RESTORE(tokenStream, save);
+    if (R_Success != result) {
+        RESTORE(tokenStream, start);
         *out_ast = NULL;
         return result;
     }
 
+    token = TOKEN_STREAM_AT(tokenStream, operator);
     opType = GetAssignmentOperatorOperatorType(token);
     AstMakeBinaryOp(&op, lhs, opType, rhs, token->SrcLoc);
     AstDeepCopy(&tmp, lhs);
-    AstMakeAssign(&assign, tmp, op, save->Token->SrcLoc);
+    AstMakeAssign(&assign, tmp, op, TOKEN_STREAM_AT(tokenStream, start)->SrcLoc);
     *out_ast = assign;
-    return R_OK;
+    return R_Success;
 }
 
 /*
  * <assign> := <binary-expr>
- *          := <unary-expr> <assignment-operator> <assign> 
+ *          := <unary-expr> = <assign>
+ *
+ * lhs is the <unary-expr> both forms begin with, it began at start.
  */
+int ParseAssignFrom(struct Ast **out_ast, struct TokenStream *tokenStream, struct Ast *lhs, unsigned int start) {
+    int result;
+    struct Ast *expr;
+    unsigned int afterLhs;
+    if (opt_expect(TokenEquals, tokenStream)) {
+        result = ParseAssign(&expr, tokenStream);
+        IF_FAIL_RETURN_PARSE_ERROR(result, tokenStream, start, out_ast);
+        return AstMakeAssign(out_ast, lhs, expr, TOKEN_STREAM_AT(tokenStream, start)->SrcLoc);
+    }
+    SAVE(tokenStream, afterLhs);
+    result = ParseBinaryExprFrom(&expr, tokenStream, lhs);
+    if (R_Success == result && !check(TokenEquals, tokenStream)) {
+        *out_ast = expr;
+        return R_Success;
+    }
+    /* Only a <unary-expr> may be assigned to. */
+    RESTORE(tokenStream, afterLhs);
+    *out_ast = NULL;
+    return R_UnexpectedToken;
+}
+
 int ParseAssign(struct Ast **out_ast, struct TokenStream *tokenStream) {
     int result;
-    struct Ast *unary, *expr;
-    struct Node *save;
+    struct Ast *lhs;
+    unsigned int save;
     SAVE(tokenStream, save);
-    result = ParseBinaryExpr(&expr, tokenStream);
-    if (R_OK == result && !check(TokenEquals, tokenStream)) {
-        *out_ast = expr;
-        return R_OK;
+    result = ParseUnaryExpr(&lhs, tokenStream);
+    if (R_Success != result) {
+        *out_ast = NULL;
+        return result;
     }
-    RESTORE(tokenStream, save);
-    result = ParseUnaryExpr(&unary, tokenStream);
-    if (R_OK != result) {
+    return ParseAssignFrom(out_ast, tokenStream, lhs, save);
+}
+
+/*
+ * <assign-or-op-assign> := <assign>
+ *                       := <op-assign>
+ */
+int ParseAssignOrOpAssign(struct Ast **out_ast, struct TokenStream *tokenStream) {
+    int result;
+    struct Ast *lhs;
+    unsigned int save;
+    SAVE(tokenStream, save);
+    result = ParseUnaryExpr(&lhs, tokenStream);
+    if (R_Success != result) {
         *out_ast = NULL;
         return result;
     }
-    EXPECT_NO_MSG(TokenEquals, tokenStream);
-    result = ParseAssign(&expr, tokenStream);
-    IF_FAIL_RETURN_PARSE_ERROR(result, tokenStream, save, out_ast);
-    return AstMakeAssign(out_ast, unary, expr, save->Token->SrcLoc);
+    if (IsAssignmentOperator(TOKEN_STREAM_CURRENT(tokenStream))) {
+        return ParseOpAssignFrom(out_ast, tokenStream, lhs, save);
+    }
+    return ParseAssignFrom(out_ast, tokenStream, lhs, save);
 }
 
 /*
@@ -834,28 +913,20 @@ int ParseAssign(struct Ast **out_ast, struct TokenStream *tokenStream) {
 int ParseExpr(struct Ast **out_ast, struct TokenStream *tokenStream) {
     int result;
     struct Ast *ast;
-    struct Node *save;
+    unsigned int save;
     SAVE(tokenStream, save);
-    result = ParseOpAssign(&ast, tokenStream);
-    if (R_OK == result) {
-        OPT_EXPECT(TokenSemicolon, tokenStream);
-        *out_ast = ast;
-        return R_OK;
+    if (check(TokenMut, tokenStream) || check(TokenConst, tokenStream)) {
+        result = ParseDeclStmt(&ast, tokenStream);
     }
-    RESTORE(tokenStream, save);
-    result = ParseAssign(&ast, tokenStream);
-    if (R_OK == result) {
-        OPT_EXPECT(TokenSemicolon, tokenStream);
-        *out_ast = ast;
-        return R_OK;
+    else {
+        result = ParseAssignOrOpAssign(&ast, tokenStream);
     }
-    RESTORE(tokenStream, save);
-    result = ParseDeclStmt(&ast, tokenStream);
-    if (R_OK == result) {
+    if (R_Success == result) {
         OPT_EXPECT(TokenSemicolon, tokenStream);
         *out_ast = ast;
-        return R_OK;
+        return R_Success;
     }
+    RESTORE(tokenStream, save);
     *out_ast = NULL;
     return R_UnexpectedToken;
 }
@@ -865,41 +936,60 @@ int ParseExpr(struct Ast **out_ast, struct TokenStream *tokenStream) {
 int ParseReturn(struct Ast **out_ast, struct TokenStream *tokenStream) {
     int result;
     struct Ast *ast;
-    struct Node *save;
+    unsigned int save;
     SAVE(tokenStream, save);
     EXPECT_NO_MSG(TokenReturn, tokenStream);
     if (!isInsideFunction) {
-        return ParseErrorUnexpectedToken(save->Token);
+        return ParseErrorUnexpectedToken(TOKEN_STREAM_AT(tokenStream, save));
     }
     result = ParseAssign(&ast, tokenStream);
-    if (R_OK == result) {
-        return AstMakeReturn(out_ast, ast, save->Token->SrcLoc);
+    if (R_Success == result) {
+        return AstMakeReturn(out_ast, ast, TOKEN_STREAM_AT(tokenStream, save)->SrcLoc);
     }
-    return AstMakeReturn(out_ast, NULL, save->Token->SrcLoc);
+    return AstMakeReturn(out_ast, NULL, TOKEN_STREAM_AT(tokenStream, save)->SrcLoc);
+}
+
+/* Only parses if inside a function, makes that function a generator. */
+/* <yield> := yield <assign> */
+int ParseYield(struct Ast **out_ast, struct TokenStream *tokenStream) {
+    int result;
+    struct Ast *ast;
+    unsigned int save;
+    SAVE(tokenStream, save);
+    EXPECT_NO_MSG(TokenYield, tokenStream);
+    if (!isInsideFunction) {
+        return ParseErrorUnexpectedToken(TOKEN_STREAM_AT(tokenStream, save));
+    }
+    hasYielded = 1;
+    result = ParseAssign(&ast, tokenStream);
+    if (R_Success == result) {
+        return AstMakeYield(out_ast, ast, TOKEN_STREAM_AT(tokenStream, save)->SrcLoc);
+    }
+    return AstMakeYield(out_ast, NULL, TOKEN_STREAM_AT(tokenStream, save)->SrcLoc);
 }
 
 /* Only parses if inside a loop. */
 /* <continue> := continue */
 int ParseContinue(struct Ast **out_ast, struct TokenStream *tokenStream) {
-    struct Node *save;
+    unsigned int save;
     SAVE(tokenStream, save);
     EXPECT_NO_MSG(TokenContinue, tokenStream);
     if (!isInsideLoop) {
-        return ParseErrorUnexpectedToken(save->Token);
+        return ParseErrorUnexpectedToken(TOKEN_STREAM_AT(tokenStream, save));
     }
-    return AstMakeContinue(out_ast, save->Token->SrcLoc);
+    return AstMakeContinue(out_ast, TOKEN_STREAM_AT(tokenStream, save)->SrcLoc);
 }
 
 /* Only parses if inside a loop. */
 /* <continue> := break */
 int ParseBreak(struct Ast **out_ast, struct TokenStream *tokenStream) {
-    struct Node *save;
+    unsigned int save;
     SAVE(tokenStream, save);
     EXPECT_NO_MSG(TokenBreak, tokenStream);
     if (!isInsideLoop) {
-        return ParseErrorUnexpectedToken(save->Token);
+        return ParseErrorUnexpectedToken(TOKEN_STREAM_AT(tokenStream, save));
     }
-    return AstMakeBreak(out_ast, save->Token->SrcLoc);
+    return AstMakeBreak(out_ast, TOKEN_STREAM_AT(tokenStream, save)->SrcLoc);
 }
 
 /*
@@ -909,13 +999,14 @@ int ParseBreak(struct Ast **out_ast, struct TokenStream *tokenStream) {
 int ParseFunction(struct Ast **out_ast, struct TokenStream *tokenStream) {
     int result, numArgs, isVarArgs = 0;
     char *funcName;
+    unsigned int nameToken;
     struct Function *fn;
     struct Value *function;
     struct Ast *params, *body;
-    struct Node *save;
+    unsigned int save;
     SAVE(tokenStream, save);
     EXPECT_NO_MSG(TokenDef, tokenStream); /* def */
-    funcName = tokenStream->Current->Token->TokenStr;
+    SAVE(tokenStream, nameToken);
     EXPECT(TokenIdentifer, tokenStream); /* identifer */
     if (opt_expect(TokenLeftParen, tokenStream)) { /* ( */
         result = ParseParamList(&params, tokenStream); /* param-list */
@@ -926,6 +1017,7 @@ int ParseFunction(struct Ast **out_ast, struct TokenStream *tokenStream) {
         params = NULL; /* no params */
     }
     isInsideFunction = 1;
+    hasYielded = 0;
     result = ParseStmtList(&body, tokenStream); /* body */
     isInsideFunction = 0;
     IF_FAIL_RETURN_PARSE_ERROR(result, tokenStream, save, out_ast);
@@ -937,17 +1029,21 @@ int ParseFunction(struct Ast **out_ast, struct TokenStream *tokenStream) {
         numArgs = 0;
     }
 
+    funcName = TokenTextDup(TOKEN_STREAM_AT(tokenStream, nameToken));
     FunctionMake(&fn, funcName, numArgs, isVarArgs, params, body);
+    free(funcName);
+    fn->IsGenerator = hasYielded;
+    hasYielded = 0;
     function = malloc(sizeof *function);
     result = ValueMakeFunction(function, fn);
-    if (R_OK != result) {
+    if (R_Success != result) {
         free(fn);
         free(function);
         AstFree(params);
         AstFree(body);
         IF_FAIL_RETURN_PARSE_ERROR(result, tokenStream, save, out_ast);
     }
-    return AstMakeFunction(out_ast, function, save->Token->SrcLoc);
+    return AstMakeFunction(out_ast, function, TOKEN_STREAM_AT(tokenStream, save)->SrcLoc);
 }
 
 /*
@@ -957,7 +1053,7 @@ int ParseFunction(struct Ast **out_ast, struct TokenStream *tokenStream) {
  */
 int ParseIfElse(struct Ast **out_ast, struct TokenStream *tokenStream) {
     int result;
-    struct Node *save, *beforeElse;
+    unsigned int save, beforeElse;
     struct Ast *cond, *ifBody, *elseBody;
     cond = ifBody = elseBody = NULL;
     SAVE(tokenStream, save);
@@ -976,19 +1072,19 @@ int ParseIfElse(struct Ast **out_ast, struct TokenStream *tokenStream) {
     }
     if (!opt_expect(TokenElse, tokenStream)) { /* no else */
         RESTORE(tokenStream, beforeElse);
-        return AstMakeIfElse(out_ast, cond, ifBody, NULL, save->Token->SrcLoc);
+        return AstMakeIfElse(out_ast, cond, ifBody, NULL, TOKEN_STREAM_AT(tokenStream, save)->SrcLoc);
     }
     if (check(TokenLeftCurlyBrace, tokenStream)) { /* else { */
         result = ParseStmtList(&elseBody, tokenStream);
         IF_FAIL_RETURN_PARSE_ERROR(result, tokenStream, save, out_ast);
-        return AstMakeIfElse(out_ast, cond, ifBody, elseBody, save->Token->SrcLoc);
+        return AstMakeIfElse(out_ast, cond, ifBody, elseBody, TOKEN_STREAM_AT(tokenStream, save)->SrcLoc);
     }
     EXPECT(TokenIf, tokenStream); /* else if */
     /* EXPECT eats ths if but we need it to parse a valid IfElse */
     TokenStreamRewind(tokenStream);
     result = ParseIfElse(&elseBody, tokenStream);
     IF_FAIL_RETURN_PARSE_ERROR(result, tokenStream, save, out_ast);
-    return AstMakeIfElse(out_ast, cond, ifBody, elseBody, save->Token->SrcLoc);
+    return AstMakeIfElse(out_ast, cond, ifBody, elseBody, TOKEN_STREAM_AT(tokenStream, save)->SrcLoc);
 }
 
 /*
@@ -996,23 +1092,15 @@ int ParseIfElse(struct Ast **out_ast, struct TokenStream *tokenStream) {
  *             := <const>
  */
 int ParseDeclStmt(struct Ast **out_ast, struct TokenStream *tokenStream) {
-    int result = 0;
-    struct Ast *ast;
-    struct Node *save;
-    SAVE(tokenStream, save);
-    result = ParseMut(&ast, tokenStream);
-    if (R_OK == result) {
-        *out_ast = ast;
-        return R_OK;
-    }
-    RESTORE(tokenStream, save);
-    result = ParseConst(&ast, tokenStream);
-    if (R_OK == result) {
-        *out_ast = ast;
-        return R_OK;
+    switch (TOKEN_STREAM_CURRENT(tokenStream)->Type) {
+        default:
+            *out_ast = NULL;
+            return R_UnexpectedToken;
+        case TokenMut:
+            return ParseMut(out_ast, tokenStream);
+        case TokenConst:
+            return ParseConst(out_ast, tokenStream);
     }
-    *out_ast = NULL;
-    return R_UnexpectedToken;
 }
 
 /*
@@ -1027,67 +1115,51 @@ int ParseDeclStmt(struct Ast **out_ast, struct TokenStream *tokenStream) {
  *        := <return>
  */
 int ParseStmt(struct Ast **out_ast, struct TokenStream *tokenStream) {
-    struct Node *save;
-    struct Ast *ast;
+    unsigned int save;
     int result;
     SAVE(tokenStream, save);
-
-    result = ParseFunction(&ast, tokenStream);
-    if (R_OK == result) {
-        *out_ast = ast;
-        return R_OK;
-    }
-    RESTORE(tokenStream, save);
-    result = ParseIfElse(&ast, tokenStream);
-    if (R_OK == result) {
-        *out_ast = ast;
-        return R_OK;
-    }
-    RESTORE(tokenStream, save);
-    result = ParseExpr(&ast, tokenStream);
-    if (R_OK == result) {
-        *out_ast = ast;
-        return R_OK;
-    }
-    RESTORE(tokenStream, save);
-    result = ParseFor(&ast, tokenStream);
-    if (R_OK == result) {
-        *out_ast = ast;
-        return R_OK;
-    }
-    RESTORE(tokenStream, save);
-    result = ParseWhile(&ast, tokenStream);
-    if (R_OK == result) {
-        *out_ast = ast;
-        return R_OK;
-    }
-    RESTORE(tokenStream, save);
-    result = ParseReturn(&ast, tokenStream);
-    if (R_OK == result) {
-        *out_ast = ast;
-        return R_OK;
-    }
-    RESTORE(tokenStream, save);
-    result = ParseBreak(&ast, tokenStream);
-    if (R_OK == result) {
-        *out_ast = ast;
-        return R_OK;
-    }
-    RESTORE(tokenStream, save);
-    result = ParseContinue(&ast, tokenStream);
-    if (R_OK == result) {
-        *out_ast = ast;
-        return R_OK;
-    }
-    if (check(TokenEOS, tokenStream) || /* End of stream */
-        check(TokenSemicolon, tokenStream) || /* ; */
-        check(TokenNewline, tokenStream) || /* <newline> */
-        check(TokenRightCurlyBrace, tokenStream)) { /* { */
-        *out_ast = NULL;
-        return R_OK;
+    /* Every form but <expr> starts with a keyword, so the first token
+       picks the parser. */
+    switch (TOKEN_STREAM_CURRENT(tokenStream)->Type) {
+        default:
+            result = ParseExpr(out_ast, tokenStream);
+            break;
+        case TokenDef:
+            result = ParseFunction(out_ast, tokenStream);
+            break;
+        case TokenIf:
+            result = ParseIfElse(out_ast, tokenStream);
+            break;
+        case TokenFor:
+            result = ParseFor(out_ast, tokenStream);
+            break;
+        case TokenWhile:
+            result = ParseWhile(out_ast, tokenStream);
+            break;
+        case TokenReturn:
+            result = ParseReturn(out_ast, tokenStream);
+            break;
+        case TokenBreak:
+            result = ParseBreak(out_ast, tokenStream);
+            break;
+        case TokenYield:
+            result = ParseYield(out_ast, tokenStream);
+            break;
+        case TokenContinue:
+            result = ParseContinue(out_ast, tokenStream);
+            break;
+        case TokenEOS: /* End of stream */
+        case TokenSemicolon: /* ; */
+        case TokenNewline: /* <newline> */
+        case TokenRightCurlyBrace: /* } */
+            *out_ast = NULL;
+            return R_Success;
+    }
+    if (R_Success != result) {
+        RESTORE(tokenStream, save);
+        return R_UnexpectedToken;
     }
-    RESTORE(tokenStream, save);
-    return R_UnexpectedToken;
+    return R_Success;
 }
 
 /*
@@ -1106,11 +1178,11 @@ int ParseStmtList(struct Ast **out_ast, struct TokenStream *tokenStream) {
     }
     EXPECT(TokenLeftCurlyBrace, tokenStream);
     result = AstMakeBlank(&ast);
-    if (R_OK != result) {
+    if (R_Success != result) {
         out_ast = NULL;
         return result;
     }
-    while (R_OK == (result = ParseStmt(&tmp, tokenStream))) {
+    while (R_Success == (result = ParseStmt(&tmp, tokenStream))) {
         AstAppendChild(ast, tmp);
         if (check(TokenRightCurlyBrace, tokenStream)) {
             break;
@@ -1121,7 +1193,7 @@ int ParseStmtList(struct Ast **out_ast, struct TokenStream *tokenStream) {
         EXPECT_EITHER(TokenSemicolon, TokenNewline, tokenStream);
     }
     EXPECT(TokenRightCurlyBrace, tokenStream);
-    if (R_OK == result) {
+    if (R_Success == result) {
         ast->Type = Body;
         *out_ast = ast;
     }
@@ -1135,7 +1207,7 @@ int ParseStmtList(struct Ast **out_ast, struct TokenStream *tokenStream) {
 int ParseImport(struct Ast **out_ast, struct TokenStream *tokenStream) {
     int result;
     struct Ast *modName, *as = NULL;
-    struct Node *save;
+    unsigned int save;
     SAVE(tokenStream, save);
     EXPECT_NO_MSG(TokenImport, tokenStream);
     EXPECT(TokenStringLiteral, tokenStream);
@@ -1145,7 +1217,7 @@ int ParseImport(struct Ast **out_ast, struct TokenStream *tokenStream) {
     EXPECT(TokenIdentifer, tokenStream);
     TokenStreamRewind(tokenStream);
     result = ParseIdentifier(&as, tokenStream);
-    return AstMakeImport(out_ast, modName, as, save->Token->SrcLoc);
+    return AstMakeImport(out_ast, modName, as, TOKEN_STREAM_AT(tokenStream, save)->SrcLoc);
 }
 
 /* <class-expr> := <mut-expr>
@@ -1154,35 +1226,32 @@ int ParseImport(struct Ast **out_ast, struct TokenStream *tokenStream) {
  */
 int ParseClassExpr(struct Ast **out_ast, struct TokenStream *tokenStream) {
     int result;
-    struct Ast *expr;
-    struct Node *save;
+    unsigned int save;
     SAVE(tokenStream, save);
-    result = ParseMut(&expr, tokenStream);
-    if (R_OK == result) {
-        *out_ast = expr;
-        return R_OK;
-    }
-    RESTORE(tokenStream, save);
-    result = ParseConst(&expr, tokenStream);
-    if (R_OK == result) {
-        *out_ast = expr;
-        return R_OK;
-    }
-    RESTORE(tokenStream, save);
-    result = ParseFunction(&expr, tokenStream);
-    if (R_OK == result) {
-        *out_ast = expr;
-        return R_OK;
-    }
-    if (check(TokenEOS, tokenStream) || /* End of stream */
-        check(TokenSemicolon, tokenStream) || /* ; */
-        check(TokenNewline, tokenStream) || /* <newline> */
-        check(TokenRightCurlyBrace, tokenStream)) { /* { */
-        *out_ast = NULL;
-        return R_OK;
+    switch (TOKEN_STREAM_CURRENT(tokenStream)->Type) {
+        default:
+            return R_UnexpectedToken;
+        case TokenMut:
+            result = ParseMut(out_ast, tokenStream);
+            break;
+        case TokenConst:
+            result = ParseConst(out_ast, tokenStream);
+            break;
+        case TokenDef:
+            result = ParseFunction(out_ast, tokenStream);
+            break;
+        case TokenEOS: /* End of stream */
+        case TokenSemicolon: /* ; */
+        case TokenNewline: /* <newline> */
+        case TokenRightCurlyBrace: /* } */
+            *out_ast = NULL;
+            return R_Success;
+    }
+    if (R_Success != result) {
+        RESTORE(tokenStream, save);
+        return R_UnexpectedToken;
     }
-    RESTORE(tokenStream, save);
-    return R_UnexpectedToken;
+    return R_Success;
 }
 
 /* <class-body> := <class-expr>
@@ -1195,11 +1264,11 @@ int ParseClassBody(struct Ast **out_ast, struct TokenStream *tokenStream) {
     EXPECT(TokenLeftCurlyBrace, tokenStream);
     EAT_TERMINATORS(tokenStream);
     result = AstMakeBlank(&body);
-    if (R_OK != result) {
+    if (R_Success != result) {
         out_ast = NULL;
         return result;
     }
-    while (R_OK == (result = ParseClassExpr(&tmp, tokenStream))) {
+    while (R_Success == (result = ParseClassExpr(&tmp, tokenStream))) {
         AstAppendChild(body, tmp);
         if (check(TokenRightCurlyBrace, tokenStream)) {
             break;
@@ -1211,7 +1280,7 @@ int ParseClassBody(struct Ast **out_ast, struct TokenStream *tokenStream) {
     }
     EXPECT(TokenRightCurlyBrace, tokenStream);
     *out_ast = body;
-    return R_OK;
+    return R_Success;
 }
 
 /* <class> := class <identifier> { <class-body> } */
@@ -1219,23 +1288,26 @@ int ParseClass(struct Ast **out_ast, struct TokenStream *tokenStream) {
     int result;
     struct Ast *class, *body;
     char *className;
-    struct Node *save;
+    unsigned int nameToken;
+    unsigned int save;
     SAVE(tokenStream, save);
     EXPECT_NO_MSG(TokenClass, tokenStream);
-    className = tokenStream->Current->Token->TokenStr;
+    SAVE(tokenStream, nameToken);
     EXPECT(TokenIdentifer, tokenStream);
     result = ParseClassBody(&body, tokenStream);
-    if (R_OK != result) {
+    if (R_Success != result) {
         *out_ast = NULL;
         return result;
     }
-    result = AstMakeClass(&class, className, body, save->Token->SrcLoc);
-    if (R_OK != result) {
+    className = TokenTextDup(TOKEN_STREAM_AT(tokenStream, nameToken));
+    result = AstMakeClass(&class, className, body, TOKEN_STREAM_AT(tokenStream, save)->SrcLoc);
+    free(className);
+    if (R_Success != result) {
         *out_ast = NULL;
         return result;
     }
     *out_ast = class;
-    return R_OK;
+    return R_Success;
 }
 
 /*
@@ -1244,40 +1316,41 @@ int ParseClass(struct Ast **out_ast, struct TokenStream *tokenStream) {
  */
 int ParseTokenStream(struct ParsedTrees *parsedTrees, struct TokenStream *tokenStream) {
     int result;
-    struct Node *save, *tryImport;
     struct Ast *imports, *classes, *functionDefs, *program, *tmp;
     AstMakeBlank(&imports);
     AstMakeBlank(&classes);
     AstMakeBlank(&functionDefs);
     AstMakeBlank(&program);
-    SAVE(tokenStream, save);
-    while (tokenStream->Current && TokenEOS != tokenStream->Current->Token->Type) {
-        SAVE(tokenStream, tryImport);
-        result = ParseImport(&tmp, tokenStream);
-        if (R_OK == result) {
+    while (tokenStream->Current < tokenStream->Count && TokenEOS != TOKEN_STREAM_CURRENT(tokenStream)->Type) {
+        if (check(TokenImport, tokenStream)) {
+            result = ParseImport(&tmp, tokenStream);
+            if (R_Success != result) {
+                goto parse_error_cleanup;
+            }
             AstAppendChild(imports, tmp);
             continue;
         }
-        RESTORE(tokenStream, tryImport);
-        result = ParseClass(&tmp, tokenStream);
-        if (R_OK == result) {
+        if (check(TokenClass, tokenStream)) {
+            result = ParseClass(&tmp, tokenStream);
+            if (R_Success != result) {
+                goto parse_error_cleanup;
+            }
             AstAppendChild(classes, tmp);
             continue;
         }
-        RESTORE(tokenStream, tryImport);
         result = ParseStmt(&tmp, tokenStream);
         if (!check(TokenEOS, tokenStream)) {
             EXPECT_EITHER(TokenSemicolon, TokenNewline, tokenStream);
         }
         /* Catch any top level function defintions; they need to be stored
            in the symbol table before anything is allowed to execute. */
-        if (R_OK == result && tmp && FunctionNode == tmp->Type) {
+        if (R_Success == result && tmp && FunctionNode == tmp->Type) {
             result = AstAppendChild(functionDefs, tmp);
         }
-        else if (R_OK == result && tmp && FunctionNode != tmp->Type) {
+        else if (R_Success == result && tmp && FunctionNode != tmp->Type) {
             result = AstAppendChild(program, tmp);
         }
-        if (R_OK != result) {
+        if (R_Success != result) {
             goto parse_error_cleanup;
         }
     }
@@ -1285,7 +1358,7 @@ int ParseTokenStream(struct ParsedTrees *parsedTrees, struct TokenStream *tokenS
     parsedTrees->Classes = classes;
     parsedTrees->TopLevelFunctions = functionDefs;
     parsedTrees->Program = program;
-    return R_OK;
+    return R_Success;
 
 parse_error_cleanup:
     return result;
@@ -1294,37 +1367,45 @@ parse_error_cleanup:
 /************************ Public Functions **************************/
 
 int ParseThing(struct Ast **out_ast, struct TokenStream *tokenStream) {
-    int result;
-    struct Ast *out;
-    result = ParseImport(&out, tokenStream);
-    if (R_OK == result) {
-        *out_ast = out;
-        return R_OK;
-    }
-    result = ParseClass(&out, tokenStream);
-    if (R_OK == result) {
-        *out_ast = out;
-        return R_OK;
-    }
-    return ParseStmt(out_ast, tokenStream);
+    switch (TOKEN_STREAM_CURRENT(tokenStream)->Type) {
+        default:
+            return ParseStmt(out_ast, tokenStream);
+        case TokenImport:
+            return ParseImport(out_ast, tokenStream);
+        case TokenClass:
+            return ParseClass(out_ast, tokenStream);
+    }
 }
 
 int Parse(struct ParsedTrees *parsedTrees, struct Lexer *lexer) {
     struct TokenStream *tokenStream;
+    struct AstArena *previousArena;
     int result;
     if (!parsedTrees || !lexer) {
         return R_InvalidArgument;
     }
     tokenStream = malloc(sizeof *tokenStream);
     result = TokenStreamMake(tokenStream, lexer);
-    if (R_OK != result) {
+    if (R_Success != result) {
+        free(tokenStream);
         return result;
     }
 
+    AstArenaMake(&parsedTrees->Arena);
+    previousArena = AstArenaUse(&parsedTrees->Arena);
     result = ParseTokenStream(parsedTrees, tokenStream);
-    if (R_OK != result) {
+    AstArenaUse(previousArena);
+    if (R_Success != result) {
         puts("Parse error!");
+        /* Whatever was parsed lives in the arena, so the trees go with
+           it. */
+        AstArenaFree(&parsedTrees->Arena);
+        parsedTrees->Imports = NULL;
+        parsedTrees->Classes = NULL;
+        parsedTrees->TopLevelFunctions = NULL;
+        parsedTrees->Program = NULL;
         TokenStreamFree(tokenStream);
+        free(tokenStream);
         return result;
     }
     result = TokenStreamFree(tokenStream);
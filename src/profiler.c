@@ -0,0 +1,279 @@
+#include "profiler.h"
+#include "result.h"
+
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#define PROFILER_MAX_SAMPLES (1U << 18)
+#define PROFILER_MAX_FRAMES (1U << 21)
+#define PROFILER_NAME_LENGTH 256U
+
+__thread struct ProfilerThread g_ProfilerThread;
+int g_ProfilerActive;
+
+struct ProfilerSample {
+    struct Ast *Node;
+    unsigned int FirstFrame;
+    unsigned int NumFrames;
+    /* Set once the handler has filled in the rest. */
+    volatile unsigned int Done;
+};
+
+/* One line of the flat profile. */
+struct ProfilerLine {
+    const char *Filename;
+    int LineNumber;
+    const char *Function;
+    unsigned int Count;
+};
+
+static struct {
+    struct ProfilerSample *Samples;
+    struct Value **Frames;
+    /* Reserved by the handler, these may run past the maximums. */
+    volatile unsigned int NumSamples;
+    volatile unsigned int NumFrames;
+    unsigned int Hz;
+    struct sigaction Previous;
+} Profile;
+
+/* Only touches memory set aside by ProfilerStart, it may interrupt
+   anything. */
+static void ProfilerHandler(int signo) {
+    struct ProfilerThread *thread = &g_ProfilerThread;
+    struct ProfilerSample *sample;
+    unsigned int i, idx, first, depth = thread->Depth;
+    (void)signo;
+    if (depth > PROFILER_MAX_DEPTH) {
+        depth = PROFILER_MAX_DEPTH;
+    }
+    idx = __sync_fetch_and_add(&Profile.NumSamples, 1);
+    if (idx >= PROFILER_MAX_SAMPLES) {
+        return;
+    }
+    sample = &Profile.Samples[idx];
+    first = __sync_fetch_and_add(&Profile.NumFrames, depth);
+    if (first + depth > PROFILER_MAX_FRAMES) {
+        first = depth = 0;
+    }
+    for (i = 0; i < depth; ++i) {
+        Profile.Frames[first + i] = thread->Frames[i];
+    }
+    sample->Node = thread->Node;
+    sample->FirstFrame = first;
+    sample->NumFrames = depth;
+    __sync_synchronize();
+    sample->Done = 1;
+}
+
+static const char *ProfilerBasename(const char *path) {
+    const char *slash;
+    if (!path) {
+        return "?";
+    }
+    slash = strrchr(path, '/');
+    return slash ? slash + 1 : path;
+}
+
+static const char *ProfilerFunctionName(struct Value *function) {
+    if (!function) {
+        return "<top level>";
+    }
+    if (function->IsBuiltInFn) {
+        return function->v.BuiltinFn->Name;
+    }
+    return function->v.Function->Name;
+}
+
+/* Frames are named after the function and the file defining it, names are
+   not unique across modules. */
+static void ProfilerFrameName(struct Value *function, char *buf, size_t length) {
+    struct Ast *body;
+    if (function->IsBuiltInFn) {
+        snprintf(buf, length, "%s (builtin)", function->v.BuiltinFn->Name);
+        return;
+    }
+    body = function->v.Function->Body;
+    if (!body || !body->NumChildren) {
+        snprintf(buf, length, "%s", function->v.Function->Name);
+        return;
+    }
+    snprintf(buf, length, "%s (%s)",
+             function->v.Function->Name,
+             ProfilerBasename(body->Children[0]->SrcLoc.Filename));
+}
+
+static int ProfilerCompareLocations(const void *a, const void *b) {
+    const struct ProfilerLine *lhs = a, *rhs = b;
+    int cmp = strcmp(lhs->Filename, rhs->Filename);
+    if (cmp) {
+        return cmp;
+    }
+    if (lhs->LineNumber != rhs->LineNumber) {
+        return lhs->LineNumber < rhs->LineNumber ? -1 : 1;
+    }
+    return strcmp(lhs->Function, rhs->Function);
+}
+
+static int ProfilerCompareCounts(const void *a, const void *b) {
+    const struct ProfilerLine *lhs = a, *rhs = b;
+    if (lhs->Count != rhs->Count) {
+        return lhs->Count > rhs->Count ? -1 : 1;
+    }
+    return ProfilerCompareLocations(a, b);
+}
+
+static int ProfilerCompareStrings(const void *a, const void *b) {
+    return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+static void ProfilerPrintFlat(FILE *out, unsigned int numSamples) {
+    struct ProfilerLine *lines;
+    struct ProfilerSample *sample;
+    unsigned int i, numLines = 0, total = 0;
+    lines = malloc(sizeof *lines * (numSamples + 1));
+    for (i = 0; i < numSamples; ++i) {
+        sample = &Profile.Samples[i];
+        if (!sample->Done) {
+            continue;
+        }
+        lines[numLines].Filename = sample->Node ? ProfilerBasename(sample->Node->SrcLoc.Filename) : "<native>";
+        lines[numLines].LineNumber = sample->Node ? sample->Node->SrcLoc.LineNumber : 0;
+        lines[numLines].Function = ProfilerFunctionName(sample->NumFrames
+                                                        ? Profile.Frames[sample->FirstFrame + sample->NumFrames - 1]
+                                                        : NULL);
+        lines[numLines].Count = 1;
+        ++numLines;
+    }
+    total = numLines;
+    qsort(lines, numLines, sizeof *lines, ProfilerCompareLocations);
+    /* Merge runs of the same location. */
+    for (i = 1, numLines = total ? 1 : 0; i < total; ++i) {
+        if (0 == ProfilerCompareLocations(&lines[numLines - 1], &lines[i])) {
+            ++lines[numLines - 1].Count;
+        }
+        else {
+            lines[numLines++] = lines[i];
+        }
+    }
+    qsort(lines, numLines, sizeof *lines, ProfilerCompareCounts);
+    fprintf(out, "\nFlat profile, %u samples taken at up to %u a second of CPU time:\n", total, Profile.Hz);
+    fprintf(out, "%8s %8s  %-32s %s\n", "self%", "samples", "location", "function");
+    for (i = 0; i < numLines; ++i) {
+        char location[PROFILER_NAME_LENGTH];
+        snprintf(location, sizeof location, "%s:%d", lines[i].Filename, lines[i].LineNumber);
+        fprintf(out, "%7.2f%% %8u  %-32s %s\n",
+                100.0 * lines[i].Count / total,
+                lines[i].Count,
+                location,
+                lines[i].Function);
+    }
+    if (Profile.NumSamples > PROFILER_MAX_SAMPLES) {
+        fprintf(out, "%u samples were dropped, the buffer was full.\n", Profile.NumSamples - PROFILER_MAX_SAMPLES);
+    }
+    free(lines);
+}
+
+/* One line per distinct stack, `frame;frame;leaf count'. */
+static void ProfilerWriteStacks(FILE *out, unsigned int numSamples) {
+    struct ProfilerSample *sample;
+    char **stacks, name[PROFILER_NAME_LENGTH];
+    char *stack;
+    size_t length, capacity;
+    unsigned int i, j, count, numStacks = 0;
+    stacks = malloc(sizeof *stacks * (numSamples + 1));
+    for (i = 0; i < numSamples; ++i) {
+        sample = &Profile.Samples[i];
+        if (!sample->Done) {
+            continue;
+        }
+        capacity = PROFILER_NAME_LENGTH * (sample->NumFrames + 1);
+        stack = malloc(capacity);
+        length = 0;
+        for (j = 0; j < sample->NumFrames; ++j) {
+            ProfilerFrameName(Profile.Frames[sample->FirstFrame + j], name, sizeof name);
+            length += snprintf(stack + length, capacity - length, "%s;", name);
+        }
+        if (sample->Node) {
+            snprintf(stack + length, capacity - length, "%s:%d",
+                     ProfilerBasename(sample->Node->SrcLoc.Filename),
+                     sample->Node->SrcLoc.LineNumber);
+        }
+        else {
+            snprintf(stack + length, capacity - length, "<native>");
+        }
+        stacks[numStacks++] = stack;
+    }
+    qsort(stacks, numStacks, sizeof *stacks, ProfilerCompareStrings);
+    for (i = 0; i < numStacks; i = j) {
+        for (j = i + 1, count = 1; j < numStacks && 0 == strcmp(stacks[i], stacks[j]); ++j) {
+            ++count;
+        }
+        fprintf(out, "%s %u\n", stacks[i], count);
+    }
+    for (i = 0; i < numStacks; ++i) {
+        free(stacks[i]);
+    }
+    free(stacks);
+}
+
+/*********************** Public Functions ***********************/
+
+int ProfilerStart(unsigned int hz) {
+    struct sigaction action;
+    struct itimerval timer;
+    if (!hz || hz > 1000000) {
+        return R_InvalidArgument;
+    }
+    Profile.Samples = calloc(PROFILER_MAX_SAMPLES, sizeof *Profile.Samples);
+    Profile.Frames = malloc(sizeof *Profile.Frames * PROFILER_MAX_FRAMES);
+    if (!Profile.Samples || !Profile.Frames) {
+        free(Profile.Samples);
+        free(Profile.Frames);
+        return R_AllocFailed;
+    }
+    Profile.NumSamples = 0;
+    Profile.NumFrames = 0;
+    Profile.Hz = hz;
+    memset(&action, 0, sizeof action);
+    action.sa_handler = ProfilerHandler;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    if (0 != sigaction(SIGPROF, &action, &Profile.Previous)) {
+        free(Profile.Samples);
+        free(Profile.Frames);
+        return R_OperationFailed;
+    }
+    timer.it_interval.tv_sec = 0;
+    timer.it_interval.tv_usec = 1000000 / hz;
+    timer.it_value = timer.it_interval;
+    ++g_ProfilerActive;
+    setitimer(ITIMER_PROF, &timer, NULL);
+    return R_Success;
+}
+
+int ProfilerStop(FILE *flat, FILE *stacks) {
+    struct itimerval timer;
+    unsigned int numSamples;
+    if (!Profile.Samples) {
+        return R_InvalidArgument;
+    }
+    memset(&timer, 0, sizeof timer);
+    setitimer(ITIMER_PROF, &timer, NULL);
+    sigaction(SIGPROF, &Profile.Previous, NULL);
+    --g_ProfilerActive;
+    numSamples = Profile.NumSamples < PROFILER_MAX_SAMPLES ? Profile.NumSamples : PROFILER_MAX_SAMPLES;
+    if (flat) {
+        ProfilerPrintFlat(flat, numSamples);
+    }
+    if (stacks) {
+        ProfilerWriteStacks(stacks, numSamples);
+    }
+    free(Profile.Samples);
+    free(Profile.Frames);
+    Profile.Samples = NULL;
+    Profile.Frames = NULL;
+    return R_Success;
+}
@@ -54,7 +54,7 @@ int SymbolTableMakeGlobalScope(struct SymbolTable *table) {
     table->Symbols = SymbolTableAllocSymbols(table->TableLength);
     table->Parent = NULL;
     table->Child = NULL;
-    return R_OK;
+    return R_Success;
 }
 
 int SymbolTableMake(struct SymbolTable *table) {
@@ -65,18 +65,18 @@ int SymbolTableMake(struct SymbolTable *table) {
     table->Symbols = SymbolTableAllocSymbols(table->TableLength);
     table->Parent = NULL;
     table->Child = NULL;
-    return R_OK;
+    return R_Success;
 }
 
 int SymbolTableFree(struct SymbolTable *table) {
     unsigned int i;
-    struct Symbol *symbol;
+    struct Symbol *symbol, *next;
     if (SymbolTableIsInvalid(table)) {
         return R_InvalidArgument;
     }
     for (i = 0; i < table->TableLength; ++i) {
-        symbol = table->Symbols[i];
-        if (symbol) {
+        for (symbol = table->Symbols[i]; symbol; symbol = next) {
+            next = symbol->Next;
             SymbolFree(symbol);
             free(symbol);
         }
@@ -84,7 +84,7 @@ int SymbolTableFree(struct SymbolTable *table) {
     table->Parent = NULL;
     table->Child = NULL;
     free(table->Symbols);
-    return R_OK;
+    return R_Success;
 }
 
 int SymbolTablePushScope(struct SymbolTable **table) {
@@ -98,7 +98,7 @@ int SymbolTablePushScope(struct SymbolTable **table) {
     newScope->Parent = *table;
     (*table)->Child = newScope;
     *table = newScope;
-    return R_OK;
+    return R_Success;
 }
 
 int SymbolTablePopScope(struct SymbolTable **table) {
@@ -112,13 +112,13 @@ int SymbolTablePopScope(struct SymbolTable **table) {
     (*table)->Child = NULL;
     SymbolTableFree(oldScope);
     free(oldScope);
-    return R_OK;
+    return R_Success;
 }
 
 int SymbolTableAssign(struct SymbolTable *table, struct Value *value, char *key, int isMutable, struct SrcLoc srcLoc) {
     struct Symbol *symbol;
     int result = SymbolTableInsert(table, value, key, isMutable, srcLoc);
-    if (R_OK == result) {
+    if (R_Success == result) {
         return result;
     }
     result = SymbolTableFindLocal(table, key, &symbol);
@@ -138,17 +138,20 @@ int SymbolTableInsert(struct SymbolTable *table, struct Value *value, char *key,
     if (!tmp) {
         symbol = SymbolAlloc(key, value, isMutable, srcLoc);
         table->Symbols[tableIdx] = symbol;
-        return R_OK;
+        return R_Success;
     }
-    while (tmp->Next) {
+    while (1) {
         if (0 == strcmp(tmp->Key, key)) {
             return R_KeyAlreadyInTable;
         }
+        if (!tmp->Next) {
+            break;
+        }
         tmp = tmp->Next;
     }
     symbol = SymbolAlloc(key, value, isMutable, srcLoc);
     tmp->Next = symbol;
-    return R_OK;
+    return R_Success;
 }
 
 int SymbolTableFindLocal(struct SymbolTable *table, char *key, struct Symbol **out_symbol) {
@@ -176,7 +179,7 @@ int SymbolTableFindLocal(struct SymbolTable *table, char *key, struct Symbol **o
     if (out_symbol) {
         *out_symbol = symbol;
     }
-    return R_True;
+    return symbol ? R_True : R_False;
 }
 
 int SymbolTableFindNearest(struct SymbolTable *table, char *key, struct Symbol **out_symbol) {
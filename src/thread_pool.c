@@ -0,0 +1,250 @@
+#include "thread_pool.h"
+#include "result.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define THREAD_POOL_MAX_THREADS 64U
+
+/* What is left of one worker's share of the current job. */
+struct ThreadPoolSlot {
+    pthread_mutex_t Lock;
+    unsigned int Begin;
+    unsigned int End;
+};
+
+struct ThreadPoolWorker {
+    struct ThreadPool *Pool;
+    unsigned int Index;
+};
+
+struct ThreadPool {
+    unsigned int NumThreads;
+    pthread_t *Threads;
+    struct ThreadPoolWorker *Workers;
+    /* One per worker, slot 0 belongs to the calling thread. */
+    struct ThreadPoolSlot *Slots;
+
+    /* Only one job runs at a time. */
+    pthread_mutex_t JobLock;
+
+    pthread_mutex_t Lock;
+    pthread_cond_t WorkReady;
+    pthread_cond_t WorkDone;
+    unsigned long Generation;
+    unsigned int Running;
+    int ShuttingDown;
+
+    ThreadPoolRangeProc_t Proc;
+    void *Context;
+    unsigned int Grain;
+};
+
+/* Set on pool threads, and on the caller while its job runs. */
+static __thread int IsInsideJob;
+
+static int ThreadPoolTake(struct ThreadPool *pool, unsigned int self, unsigned int *out_begin, unsigned int *out_end) {
+    struct ThreadPoolSlot *slot = &pool->Slots[self];
+    int found = 0;
+    pthread_mutex_lock(&slot->Lock);
+    if (slot->Begin < slot->End) {
+        *out_begin = slot->Begin;
+        *out_end = slot->End - slot->Begin > pool->Grain ? slot->Begin + pool->Grain : slot->End;
+        slot->Begin = *out_end;
+        found = 1;
+    }
+    pthread_mutex_unlock(&slot->Lock);
+    return found;
+}
+
+static int ThreadPoolSteal(struct ThreadPool *pool, unsigned int self) {
+    struct ThreadPoolSlot *victim, *mine = &pool->Slots[self];
+    unsigned int i, n = pool->NumThreads + 1, begin, end;
+    for (i = 1; i < n; ++i) {
+        victim = &pool->Slots[(self + i) % n];
+        pthread_mutex_lock(&victim->Lock);
+        if (victim->Begin < victim->End) {
+            end = victim->End;
+            begin = victim->Begin + (end - victim->Begin) / 2;
+            victim->End = begin;
+            pthread_mutex_unlock(&victim->Lock);
+
+            pthread_mutex_lock(&mine->Lock);
+            mine->Begin = begin;
+            mine->End = end;
+            pthread_mutex_unlock(&mine->Lock);
+            return 1;
+        }
+        pthread_mutex_unlock(&victim->Lock);
+    }
+    return 0;
+}
+
+/* Once nothing is left to steal every index has been claimed. */
+static void ThreadPoolWork(struct ThreadPool *pool, unsigned int self) {
+    unsigned int begin, end;
+    do {
+        while (ThreadPoolTake(pool, self, &begin, &end)) {
+            pool->Proc(pool->Context, self, begin, end);
+        }
+    } while (ThreadPoolSteal(pool, self));
+}
+
+static void *ThreadPoolThreadMain(void *arg) {
+    struct ThreadPoolWorker *worker = arg;
+    struct ThreadPool *pool = worker->Pool;
+    unsigned long seen = 0;
+    IsInsideJob = 1;
+    pthread_mutex_lock(&pool->Lock);
+    while (1) {
+        while (!pool->ShuttingDown && seen == pool->Generation) {
+            pthread_cond_wait(&pool->WorkReady, &pool->Lock);
+        }
+        if (pool->ShuttingDown) {
+            break;
+        }
+        seen = pool->Generation;
+        pthread_mutex_unlock(&pool->Lock);
+
+        ThreadPoolWork(pool, worker->Index);
+
+        pthread_mutex_lock(&pool->Lock);
+        if (0 == --pool->Running) {
+            pthread_cond_signal(&pool->WorkDone);
+        }
+    }
+    pthread_mutex_unlock(&pool->Lock);
+    return NULL;
+}
+
+static unsigned int ThreadPoolDefaultSize(void) {
+    char *env = getenv("LITTLE_LANG_THREADS");
+    long n = env ? atol(env) : sysconf(_SC_NPROCESSORS_ONLN);
+    if (n < 1) {
+        n = 1;
+    }
+    if (n > THREAD_POOL_MAX_THREADS) {
+        n = THREAD_POOL_MAX_THREADS;
+    }
+    return n;
+}
+
+static struct ThreadPool *TheSharedPool;
+static pthread_once_t TheSharedPoolOnce = PTHREAD_ONCE_INIT;
+
+static void ThreadPoolMakeShared(void) {
+    if (R_Success != ThreadPoolMake(&TheSharedPool, ThreadPoolDefaultSize() - 1)) {
+        TheSharedPool = NULL;
+    }
+}
+
+/********************* Public Functions **********************/
+
+int ThreadPoolMake(struct ThreadPool **out_pool, unsigned int numThreads) {
+    struct ThreadPool *pool;
+    unsigned int i;
+    if (!out_pool || numThreads >= THREAD_POOL_MAX_THREADS) {
+        return R_InvalidArgument;
+    }
+    pool = calloc(sizeof *pool, 1);
+    pool->Threads = calloc(sizeof *pool->Threads, numThreads + 1);
+    pool->Workers = calloc(sizeof *pool->Workers, numThreads + 1);
+    pool->Slots = calloc(sizeof *pool->Slots, numThreads + 1);
+    for (i = 0; i <= numThreads; ++i) {
+        pthread_mutex_init(&pool->Slots[i].Lock, NULL);
+    }
+    pthread_mutex_init(&pool->JobLock, NULL);
+    pthread_mutex_init(&pool->Lock, NULL);
+    pthread_cond_init(&pool->WorkReady, NULL);
+    pthread_cond_init(&pool->WorkDone, NULL);
+    for (i = 0; i < numThreads; ++i) {
+        pool->Workers[i].Pool = pool;
+        pool->Workers[i].Index = i + 1;
+        if (0 != pthread_create(&pool->Threads[i], NULL, ThreadPoolThreadMain, &pool->Workers[i])) {
+            break;
+        }
+        pool->NumThreads++;
+    }
+    *out_pool = pool;
+    return R_Success;
+}
+
+int ThreadPoolFree(struct ThreadPool *pool) {
+    unsigned int i;
+    if (!pool) {
+        return R_InvalidArgument;
+    }
+    pthread_mutex_lock(&pool->Lock);
+    pool->ShuttingDown = 1;
+    pthread_cond_broadcast(&pool->WorkReady);
+    pthread_mutex_unlock(&pool->Lock);
+    for (i = 0; i < pool->NumThreads; ++i) {
+        pthread_join(pool->Threads[i], NULL);
+    }
+    for (i = 0; i <= pool->NumThreads; ++i) {
+        pthread_mutex_destroy(&pool->Slots[i].Lock);
+    }
+    pthread_mutex_destroy(&pool->JobLock);
+    pthread_mutex_destroy(&pool->Lock);
+    pthread_cond_destroy(&pool->WorkReady);
+    pthread_cond_destroy(&pool->WorkDone);
+    free(pool->Slots);
+    free(pool->Workers);
+    free(pool->Threads);
+    free(pool);
+    return R_Success;
+}
+
+unsigned int ThreadPoolSize(struct ThreadPool *pool) {
+    return pool ? pool->NumThreads + 1 : 1;
+}
+
+int ThreadPoolParallelFor(struct ThreadPool *pool, unsigned int begin, unsigned int end, unsigned int grain, ThreadPoolRangeProc_t proc, void *context) {
+    unsigned int i, n, share;
+    if (!proc || end < begin) {
+        return R_InvalidArgument;
+    }
+    if (begin == end) {
+        return R_Success;
+    }
+    if (!pool || 0 == pool->NumThreads || IsInsideJob || end - begin <= grain) {
+        proc(context, 0, begin, end);
+        return R_Success;
+    }
+    pthread_mutex_lock(&pool->JobLock);
+    IsInsideJob = 1;
+
+    n = pool->NumThreads + 1;
+    share = (end - begin) / n;
+    for (i = 0; i < n; ++i) {
+        pool->Slots[i].Begin = begin + i * share;
+        pool->Slots[i].End = i + 1 == n ? end : begin + (i + 1) * share;
+    }
+    pool->Proc = proc;
+    pool->Context = context;
+    pool->Grain = grain ? grain : 1;
+
+    pthread_mutex_lock(&pool->Lock);
+    pool->Running = pool->NumThreads;
+    pool->Generation++;
+    pthread_cond_broadcast(&pool->WorkReady);
+    pthread_mutex_unlock(&pool->Lock);
+
+    ThreadPoolWork(pool, 0);
+
+    pthread_mutex_lock(&pool->Lock);
+    while (pool->Running) {
+        pthread_cond_wait(&pool->WorkDone, &pool->Lock);
+    }
+    pthread_mutex_unlock(&pool->Lock);
+
+    IsInsideJob = 0;
+    pthread_mutex_unlock(&pool->JobLock);
+    return R_Success;
+}
+
+struct ThreadPool *ThreadPoolShared(void) {
+    pthread_once(&TheSharedPoolOnce, ThreadPoolMakeShared);
+    return TheSharedPool;
+}
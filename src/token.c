@@ -30,7 +30,7 @@ char *parse_escaped_string(char *str) {
             free(old);
             i = 0;
         }
-        if ('"' == *str) {
+        if ('"' == *str || !*str) {
             tmp[i] = 0;
             old = string;
             string = str_cat(string, tmp);
@@ -51,34 +51,43 @@ char *parse_escaped_string(char *str) {
 }
 
 void TokenSetValue(struct Token *token) {
+    /* Numbers are short, copy them so strtol and strtod stop at the end
+       of the view. */
+    char number[64];
+    unsigned int len = token->Length < sizeof number ? token->Length : sizeof number - 1;
     switch (token->Type) {
         default:
             token->v.String = NULL;
             return;
             /* TODO: use something other than strtol and strtod */
         case TokenIntegerConstant:
-            token->v.Integer = strtol(token->TokenStr, NULL, 10);
+            memcpy(number, token->Text, len);
+            number[len] = 0;
+            token->v.Integer = strtol(number, NULL, 10);
             return;
         case TokenRealConstant:
-            token->v.Real = strtod(token->TokenStr, NULL);
+            memcpy(number, token->Text, len);
+            number[len] = 0;
+            token->v.Real = strtod(number, NULL);
             return;
         case TokenStringLiteral:
-            token->v.String = parse_escaped_string(token->TokenStr);
+            token->v.String = parse_escaped_string((char*)token->Text);
             return;
     }
 }
 
-int TokenMake(struct Token *token, enum TokenType type, char *tokenStr, char *filename, int lineNumber, int columnNumber) {
-    if (!token || !tokenStr || !filename) {
+int TokenMake(struct Token *token, enum TokenType type, const char *text, unsigned int length, char *filename, int lineNumber, int columnNumber) {
+    if (!token || !text || !filename) {
         return R_InvalidArgument;
     }
     token->Type = type;
-    token->TokenStr = strdup(tokenStr);
+    token->Text = text;
+    token->Length = length;
     token->SrcLoc.Filename = filename;
     token->SrcLoc.LineNumber = lineNumber;
     token->SrcLoc.ColumnNumber = columnNumber;
     TokenSetValue(token);
-    return R_OK;
+    return R_Success;
 }
 int TokenFree(struct Token *token) {
     if (!token) {
@@ -87,6 +96,11 @@ int TokenFree(struct Token *token) {
     if (TokenStringLiteral == token->Type) {
         free(token->v.String);
     }
-    free(token->TokenStr);
-    return R_OK;
+    return R_Success;
+}
+char *TokenTextDup(struct Token *token) {
+    if (!token) {
+        return NULL;
+    }
+    return strndup(token->Text, token->Length);
 }
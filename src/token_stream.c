@@ -4,6 +4,8 @@
 
 #include <stdlib.h>
 
+#define TOKEN_STREAM_INITIAL_CAPACITY 64U
+
 /*********************** Helpers ************************/
 
 int TokenStreamIsValid(struct TokenStream *tokenStream) {
@@ -14,39 +16,39 @@ int TokenStreamIsInvalid(struct TokenStream *tokenStream) {
     return !TokenStreamIsValid(tokenStream);
 }
 
-struct Node *NodeMake(struct Token *token) {
-    struct Node *node = malloc(sizeof *node);
-    node->Prev = NULL;
-    node->Token = token;
-    node->Next = NULL;
-    return node;
-}
-
-void NodeFree(struct Node *node) {
-    TokenFree(node->Token);
+/* Returns a slot at the end of the stream for the next token. */
+struct Token *TokenStreamGrow(struct TokenStream *tokenStream) {
+    if (tokenStream->Count == tokenStream->Capacity) {
+        tokenStream->Capacity = tokenStream->Capacity ? 2 * tokenStream->Capacity : TOKEN_STREAM_INITIAL_CAPACITY;
+        tokenStream->Tokens = realloc(tokenStream->Tokens, sizeof *tokenStream->Tokens * tokenStream->Capacity);
+    }
+    return &tokenStream->Tokens[tokenStream->Count];
 }
 
 int TokenStreamREPLNextToken(struct TokenStream *tokenStream) {
-    int result;
-    struct Token *token; 
-    result = LexerNextToken(tokenStream->Lexer, &token);
-    if (R_OK != result) {
-        return result;
-    }
-    result = TokenStreamAppend(tokenStream, token);
-    if (R_OK != result) {
+    int result = LexerNextTokenInPlace(tokenStream->Lexer, TokenStreamGrow(tokenStream));
+    if (R_Success != result) {
         return result;
     }
-    return R_OK;
+    tokenStream->Count++;
+    return R_Success;
 }
 
 int TokenStreamAddExistingTokens(struct TokenStream *tokenStream) {
     int result;
     struct Token *token;
-    while (R_OK == (result = LexerNextToken(tokenStream->Lexer, &token))) {
-        result = TokenStreamAppend(tokenStream, token);
-        if (R_EndOfTokenStream == result) {
-            result = R_OK;
+    /* A token is several times the size of its text, so start from a
+       low guess and let TokenStreamGrow double the array from there. */
+    tokenStream->Capacity = tokenStream->Lexer->Length / 16 + TOKEN_STREAM_INITIAL_CAPACITY;
+    tokenStream->Tokens = malloc(sizeof *tokenStream->Tokens * tokenStream->Capacity);
+    while (1) {
+        token = TokenStreamGrow(tokenStream);
+        result = LexerNextTokenInPlace(tokenStream->Lexer, token);
+        if (R_Success != result) {
+            break;
+        }
+        tokenStream->Count++;
+        if (TokenEOS == token->Type) {
             break;
         }
     }
@@ -59,9 +61,10 @@ int TokenStreamMake(struct TokenStream *tokenStream, struct Lexer *lexer) {
     if (!tokenStream) {
         return R_InvalidArgument;
     }
-    tokenStream->Head = NULL;
-    tokenStream->Tail = tokenStream->Head;
-    tokenStream->Current = tokenStream->Head;
+    tokenStream->Tokens = NULL;
+    tokenStream->Count = 0;
+    tokenStream->Capacity = 0;
+    tokenStream->Current = 0;
     tokenStream->Lexer = lexer;
     if (lexer->Length > 0) {
         TokenStreamAddExistingTokens(tokenStream);
@@ -69,60 +72,47 @@ int TokenStreamMake(struct TokenStream *tokenStream, struct Lexer *lexer) {
     else if (lexer->REPL) { /* Setup the first token. */
         TokenStreamAdvance(tokenStream);
     }
-    return R_OK;
+    return R_Success;
 }
 
 int TokenStreamFree(struct TokenStream *tokenStream) {
-    struct Node *node, *next;
+    unsigned int i;
     if (TokenStreamIsInvalid(tokenStream)) {
         return R_InvalidArgument;
     }
-    node = tokenStream->Head;
-    while (node) {
-        next = node->Next;
-        NodeFree(node);
-        free(node);
-        node = next;
+    for (i = 0; i < tokenStream->Count; ++i) {
+        TokenFree(&tokenStream->Tokens[i]);
     }
-    tokenStream->Head = NULL;
-    tokenStream->Current = NULL;
-    tokenStream->Tail = NULL;
+    free(tokenStream->Tokens);
+    tokenStream->Tokens = NULL;
+    tokenStream->Count = 0;
+    tokenStream->Capacity = 0;
+    tokenStream->Current = 0;
     tokenStream->Lexer = NULL;
-    return R_OK;
+    return R_Success;
 }
 
 int TokenStreamAppend(struct TokenStream *tokenStream, struct Token *token) {
-    struct Node *newNode;
     if (TokenStreamIsInvalid(tokenStream) || !token) {
         return R_InvalidArgument;
     }
-
-    newNode = NodeMake(token);
-    if (!tokenStream->Head) {
-        tokenStream->Head = newNode;
-        tokenStream->Tail = tokenStream->Head;
-        tokenStream->Current = tokenStream->Head;
-    }
-    else {
-        tokenStream->Tail->Next = newNode;
-        newNode->Prev = tokenStream->Tail;
-        tokenStream->Tail = newNode;
-    }
+    *TokenStreamGrow(tokenStream) = *token;
+    tokenStream->Count++;
     if (TokenEOS == token->Type) {
         return R_EndOfTokenStream;
     }
-    return R_OK;
+    return R_Success;
 }
 int TokenStreamAdvance(struct TokenStream *tokenStream) {
     int result, firstTime;
     if (TokenStreamIsInvalid(tokenStream)) {
         return R_InvalidArgument;
     }
-    if (!tokenStream->Current || !tokenStream->Current->Next) {
+    if (tokenStream->Current + 1 >= tokenStream->Count) {
         if (tokenStream->Lexer->REPL) {
-            firstTime = !tokenStream->Head;
+            firstTime = 0 == tokenStream->Count;
             result = TokenStreamREPLNextToken(tokenStream);
-            if (firstTime) {
+            if (firstTime || R_Success != result) {
                 return result;
             }
         }
@@ -130,16 +120,16 @@ int TokenStreamAdvance(struct TokenStream *tokenStream) {
             return R_OperationFailed;
         }
     }
-    tokenStream->Current = tokenStream->Current->Next;
-    return R_OK;
+    tokenStream->Current++;
+    return R_Success;
 }
 int TokenStreamRewind(struct TokenStream *tokenStream) {
     if (TokenStreamIsInvalid(tokenStream)) {
         return R_InvalidArgument;
     }
-    if (!tokenStream->Current || !tokenStream->Current->Prev) {
+    if (0 == tokenStream->Current || tokenStream->Current >= tokenStream->Count) {
         return R_OperationFailed;
     }
-    tokenStream->Current = tokenStream->Current->Prev;
-    return R_OK;
+    tokenStream->Current--;
+    return R_Success;
 }
@@ -0,0 +1,233 @@
+#include "tracer.h"
+#include "result.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+int g_TracerEnabled;
+
+struct TraceFrame {
+    struct TraceCounter *Counter;
+    unsigned long long Start;
+    /* Time spent in the calls this one made. */
+    unsigned long long Children;
+    int Recursive;
+};
+
+/* Calls nested deeper than TRACER_MAX_DEPTH are counted but not timed. */
+static __thread struct {
+    struct TraceFrame Frames[TRACER_MAX_DEPTH];
+    unsigned int Depth;
+} TraceStack;
+
+static struct TraceCounter *TraceCounters;
+static pthread_mutex_t TraceCountersLock = PTHREAD_MUTEX_INITIALIZER;
+
+static unsigned long long TracerNow(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+}
+
+static const char *TracerBasename(const char *path) {
+    const char *slash = strrchr(path, '/');
+    return slash ? slash + 1 : path;
+}
+
+/* Counters are made once per function, the first thread to call it wins. */
+static struct TraceCounter *TracerCounterFor(struct TraceCounter **slot, const char *name, const char *filename) {
+    struct TraceCounter *counter;
+    pthread_mutex_lock(&TraceCountersLock);
+    counter = *slot;
+    if (!counter) {
+        counter = calloc(1, sizeof *counter);
+        counter->Name = strdup(name);
+        counter->Filename = filename ? strdup(TracerBasename(filename)) : NULL;
+        counter->Slot = slot;
+        counter->Next = TraceCounters;
+        TraceCounters = counter;
+        __sync_synchronize();
+        *slot = counter;
+    }
+    pthread_mutex_unlock(&TraceCountersLock);
+    return counter;
+}
+
+static void TracerEnter(struct TraceCounter *counter) {
+    struct TraceFrame *frame;
+    unsigned int i, depth = TraceStack.Depth++;
+    __sync_fetch_and_add(&counter->Calls, 1);
+    if (depth >= TRACER_MAX_DEPTH) {
+        return;
+    }
+    frame = &TraceStack.Frames[depth];
+    frame->Counter = counter;
+    frame->Children = 0;
+    frame->Recursive = 0;
+    for (i = 0; i < depth; ++i) {
+        if (TraceStack.Frames[i].Counter == counter) {
+            frame->Recursive = 1;
+            break;
+        }
+    }
+    frame->Start = TracerNow();
+}
+
+static void TracerFreeCounters(void) {
+    struct TraceCounter *counter, *next;
+    pthread_mutex_lock(&TraceCountersLock);
+    for (counter = TraceCounters; counter; counter = next) {
+        next = counter->Next;
+        if (counter->Slot) {
+            *counter->Slot = NULL;
+        }
+        free(counter->Name);
+        free(counter->Filename);
+        free(counter);
+    }
+    TraceCounters = NULL;
+    pthread_mutex_unlock(&TraceCountersLock);
+}
+
+static int TracerCompareSelfTime(const void *a, const void *b) {
+    const struct TraceCounter *lhs = *(struct TraceCounter * const *)a;
+    const struct TraceCounter *rhs = *(struct TraceCounter * const *)b;
+    if (lhs->SelfTime != rhs->SelfTime) {
+        return lhs->SelfTime > rhs->SelfTime ? -1 : 1;
+    }
+    if (lhs->Calls != rhs->Calls) {
+        return lhs->Calls > rhs->Calls ? -1 : 1;
+    }
+    return strcmp(lhs->Name, rhs->Name);
+}
+
+static void TracerPrintTable(FILE *out, struct TraceCounter **counters, unsigned int numCounters) {
+    unsigned long long calls = 0, time = 0;
+    unsigned int i;
+    char name[256];
+    for (i = 0; i < numCounters; ++i) {
+        calls += counters[i]->Calls;
+        time += counters[i]->SelfTime;
+    }
+    fprintf(out, "\nTraced %llu calls to %u functions:\n", calls, numCounters);
+    fprintf(out, "%7s %10s %12s %12s  %s\n", "self%", "calls", "self ms", "total ms", "function");
+    for (i = 0; i < numCounters; ++i) {
+        snprintf(name, sizeof name, "%s (%s)",
+                 counters[i]->Name,
+                 counters[i]->Filename ? counters[i]->Filename : "builtin");
+        fprintf(out, "%6.2f%% %10llu %12.3f %12.3f  %s\n",
+                time ? 100.0 * counters[i]->SelfTime / time : 0.0,
+                counters[i]->Calls,
+                counters[i]->SelfTime / 1e6,
+                counters[i]->TotalTime / 1e6,
+                name);
+    }
+}
+
+static void TracerWriteString(FILE *out, const char *str) {
+    fputc('"', out);
+    for (; *str; ++str) {
+        if ('"' == *str || '\\' == *str) {
+            fputc('\\', out);
+        }
+        if ((unsigned char)*str < ' ') {
+            fprintf(out, "\\u%04x", *str);
+        }
+        else {
+            fputc(*str, out);
+        }
+    }
+    fputc('"', out);
+}
+
+static void TracerWriteJson(FILE *out, struct TraceCounter **counters, unsigned int numCounters) {
+    unsigned int i;
+    fprintf(out, "[");
+    for (i = 0; i < numCounters; ++i) {
+        fprintf(out, "%s\n  {\"function\": ", i ? "," : "");
+        TracerWriteString(out, counters[i]->Name);
+        fprintf(out, ", \"file\": ");
+        if (counters[i]->Filename) {
+            TracerWriteString(out, counters[i]->Filename);
+        }
+        else {
+            fprintf(out, "null");
+        }
+        fprintf(out, ", \"calls\": %llu, \"self_ns\": %llu, \"total_ns\": %llu}",
+                counters[i]->Calls,
+                counters[i]->SelfTime,
+                counters[i]->TotalTime);
+    }
+    fprintf(out, "\n]\n");
+}
+
+/*********************** Public Functions ***********************/
+
+void TracerEnterFunction(struct Function *function) {
+    struct TraceCounter *counter = function->Counter;
+    struct Ast *body = function->Body;
+    if (!counter) {
+        counter = TracerCounterFor(&function->Counter, function->Name,
+                                   body && body->NumChildren ? body->Children[0]->SrcLoc.Filename : NULL);
+    }
+    TracerEnter(counter);
+}
+
+void TracerEnterBuiltinFn(struct BuiltinFn *function) {
+    struct TraceCounter *counter = function->Counter;
+    if (!counter) {
+        counter = TracerCounterFor(&function->Counter, function->Name, NULL);
+    }
+    TracerEnter(counter);
+}
+
+void TracerLeave(void) {
+    struct TraceFrame *frame;
+    unsigned long long elapsed;
+    unsigned int depth = --TraceStack.Depth;
+    if (depth >= TRACER_MAX_DEPTH) {
+        return;
+    }
+    frame = &TraceStack.Frames[depth];
+    elapsed = TracerNow() - frame->Start;
+    __sync_fetch_and_add(&frame->Counter->SelfTime, elapsed - frame->Children);
+    if (!frame->Recursive) {
+        __sync_fetch_and_add(&frame->Counter->TotalTime, elapsed);
+    }
+    if (depth) {
+        TraceStack.Frames[depth - 1].Children += elapsed;
+    }
+}
+
+int TracerStart(void) {
+    g_TracerEnabled = 1;
+    return R_Success;
+}
+
+int TracerStop(FILE *table, FILE *json) {
+    struct TraceCounter **counters, *counter;
+    unsigned int i, numCounters = 0;
+    if (!g_TracerEnabled) {
+        return R_InvalidArgument;
+    }
+    g_TracerEnabled = 0;
+    for (counter = TraceCounters; counter; counter = counter->Next) {
+        ++numCounters;
+    }
+    counters = malloc(sizeof *counters * (numCounters + 1));
+    for (i = 0, counter = TraceCounters; counter; counter = counter->Next) {
+        counters[i++] = counter;
+    }
+    qsort(counters, numCounters, sizeof *counters, TracerCompareSelfTime);
+    if (table) {
+        TracerPrintTable(table, counters, numCounters);
+    }
+    if (json) {
+        TracerWriteJson(json, counters, numCounters);
+    }
+    free(counters);
+    TracerFreeCounters();
+    return R_Success;
+}
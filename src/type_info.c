@@ -28,7 +28,7 @@ int TypeInfoResizeMembers(struct TypeInfo *typeInfo) {
     if (!typeInfo->Members) {
         return R_AllocFailed;
     }
-    return R_OK;
+    return R_Success;
 }
 
 
@@ -51,21 +51,17 @@ int TypeInfoMake(struct TypeInfo *typeInfo, enum TypeInfoType type, struct TypeI
     typeInfo->MethodTable = methodTable;
     typeInfo->CapMembers = MEMBERS_BASE_LENGTH;
     typeInfo->NumMembers = 0;
-    return R_OK;
+    return R_Success;
 }
 int TypeInfoFree(struct TypeInfo *typeInfo) {
-    unsigned int i;
     if (TypeInfoIsInvalid(typeInfo)) {
         return R_InvalidArgument;
     }
 
-    for(i = 0; i < typeInfo->CapMembers; ++i) {
-        AstFree(typeInfo->Members[i]);
-        free(typeInfo->Members[i]);
-    }
+    /* The members belong to the arena of the module they were parsed in. */
     free(typeInfo->Members);
     free(typeInfo->TypeName);
-    return R_OK;
+    return R_Success;
 }
 
 int TypeInfoInsertMethod(struct TypeInfo *typeInfo, struct Value *method, struct SrcLoc srcLoc) {
@@ -91,12 +87,12 @@ int TypeInfoInsertMember(struct TypeInfo *typeInfo, struct Ast *ast) {
     }
     if (typeInfo->NumMembers + 1 >= typeInfo->CapMembers) {
         result = TypeInfoResizeMembers(typeInfo);
-        if (R_OK != result) {
+        if (R_Success != result) {
             return result;
         }
     }
     typeInfo->Members[typeInfo->NumMembers++] = ast;
-    return R_OK;
+    return R_Success;
 }
 
 int TypeInfoLookupMethod(struct TypeInfo *typeInfo, char *methodName, struct Value **out_method) {
@@ -108,7 +104,7 @@ int TypeInfoLookupMethod(struct TypeInfo *typeInfo, char *methodName, struct Val
         SymbolTableFindLocal(typeInfo->MethodTable, methodName, &out);
         if (out) {
             *out_method = out->Value;
-            return R_OK;
+            return R_Success;
         }
         if (&g_TheBaseObjectTypeInfo == typeInfo) {
             break;
@@ -126,7 +122,7 @@ int TypeInfoHasMethod(struct TypeInfo *typeInfo, char *methodName) {
     }
     SymbolTableFindLocal(typeInfo->MethodTable, methodName, &out);
     if (out) {
-        return R_OK;
+        return R_Success;
     }
     return R_MethodNotFound;
 }
@@ -55,7 +55,7 @@ int TypeTableMake(struct TypeTable *table, const unsigned int tableMaxLen) {
     if (!table->Entries) {
         return R_AllocFailed;
     }
-    return R_OK;
+    return R_Success;
 }
 int TypeTableFree(struct TypeTable *table) {
     struct TypeTableEntry *entry;
@@ -70,7 +70,7 @@ int TypeTableFree(struct TypeTable *table) {
         }
     }
     free(table->Entries);
-    return R_OK;
+    return R_Success;
 }
 int TypeTableInsert(struct TypeTable *table, struct TypeInfo *typeInfo) {
     struct TypeTableEntry *entry, *tmp;
@@ -89,7 +89,7 @@ int TypeTableInsert(struct TypeTable *table, struct TypeInfo *typeInfo) {
     tmp = table->Entries[tableIdx];
     if (!tmp) {
         table->Entries[tableIdx] = entry;
-        return R_OK;
+        return R_Success;
     }
     while (tmp->Next) {
         if (0 == strcmp(tmp->Key, typeInfo->TypeName)) {
@@ -98,7 +98,7 @@ int TypeTableInsert(struct TypeTable *table, struct TypeInfo *typeInfo) {
         tmp = tmp->Next;
     }
     tmp->Next = entry;
-    return R_OK;
+    return R_Success;
 }
 int TypeTableFind(struct TypeTable *table, char *key, struct TypeInfo **out_typeInfo) {
     struct TypeTableEntry *entry;
@@ -2,8 +2,10 @@
 #include "globals.h"
 #include "result.h"
 #include "symbol_table.h"
+#include "tracer.h"
 
 #include "runtime/gc.h"
+#include "runtime/generator.h"
 
 #include "helpers/strings.h"
 
@@ -15,25 +17,31 @@ void ValueDefaults(struct Value *value) {
     value->IsBuiltInFn = 0;
     value->IsPassByReference = 0;
     value->IsSymbol = 0;
+    value->Visited = 0;
+    value->IsPtrToValue = 0;
 }
 
 int BuiltinFnFree(struct BuiltinFn *bifn) {
     if (!bifn) {
         return R_InvalidArgument;
     }
+    if (bifn->Counter) {
+        bifn->Counter->Slot = NULL;
+    }
     free(bifn->Name);
-    return R_OK;
+    return R_Success;
 }
 int FunctionFree(struct Function *function) {
     if (!function) {
         return R_InvalidArgument;
     }
+    /* Params and Body belong to the arena of the module they were parsed
+       in. */
+    if (function->Counter) {
+        function->Counter->Slot = NULL;
+    }
     free(function->Name);
-    AstFree(function->Params);
-    free(function->Params);
-    AstFree(function->Body);
-    free(function->Body);
-    return R_OK;
+    return R_Success;
 }
 int ValueFreeUserObject(struct Value *object) {
     int result = SymbolTableFree(object->Members);
@@ -71,7 +79,7 @@ int ValueFree(struct Value *value) {
         return R_InvalidArgument;
     }
     if (value->IsSymbol || value->IsPtrToValue) {
-        return R_OK;
+        return R_Success;
     }
     else if (value->IsBuiltInFn) {
         result = BuiltinFnFree(value->v.BuiltinFn);
@@ -85,7 +93,7 @@ int ValueFree(struct Value *value) {
             case TypeBoolean:
             case TypeInteger:
             case TypeReal:
-                return R_OK;
+                return R_Success;
             case TypeVector:
                 return ValueFreeLLVector(value);
             case TypeUserObject:
@@ -94,6 +102,8 @@ int ValueFree(struct Value *value) {
                 return LLStringFree(value->v.String);
             case TypeFunction:
                 return FunctionFree(value->v.Function);
+            case TypeGenerator:
+                return GeneratorFree(value->v.Generator);
         }
     }
     return R_OperationFailed;
@@ -110,9 +120,11 @@ int ValueDuplicate(struct Value **out_value, struct Value *toDup) {
     else {
         out = ValueAlloc();
         memcpy(out, toDup, sizeof *out);
+        /* toDup may be a constant, marked once and never swept. */
+        out->Visited = 0;
         *out_value = out;
     }
-    return R_OK;
+    return R_Success;
 }
 
 int BuiltinFnMake(struct BuiltinFn **out_builtin_fn, char *name, unsigned int numArgs, int isVarArgs, BuiltinFnProc_t fn) {
@@ -125,8 +137,9 @@ int BuiltinFnMake(struct BuiltinFn **out_builtin_fn, char *name, unsigned int nu
     bifn->NumArgs = numArgs;
     bifn->IsVarArgs = isVarArgs;
     bifn->Fn = fn;
+    bifn->Counter = NULL;
     *out_builtin_fn = bifn;
-    return R_OK;
+    return R_Success;
 }
 int FunctionMake(struct Function **out_function, char *name, unsigned int numArgs, int isVarArgs, struct Ast *params, struct Ast *body) {
     struct Function *function;
@@ -142,8 +155,10 @@ int FunctionMake(struct Function **out_function, char *name, unsigned int numArg
     function->IsVarArgs = isVarArgs;
     function->Params = params;
     function->Body = body;
+    function->IsGenerator = 0;
+    function->Counter = NULL;
     *out_function = function;
-    return R_OK;
+    return R_Success;
 }
 
 int ValueAllocInteger(struct Value **out_value, int integer, ValueAllocator allocator) {
@@ -155,7 +170,7 @@ int ValueAllocInteger(struct Value **out_value, int integer, ValueAllocator allo
     value->TypeInfo = &g_TheIntegerTypeInfo;
     value->v.Integer = integer;
     *out_value = value;
-    return R_OK;
+    return R_Success;
 }
 int ValueMakeIntegerLiteral(struct Value **out_value, int integer) {
     return ValueAllocInteger(out_value, integer, ValueAllocNoGC);
@@ -173,7 +188,7 @@ int ValueAllocReal(struct Value **out_value, double real, ValueAllocator allocat
     value->TypeInfo = &g_TheRealTypeInfo;
     value->v.Real = real;
     *out_value = value;
-    return R_OK;
+    return R_Success;
 }
 int ValueMakeRealLiteral(struct Value **out_value, double real) {
     return ValueAllocReal(out_value, real, ValueAllocNoGC);
@@ -188,7 +203,7 @@ int ValueMakeSingleton(struct Value *value, struct TypeInfo *typeInfo) {
     ValueDefaults(value);
     value->TypeInfo = typeInfo;
     value->IsPassByReference = 1;
-    return R_OK;
+    return R_Success;
 }
 int ValueMakeObject(struct Value **out_value, struct TypeInfo *typeInfo) {
     struct Value *value;
@@ -200,7 +215,7 @@ int ValueMakeObject(struct Value **out_value, struct TypeInfo *typeInfo) {
     value->TypeInfo = typeInfo;
     value->IsPassByReference = 1;
     *out_value = value;
-    return R_OK;
+    return R_Success;
 }
 int ValueMakeType(struct Value **out_value, struct TypeInfo *typeInfo) {
     struct Value *value;
@@ -212,7 +227,7 @@ int ValueMakeType(struct Value **out_value, struct TypeInfo *typeInfo) {
     value->v.MetaTypeInfo = typeInfo;
     value->IsPassByReference = 1;
     *out_value = value;
-    return R_OK;
+    return R_Success;
     
 }
 int ValueAllocLLString(struct Value **out_value, struct LLString *llString, ValueAllocator allocator) {
@@ -225,7 +240,7 @@ int ValueAllocLLString(struct Value **out_value, struct LLString *llString, Valu
     value->IsPassByReference = 1;
     value->v.String = llString;
     *out_value = value;
-    return R_OK;
+    return R_Success;
 }
 int ValueMakeLLStringLiteral(struct Value **out_value, struct LLString *llString) {
     return ValueAllocLLString(out_value, llString, ValueAllocNoGC);
@@ -244,7 +259,7 @@ int ValueAllocLLStringWithCString(struct Value **out_value, char *cString, Value
     value->v.String = malloc(sizeof *value->v.String);
     LLStringMake(value->v.String, cString);
     *out_value = value;
-    return R_OK;
+    return R_Success;
 }
 int ValueMakeLLStringLiteralWithCString(struct Value **out_value, char *cString) {
     return ValueAllocLLStringWithCString(out_value, cString, ValueAllocNoGC);
@@ -258,8 +273,10 @@ int ValueMakeFunction(struct Value *value, struct Function *function) {
     }
     ValueDefaults(value);
     value->TypeInfo = &g_TheFunctionTypeInfo;
+    /* A copy would free the function along with itself. */
+    value->IsPassByReference = 1;
     value->v.Function = function;
-    return R_OK;
+    return R_Success;
 }
 
 int ValueMakeBuiltinFn(struct Value *value, struct BuiltinFn *builtinFn) {
@@ -269,8 +286,9 @@ int ValueMakeBuiltinFn(struct Value *value, struct BuiltinFn *builtinFn) {
     ValueDefaults(value);
     value->TypeInfo = &g_TheBuiltinFnTypeInfo;
     value->IsBuiltInFn = 1;
+    value->IsPassByReference = 1;
     value->v.BuiltinFn = builtinFn;
-    return R_OK;
+    return R_Success;
 }
 
 /* This needs to be deperecated. */
@@ -280,7 +298,7 @@ char *ValueToString(struct Value *value) {
         return ValueToString(value->v.Symbol->Value);
     }
     if (value->IsPtrToValue) {
-        return ValueToString(*value->v.PtrToValue);
+        return ValueToString(VALUE_ELEMENT(value));
     }
     if (!value || !value->TypeInfo) {
         return NULL;
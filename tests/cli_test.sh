@@ -0,0 +1,214 @@
+#!/bin/bash
+
+# Runs the interpreter with the command line options the little-lang tests
+# can not pass themselves and checks what it prints or leaves behind.
+# Build the interpreter first, then run this from tests/.
+
+TESTS_DIR=$(cd "$(dirname "$0")" && pwd)
+LITTLE_LANG=${LITTLE_LANG:-$TESTS_DIR/../bin/little-lang}
+WORK_DIR=$(mktemp -d)
+trap 'rm -rf "$WORK_DIR"' EXIT
+failures=0
+
+# check <description> <command...>
+check() {
+    local description=$1
+    shift
+    if "$@"; then
+        echo "( $description ): PASSED"
+    else
+        echo "( $description ): FAILED"
+        failures=$((failures + 1))
+    fi
+}
+
+inode() {
+    stat -c %i "$1"
+}
+
+test_module_cache() {
+    local dir=$WORK_DIR/module_cache before
+    mkdir -p "$dir" && cd "$dir" || return
+    cat > m.ll <<'EOF'
+def add(a, b) {
+    a + b * 2
+}
+class Point {
+    mut x = 1
+    def get() { self.x }
+}
+mut p = Point.new()
+for mut i = 0; i < 3; i = i + 1 {
+    if i == 1 { print("one") } else { print(add(i, p.get())) }
+}
+EOF
+    "$LITTLE_LANG" m.ll > expected.txt
+    check "a run writes the module's cache" test -f m.llc
+    check "the cache gets the permissions of any new file" test "$(stat -c %a m.ll)" = "$(stat -c %a m.llc)"
+
+    before=$(inode m.llc)
+    "$LITTLE_LANG" m.ll > out.txt
+    check "trees read from the cache run the same" cmp -s expected.txt out.txt
+    check "a matching cache is read, not written again" test "$before" = "$(inode m.llc)"
+
+    before=$(inode m.llc)
+    touch -d '+1 minute' m.ll
+    "$LITTLE_LANG" m.ll > out.txt
+    check "a newer source is parsed again" test "$before" != "$(inode m.llc)"
+
+    before=$(inode m.llc)
+    echo 'print("appended")' >> m.ll
+    "$LITTLE_LANG" m.ll > out.txt
+    check "a source of another size is parsed again" test "$before" != "$(inode m.llc)"
+    check "the appended statement runs" grep -q appended out.txt
+
+    # Same size and mtime, only the hash can tell.
+    cp -p m.ll old.ll
+    sed -i 's/appended/replaced/' m.ll
+    touch -r old.ll m.ll
+    "$LITTLE_LANG" m.ll > out.txt
+    check "a source with other contents is parsed again" grep -q replaced out.txt
+    sed -i '$d' m.ll
+
+    "$LITTLE_LANG" m.ll > expected.txt
+    truncate -s 100 m.llc
+    "$LITTLE_LANG" m.ll > out.txt
+    check "a truncated cache falls back to parsing" cmp -s expected.txt out.txt
+
+    # The last word belongs to the last node read.
+    printf '\xde\xad\xbe\xef' | dd of=m.llc bs=1 seek=$(($(stat -c %s m.llc) - 4)) conv=notrunc 2>/dev/null
+    before=$(inode m.llc)
+    "$LITTLE_LANG" m.ll > out.txt
+    check "a corrupt cache falls back to parsing" cmp -s expected.txt out.txt
+    check "a corrupt cache is written again" test "$before" != "$(inode m.llc)"
+
+    rm -f m.llc
+    "$LITTLE_LANG" --no-module-cache m.ll > out.txt
+    check "--no-module-cache writes no cache" test ! -e m.llc
+    echo garbage > m.llc
+    before=$(inode m.llc)
+    "$LITTLE_LANG" --no-module-cache m.ll > out.txt
+    check "--no-module-cache runs without reading the cache" cmp -s expected.txt out.txt
+    check "--no-module-cache leaves the cache alone" test "$before" = "$(inode m.llc)"
+}
+
+# count <line> <file>
+count() {
+    grep -cx "$1" "$2"
+}
+
+# line_of <line> <file>
+line_of() {
+    grep -nx -m 1 "$1" "$2" | cut -d: -f1
+}
+
+test_lazy_imports() {
+    local dir=$WORK_DIR/lazy_imports
+    mkdir -p "$dir" && cd "$dir" || return
+    cp "$TESTS_DIR"/little-lang/lazy-imports/*.ll .
+    "$LITTLE_LANG" --lazy-imports --no-module-cache main.ll > out.txt
+    check "the main program starts before its imports run" test "main start" = "$(head -n 1 out.txt)"
+    check "left runs once" test 1 -eq "$(count "left init" out.txt)"
+    check "right runs once" test 1 -eq "$(count "right init" out.txt)"
+    check "the module both import runs once" test 1 -eq "$(count "shared init" out.txt)"
+    check "left runs before its function is called" test "$(line_of "left init" out.txt)" -lt "$(line_of left out.txt)"
+    check "right runs before its function is called" test "$(line_of "right init" out.txt)" -lt "$(line_of right out.txt)"
+}
+
+# calls_of <function> <file or null> <json>
+calls_of() {
+    local file=$2
+    [ null = "$file" ] || file="\"$file\""
+    grep -o "\"function\": \"$1\", \"file\": $file, \"calls\": [0-9]*" "$3" | grep -o '[0-9]*$'
+}
+
+test_trace() {
+    local dir=$WORK_DIR/trace
+    mkdir -p "$dir" && cd "$dir" || return
+    cat > trace.ll <<'EOF'
+def fib(n) {
+    if n < 2 {
+        return n
+    }
+    fib(n - 1) + fib(n - 2)
+}
+def hello() {
+    println("hello")
+}
+for mut i = 0; i < 3; i = i + 1 {
+    hello()
+}
+println(fib(10))
+EOF
+    "$LITTLE_LANG" --no-module-cache --trace=calls.json trace.ll > out.txt 2> table.txt
+    check "--trace=file writes the call counts" test -s calls.json
+    check "--trace=file still prints the table" grep -q "fib (trace.ll)" table.txt
+    check "every recursive call is counted" test 177 -eq "$(calls_of fib trace.ll calls.json)"
+    check "calls from a loop are counted" test 3 -eq "$(calls_of hello trace.ll calls.json)"
+    check "builtins are counted without a file" test 4 -eq "$(calls_of println null calls.json)"
+    check "the program's output is left alone" test "$(printf 'hello\nhello\nhello\n55')" = "$(cat out.txt)"
+}
+
+# allocated_at <file:line> <report>
+allocated_at() {
+    awk -v site="$1" 'NF == 4 && $4 == site { print $3 }' "$2"
+}
+
+test_heap_profile() {
+    local dir=$WORK_DIR/heap_profile
+    mkdir -p "$dir" && cd "$dir" || return
+    cat > heap.ll <<'EOF'
+def twice(x) {
+    x * 2
+}
+mut v = Vector.new()
+for mut i = 0; i < 100; i = i + 1 {
+    v << i
+}
+mut doubled = v.parallel_map(twice)
+println(doubled.length())
+EOF
+    "$LITTLE_LANG" --no-module-cache --heap-profile heap.ll > out.txt 2> report.txt
+    check "--heap-profile prints a report" grep -q "^Heap profile, [0-9]* objects" report.txt
+    check "allocations are counted by line" test 200 -eq "$(allocated_at heap.ll:5 report.txt)"
+    check "allocations of parallel_map workers are merged" test 200 -eq "$(allocated_at heap.ll:2 report.txt)"
+    check "the program's output is left alone" test 100 = "$(cat out.txt)"
+}
+
+test_generator_stack() {
+    local dir=$WORK_DIR/generator_stack
+    mkdir -p "$dir" && cd "$dir" || return
+    cat > stack.ll <<'EOF'
+def forever(n) {
+    forever(n + 1)
+}
+def g() {
+    yield 1
+    yield forever(0)
+    yield 3
+}
+mut x = g()
+println(x.next())
+println(x.next())
+println(x.next())
+EOF
+    "$LITTLE_LANG" --no-module-cache --generator-stack=256 stack.ll > out.txt
+    check "running out of generator stack is not a crash" test 0 -eq $?
+    check "running out of generator stack is an error" grep -q "^Generator ran out of stack calling 'forever'" out.txt
+    check "the generator goes on after the error" test 3 = "$(tail -n 1 out.txt)"
+    echo 'println("ran")' > small.ll
+    "$LITTLE_LANG" --no-module-cache --generator-stack=16 small.ll > out.txt 2> err.txt
+    check "a generator stack too small to use is refused" grep -q "too small" err.txt
+    check "a refused generator stack still runs the program" test ran = "$(cat out.txt)"
+}
+
+test_module_cache
+test_lazy_imports
+test_trace
+test_heap_profile
+test_generator_stack
+
+if [ "$failures" -ne 0 ]; then
+    echo "$failures checks failed"
+    exit 1
+fi
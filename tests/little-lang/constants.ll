@@ -0,0 +1,36 @@
+import "assert.ll" as t
+
+# Folded expressions must agree with the same ones worked out at runtime.
+mut one, two, seven, half = 1, 2, 7, 0.5
+
+t.assert(seven / two, 7 / 2, "7 / 2")
+t.assert(seven % two, 7 % 2, "7 % 2")
+t.assert(two ** 10, 2 ** 10, "2 ** 10")
+t.assert(one << 4, 1 << 4, "1 << 4")
+t.assert(seven & two, 7 & 2, "7 & 2")
+t.assert(-seven, -7, "-7")
+t.assert(seven + half, 7 + 0.5, "7 + 0.5")
+t.assert(seven % half, 7 % 0.5, "7 % 0.5")
+t.assert(2 * 3 + 4 * 5, 26, "2 * 3 + 4 * 5")
+
+t.assert(one <= 1.0, 1 <= 1.0, "1 <= 1.0")
+t.assert(1.0 <= one, 1.0 <= 1, "1.0 <= 1")
+t.assert(one == 1.0, 1 == 1.0, "1 == 1.0")
+t.assert(true, 0.1 + 0.2 == 0.3, "0.1 + 0.2 == 0.3")
+t.assert(true, 2 < 2.5, "2 < 2.5")
+t.assert(false, 3 != 3, "3 != 3")
+
+def never() {
+    t.assert(true, false, "never called")
+}
+
+t.assert(true, true || never(), "true || never()")
+t.assert(false, false && never(), "false && never()")
+t.assert(nil, 1 && true, "1 && true")
+t.assert(true, !(1 > 2), "!(1 > 2)")
+
+def scaled(x) {
+    x * (60 * 60)
+}
+
+t.assert(7200, scaled(2), "folding inside a function")
@@ -0,0 +1,71 @@
+import "assert.ll" as t
+
+def return_from_for {
+    for mut i = 0; i < 10; i = i + 1 {
+        if i == 5 {
+            return i
+        }
+    }
+    99
+}
+t.assert(5, return_from_for(), "return from for")
+
+def return_from_while {
+    mut i = 0
+    while true {
+        i = i + 1
+        if i == 7 {
+            return i
+        }
+    }
+}
+t.assert(7, return_from_while(), "return from while")
+
+mut sum = 0
+for mut i = 0; i < 10; i = i + 1 {
+    if i % 2 == 0 {
+        continue
+    }
+    if i > 7 {
+        break
+    }
+    sum = sum + i
+}
+t.assert(16, sum, "break/continue in for")
+
+def continue_last_in_for {
+    mut n = 0
+    for mut i = 0; i < 3; i = i + 1 {
+        n = n + 1
+        if i == 2 {
+            continue
+        }
+    }
+    n = n + 10
+    n
+}
+t.assert(13, continue_last_in_for(), "continue on the last iteration of a for")
+
+def continue_last_in_while {
+    mut i = 0
+    while i < 3 {
+        i = i + 1
+        if i == 3 {
+            continue
+        }
+    }
+    i = i + 10
+    i
+}
+t.assert(13, continue_last_in_while(), "continue on the last iteration of a while")
+
+mut outer = 0
+for mut i = 0; i < 2; i = i + 1 {
+    for mut j = 0; j < 2; j = j + 1 {
+        if j == 1 {
+            continue
+        }
+    }
+    outer = outer + 1
+}
+t.assert(2, outer, "a continue stays in the inner loop")
@@ -0,0 +1,66 @@
+import "assert.ll" as t
+
+# Meant for an interpreter that collects, see the gc target of
+# tests/Makefile. The collector runs between statements, so every right
+# hand side below calls a function whose statements may collect while the
+# expression around the call holds values of its own.
+mut live = Vector.new()
+for mut i = 0; i < 1200; i = i + 1 {
+    live << string(i)
+}
+
+def digit(i) {
+    mut d = string(i % 10)
+    d
+}
+mut s = ""
+for mut i = 0; i < 2000; i = i + 1 {
+    s = s + digit(i)
+}
+t.assert(2000, s.length(), "assigning to a variable across collections")
+
+class Box {
+    mut value = ""
+}
+def suffix() {
+    mut x = "x"
+    x
+}
+mut box = Box.new()
+for mut i = 0; i < 2000; i = i + 1 {
+    box.value = box.value + suffix()
+}
+t.assert(2000, box.value.length(), "assigning to a member across collections")
+t.assert(1200, live.length(), "live objects survive")
+
+# Leaves nothing but garbage behind, enough of it to collect at least once.
+def churn() {
+    for mut i = 0; i < 5000; i = i + 1 {
+        string(i)
+    }
+    ""
+}
+# Built at run time, a literal is never collected.
+mut head = "he" + "ad"
+def drop_head() {
+    head = ""
+    churn()
+}
+t.assert("head", head + drop_head(), "the left operand outlives its variable")
+
+class Node {
+    mut next = nil
+    mut value = 0
+}
+mut ring = Node.new()
+ring.next = Node.new()
+ring.next.next = ring
+ring.value = 1
+ring.next.value = 2
+mut nested = Vector.new()
+nested << nested
+nested << "inside"
+churn()
+t.assert(2, ring.next.value, "a cycle of objects is marked once")
+t.assert(1, ring.next.next.value, "a cycle of objects survives")
+t.assert("inside", nested[1], "a vector holding itself survives")
@@ -0,0 +1,114 @@
+import "assert.ll" as t
+
+def count_to(n) {
+    for mut i = 1; i <= n; i = i + 1 {
+        yield i
+    }
+}
+
+mut g = count_to(3)
+t.assert(1, g.next(), "first yield")
+t.assert(2, g.next(), "second yield")
+t.assert(false, g.done(), "not done before the body finishes")
+t.assert(3, g.next(), "third yield")
+t.assert(nil, g.next(), "exhausted generator gives nil")
+t.assert(true, g.done(), "done after the body finishes")
+t.assert(nil, g.next(), "stays exhausted")
+
+mut sum = 0
+for x in count_to(10) {
+    sum = sum + x
+}
+t.assert(55, sum, "for-in over a generator")
+
+def evens() {
+    mut i = 0
+    while true {
+        yield i
+        i = i + 2
+    }
+}
+
+mut last = 0
+for x in evens() {
+    if x > 6 {
+        break
+    }
+    last = x
+}
+t.assert(6, last, "break out of an endless generator")
+
+def first_over(limit) {
+    for x in evens() {
+        if x > limit {
+            return x
+        }
+    }
+    nil
+}
+t.assert(12, first_over(11), "return from inside for-in")
+
+def stops_early() {
+    yield 1
+    return nil
+    yield 2
+}
+mut s = stops_early()
+t.assert(1, s.next(), "yield before return")
+t.assert(nil, s.next(), "return ends the generator")
+t.assert(true, s.done(), "done after return")
+
+mut v = Vector.new(3)
+for mut i = 0; i < 3; i = i + 1 {
+    v[i] = i + 1
+}
+mut total = 0
+for x in v {
+    if x == 2 {
+        continue
+    }
+    total = total + x
+}
+t.assert(4, total, "for-in over a vector")
+
+mut a = count_to(2)
+mut b = count_to(2)
+t.assert(1, a.next(), "independent generators a")
+t.assert(1, b.next(), "independent generators b")
+t.assert(2, a.next(), "independent generators a again")
+
+def twice(in) {
+    in * 2
+}
+mut in = 4
+t.assert(8, twice(in), "in names things outside of for-in")
+mut in_total = 0
+for in in count_to(3) {
+    in_total = in_total + in
+}
+t.assert(6, in_total, "for-in can bind in")
+
+def continue_last_in_for_in(items) {
+    mut n = 0
+    for x in items {
+        n = n + x
+        if x == 3 {
+            continue
+        }
+    }
+    n = n + 10
+    n
+}
+t.assert(16, continue_last_in_for_in(count_to(3)), "continue on the last item of a generator")
+t.assert(16, continue_last_in_for_in(v), "continue on the last item of a vector")
+
+def depth(n) {
+    if n == 0 {
+        return 0
+    }
+    1 + depth(n - 1)
+}
+def deep(n) {
+    yield depth(n)
+}
+t.assert(2000, deep(2000).next(), "deep recursion inside a generator")
\ No newline at end of file
@@ -0,0 +1,10 @@
+import "assert.ll" as t
+import "imports/left.ll" as l
+import "imports/right.ll" as r
+import "imports/shared.ll" as s
+
+t.assert(0, r.total(), "nothing pushed yet")
+l.add(1)
+l.add(2)
+t.assert(3, r.total(), "both sides share one module")
+t.assert(3, s.count(), "importer sees the same module")
@@ -0,0 +1,5 @@
+import "shared.ll" as s
+
+def add(x) {
+    s.push(x)
+}
@@ -0,0 +1,9 @@
+mut pushed = 0
+
+def push(x) {
+    pushed = pushed + x
+}
+
+def count() {
+    pushed
+}
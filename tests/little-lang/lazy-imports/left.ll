@@ -0,0 +1,7 @@
+import "shared.ll" as s
+
+println("left init")
+
+def name() {
+    "left"
+}
@@ -0,0 +1,15 @@
+import "left.ll" as l
+import "right.ll" as r
+
+println("main start")
+
+def twice(x) {
+    x * 2
+}
+
+mut v = Vector.new(2)
+v[0] = 1
+v[1] = 2
+v.parallel_map(twice)
+println(l.name())
+println(r.name())
@@ -0,0 +1,7 @@
+import "shared.ll" as s
+
+println("right init")
+
+def name() {
+    "right"
+}
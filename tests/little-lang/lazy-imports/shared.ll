@@ -0,0 +1 @@
+println("shared init")
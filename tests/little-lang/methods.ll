@@ -0,0 +1,25 @@
+import "assert.ll" as t
+
+class Counter {
+    mut count = 0
+
+    def add(self, by) {
+        self.count = self.count + by
+        self.count
+    }
+
+    def get(self) {
+        self.count
+    }
+}
+
+def twice(x) {
+    x * 2
+}
+
+mut a = Counter.new()
+mut b = Counter.new()
+b.add(10)
+t.assert(4, a.add(twice(2)), "a call in the arguments keeps the receiver")
+t.assert(14, a.add(b.get()), "a method call in the arguments keeps the receiver")
+t.assert(30, b.add(a.add(twice(b.get()) - 24) + 10), "nested calls keep their receivers")
@@ -0,0 +1,85 @@
+import "assert.ll" as t
+
+class Money {
+    mut cents
+
+    def new(self, cents) {
+        self.cents = cents
+    }
+
+    def __add__(self, other) {
+        Money.new(self.cents + other.cents)
+    }
+
+    def __lt__(self, other) {
+        self.cents < other.cents
+    }
+
+    def __eq__(self, other) {
+        self.cents == other.cents
+    }
+}
+
+# Integers and reals take a shortcut past their methods, everything else
+# still goes through them.
+mut a, b = Money.new(150), Money.new(275)
+t.assert(425, (a + b).cents, "user __add__")
+t.assert(true, a < b, "user __lt__")
+t.assert(true, a <= Money.new(150), "user <= through __eq__")
+t.assert(false, a != Money.new(150), "user != through __eq__")
+
+mut i, r = 3, 1.5
+t.assert(4.5, i + r, "int + real")
+t.assert(1.5, r * 1, "real * int")
+t.assert(2.0, i / 1.5, "int / real")
+t.assert(false, i == 3.0, "int == real")
+t.assert(true, 3.0 == i, "real == int")
+t.assert(true, i > r, "int > real")
+t.assert(true, r < i, "real < int")
+t.assert(-8, i - 11, "int - int")
+t.assert(nil, i & r, "int & real")
+t.assert("ab", "a" + "b", "string + string")
+
+class Version {
+    mut number
+
+    def new(self, number) {
+        self.number = number
+    }
+
+    def __le__(self, other) {
+        self.number <= other.number
+    }
+}
+
+t.assert(true, Version.new(1) <= Version.new(2), "user __le__")
+t.assert(false, Version.new(3) <= Version.new(2), "user __le__ false")
+
+mut calls = 0
+def counted(x) {
+    calls = calls + 1
+    x
+}
+
+t.assert(true, counted(2) <= 2, "<= on equal values")
+t.assert(true, counted(3) >= counted(1), ">= on greater values")
+t.assert(3, calls, "<= and >= evaluate each side once")
+
+mut n = 0
+while counted(n) <= 4 {
+    n = n + 1
+}
+t.assert(5, n, "while with <=")
+t.assert(9, calls, "loop conditions evaluate each side once")
+
+mut grown = Vector.new()
+mut lost = 0
+grown << 1
+for mut i = 2; i <= 40; i = i + 1 {
+    grown[0] = grown << i
+    if grown[0] != i {
+        lost = lost + 1
+    }
+}
+t.assert(0, lost, "assigning to an element while the vector grows")
+t.assert(39, grown[38], "growing keeps the elements")
@@ -0,0 +1,55 @@
+import "assert.ll" as t
+
+def square(x) {
+    x * x
+}
+
+def add_one(x) {
+    square(x) - square(x) + x + 1
+}
+
+mut v = Vector.new()
+for mut i = 0; i < 1000; i = i + 1 {
+    v << i
+}
+
+mut squares = v.parallel_map(square)
+t.assert(v.length(), squares.length(), "parallel_map keeps the length")
+mut ok = true
+for mut i = 0; i < squares.length(); i = i + 1 {
+    if squares[i] != i * i {
+        ok = false
+    }
+}
+t.assert(true, ok, "parallel_map squares")
+
+mut nested = v.parallel_map(add_one)
+t.assert(1000, nested[999], "parallel_map calls other functions")
+
+mut strings = v.parallel_map(string)
+t.assert("42", strings[42], "parallel_map with a builtin")
+
+mut empty = Vector.new(0)
+t.assert(0, empty.parallel_map(square).length(), "parallel_map on empty vector")
+
+mut hits = Vector.new(100)
+def mark(i) {
+    hits[i] = i
+}
+parallel_for(0, 100, mark)
+mut sum = 0
+for mut i = 0; i < 100; i = i + 1 {
+    sum = sum + hits[i]
+}
+t.assert(4950, sum, "parallel_for visits every index")
+
+
+mut scale = 2
+def scaled(x) {
+    x * scale
+}
+def scale_locally() {
+    mut scale = 100
+    v.parallel_map(scaled)
+}
+t.assert(20, scale_locally()[10], "parallel_map runs under the module scope")
\ No newline at end of file
@@ -1,3 +1,12 @@
 import "booleans.ll" as b
 import "for.ll" as f
-import "while.ll" as w
\ No newline at end of file
+import "while.ll" as w
+import "control-flow.ll" as c
+import "parallel.ll" as p
+import "generators.ll" as g
+import "imports.ll" as i
+import "constants.ll" as k
+import "operators.ll" as o
+import "scopes.ll" as s
+import "gc.ll" as gc
+import "methods.ll" as m
\ No newline at end of file
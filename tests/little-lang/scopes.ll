@@ -0,0 +1,57 @@
+import "assert.ll" as t
+
+mut x = 1
+if true {
+    mut x = 2
+    t.assert(2, x, "mut in an if shadows")
+}
+t.assert(1, x, "mut in an if stays in the if")
+
+if true {
+    x = 3
+}
+t.assert(3, x, "assignment in an if without declarations")
+
+if true {
+    if true {
+        mut x = 4
+    }
+    x = x + 1
+}
+t.assert(4, x, "mut in a nested if stays in the nested if")
+
+mut total = 0
+for mut i = 0; i < 5; i = i + 1 {
+    if i % 2 == 0 {
+        total = total + i
+    }
+    else {
+        mut total = 100
+    }
+}
+t.assert(6, total, "mut in an else stays in the else")
+
+mut n = 0
+while n < 1 {
+    mut x = 10
+    n = n + 1
+}
+t.assert(4, x, "mut in a while stays in the while")
+
+# key and alpha share a bucket of a function's scope, so do inner and y.
+def declare_in_one_bucket() {
+    mut key = 1
+    mut alpha = 2
+    key + alpha
+}
+t.assert(3, declare_in_one_bucket(), "declaring a name whose bucket is taken")
+
+def find_past_bucket(y) {
+    mut seen = 0
+    if true {
+        mut inner = 1
+        seen = y + inner
+    }
+    seen
+}
+t.assert(3, find_past_bucket(2), "a name is found past a scope holding another in its bucket")
@@ -36,7 +36,7 @@ void done(void) {
 
 TEST(AstMakeBoolean) {
     struct Ast *ast;
-    assert_eq(R_OK, AstMakeBoolean(&ast, value, srcLoc), "AstMakeBoolean failed.");
+    assert_eq(R_Success, AstMakeBoolean(&ast, value, srcLoc), "AstMakeBoolean failed.");
     assert_eq(R_InvalidArgument, AstMakeBoolean(&ast, NULL, srcLoc), "AstMakeBoolean did not fail.");
     assert_eq(R_InvalidArgument, AstMakeBoolean(NULL, value, srcLoc), "AstMakeBoolean did not fail.");
     //AstFree(ast);
@@ -45,7 +45,7 @@ TEST(AstMakeBoolean) {
 
 TEST(AstMakeReal) {
     struct Ast *ast;
-    assert_eq(R_OK, AstMakeReal(&ast, value, srcLoc), "AstMakeReal failed.");
+    assert_eq(R_Success, AstMakeReal(&ast, value, srcLoc), "AstMakeReal failed.");
     free(ast);
     assert_eq(R_InvalidArgument, AstMakeReal(&ast, NULL, srcLoc), "AstMakeReal did not fail.");
     assert_eq(R_InvalidArgument, AstMakeReal(NULL, value, srcLoc), "AstMakeReal did not fail.");
@@ -53,7 +53,7 @@ TEST(AstMakeReal) {
 
 TEST(AstMakeInteger) {
     struct Ast *ast;
-    assert_eq(R_OK, AstMakeInteger(&ast, value, srcLoc), "AstMakeInteger failed.");
+    assert_eq(R_Success, AstMakeInteger(&ast, value, srcLoc), "AstMakeInteger failed.");
     free(ast);
     assert_eq(R_InvalidArgument, AstMakeInteger(&ast, NULL, srcLoc), "AstMakeInteger did not fail.");
     assert_eq(R_InvalidArgument, AstMakeInteger(NULL, value, srcLoc), "AstMakeInteger did not fail.");
@@ -61,7 +61,7 @@ TEST(AstMakeInteger) {
 
 TEST(AstMakeString) {
     struct Ast *ast;
-    assert_eq(R_OK, AstMakeString(&ast, value, srcLoc), "AstMakeString failed.");
+    assert_eq(R_Success, AstMakeString(&ast, value, srcLoc), "AstMakeString failed.");
     free(ast);
     assert_eq(R_InvalidArgument, AstMakeString(&ast, NULL, srcLoc), "AstMakeString did not fail.");
     assert_eq(R_InvalidArgument, AstMakeString(NULL, value, srcLoc), "AstMakeString did not fail.");
@@ -69,7 +69,7 @@ TEST(AstMakeString) {
 
 TEST(AstMakeSymbol) {
     struct Ast *ast;
-    assert_eq(R_OK, AstMakeSymbol(&ast, name, srcLoc), "AstMakeSymbol failed.");
+    assert_eq(R_Success, AstMakeSymbol(&ast, name, srcLoc), "AstMakeSymbol failed.");
     free(ast);
     assert_eq(R_InvalidArgument, AstMakeSymbol(&ast, NULL, srcLoc), "AstMakeSymbol did not fail.");
     assert_eq(R_InvalidArgument, AstMakeSymbol(NULL, name, srcLoc), "AstMakeSymbol did not fail.");
@@ -77,7 +77,7 @@ TEST(AstMakeSymbol) {
 
 TEST(AstMakeFunction) {
     struct Ast *ast;
-    assert_eq(R_OK, AstMakeFunction(&ast, value, srcLoc), "AstMakeFunction failed.");
+    assert_eq(R_Success, AstMakeFunction(&ast, value, srcLoc), "AstMakeFunction failed.");
     free(ast);
     assert_eq(R_InvalidArgument, AstMakeFunction(&ast, NULL, srcLoc), "AstMakeFunction did not fail.");
     assert_eq(R_InvalidArgument, AstMakeFunction(NULL, value, srcLoc), "AstMakeFunction did not fail.");
@@ -85,7 +85,7 @@ TEST(AstMakeFunction) {
 
 TEST(AstMakeBinaryOp) {
     struct Ast *ast;
-    assert_eq(R_OK, AstMakeBinaryOp(&ast, ast1, BAddExpr, ast2, srcLoc), "AstMakeBinaryOp failed.");
+    assert_eq(R_Success, AstMakeBinaryOp(&ast, ast1, BAddExpr, ast2, srcLoc), "AstMakeBinaryOp failed.");
     free(ast->Children); free(ast);
     assert_eq(R_InvalidArgument, AstMakeBinaryOp(NULL, ast1, BAddExpr, ast2, srcLoc), "AstMakeBinaryOp did not fail.");
     assert_eq(R_InvalidArgument, AstMakeBinaryOp(&ast, NULL, BAddExpr, ast2, srcLoc), "AstMakeBinaryOp did not fail.");
@@ -94,7 +94,7 @@ TEST(AstMakeBinaryOp) {
 
 TEST(AstMakeUnaryOp) {
     struct Ast *ast;
-    assert_eq(R_OK, AstMakeUnaryOp(&ast, UNegExpr, ast1, srcLoc), "AstMakeUnaryOp failed.");
+    assert_eq(R_Success, AstMakeUnaryOp(&ast, UNegExpr, ast1, srcLoc), "AstMakeUnaryOp failed.");
     free(ast->Children); free(ast);
     assert_eq(R_InvalidArgument, AstMakeUnaryOp(NULL, UNegExpr, ast1, srcLoc), "AstMakeUnaryOp did not fail.");
     assert_eq(R_InvalidArgument, AstMakeUnaryOp(&ast, UNegExpr, NULL, srcLoc), "AstMakeUnaryOp did not fail.");
@@ -102,7 +102,7 @@ TEST(AstMakeUnaryOp) {
 
 TEST(AstMakeAssign) {
     struct Ast *ast;
-    assert_eq(R_OK, AstMakeAssign(&ast, ast1, ast2, srcLoc), "AstMakeAssign failed.");
+    assert_eq(R_Success, AstMakeAssign(&ast, ast1, ast2, srcLoc), "AstMakeAssign failed.");
     free(ast->Children); free(ast);
     assert_eq(R_InvalidArgument, AstMakeAssign(NULL, ast1, ast2, srcLoc), "AstMakeAssign failed.");
     assert_eq(R_InvalidArgument, AstMakeAssign(&ast, NULL, ast2, srcLoc), "AstMakeAssign did not fail.");
@@ -111,9 +111,9 @@ TEST(AstMakeAssign) {
 
 TEST(AstMakeCall) {
     struct Ast *ast;
-    assert_eq(R_OK, AstMakeCall(&ast, ast1, ast2, srcLoc), "AstMakeCall failed.");
+    assert_eq(R_Success, AstMakeCall(&ast, ast1, ast2, srcLoc), "AstMakeCall failed.");
     free(ast->Children); free(ast);
-    assert_eq(R_OK, AstMakeCall(&ast, ast1, NULL, srcLoc), "AstMakeCall with no args failed.");
+    assert_eq(R_Success, AstMakeCall(&ast, ast1, NULL, srcLoc), "AstMakeCall with no args failed.");
     free(ast->Children); free(ast);
     assert_eq(R_InvalidArgument, AstMakeCall(NULL, ast1, ast2, srcLoc), "AstMakeCall did not fail.");
     assert_eq(R_InvalidArgument, AstMakeCall(&ast, NULL, ast2, srcLoc), "AstMakeCall did not fail.");
@@ -121,9 +121,9 @@ TEST(AstMakeCall) {
 
 TEST(AstMakeReturn) {
     struct Ast *ast;
-    assert_eq(R_OK, AstMakeReturn(&ast, ast1, srcLoc), "AstMakeReturn failed.");
+    assert_eq(R_Success, AstMakeReturn(&ast, ast1, srcLoc), "AstMakeReturn failed.");
     free(ast->Children); free(ast);
-    assert_eq(R_OK, AstMakeReturn(&ast, NULL, srcLoc), "AstMakeReturn with no value failed.");
+    assert_eq(R_Success, AstMakeReturn(&ast, NULL, srcLoc), "AstMakeReturn with no value failed.");
     free(ast->Children); free(ast);
     assert_eq(R_InvalidArgument, AstMakeReturn(NULL, ast1, srcLoc), "AstMakeReturn did not fail.");
 }
@@ -135,7 +135,7 @@ TEST(AstMakeMut) {
     AstAppendChild(tmp1, ast1);
     AstMakeBlank(&tmp2);
     AstAppendChild(tmp2, ast2);
-    assert_eq(R_OK, AstMakeMut(&ast, tmp1, tmp2, srcLoc), "AstMakeMut failed.");
+    assert_eq(R_Success, AstMakeMut(&ast, tmp1, tmp2, srcLoc), "AstMakeMut failed.");
     free(ast->Children); free(ast);
 
     assert_eq(R_InvalidArgument, AstMakeMut(&ast, tmp1, ast2, srcLoc), "AstMakeMut should fail when names has no children");
@@ -156,7 +156,7 @@ TEST(AstMakeMut) {
 
 TEST(AstMakeConst) {
     struct Ast *ast;
-    assert_eq(R_OK, AstMakeConst(&ast, name, ast1, srcLoc), "AstMakeConst failed.");
+    assert_eq(R_Success, AstMakeConst(&ast, name, ast1, srcLoc), "AstMakeConst failed.");
     free(ast->Children[0]); free(ast->Children); free(ast);
     assert_eq(R_InvalidArgument, AstMakeConst(NULL, name, ast1, srcLoc), "AstMakeConst did not fail.");
     assert_eq(R_InvalidArgument, AstMakeConst(&ast, NULL, ast1, srcLoc), "AstMakeConst did not fail.");
@@ -165,26 +165,26 @@ TEST(AstMakeConst) {
 
 TEST(AstMakeFor) {
     struct Ast *ast;
-    assert_eq(R_OK, AstMakeFor(&ast, ast1, ast2, ast3, ast4, srcLoc), "AstMakeFor failed.");
+    assert_eq(R_Success, AstMakeFor(&ast, ast1, ast2, ast3, ast4, srcLoc), "AstMakeFor failed.");
     free(ast->Children); free(ast);
-    assert_eq(R_OK, AstMakeFor(&ast, NULL, ast2, ast3, ast4, srcLoc), "AstMakeFor failed with no pre.");
+    assert_eq(R_Success, AstMakeFor(&ast, NULL, ast2, ast3, ast4, srcLoc), "AstMakeFor failed with no pre.");
     free(ast->Children); free(ast);
-    assert_eq(R_OK, AstMakeFor(&ast, ast1, NULL, ast3, ast4, srcLoc), "AstMakeFor failed with no condition.");
+    assert_eq(R_Success, AstMakeFor(&ast, ast1, NULL, ast3, ast4, srcLoc), "AstMakeFor failed with no condition.");
     free(ast->Children); free(ast);
-    assert_eq(R_OK, AstMakeFor(&ast, ast1, ast2, NULL, ast4, srcLoc), "AstMakeFor failed with no body.");
+    assert_eq(R_Success, AstMakeFor(&ast, ast1, ast2, NULL, ast4, srcLoc), "AstMakeFor failed with no body.");
     free(ast->Children); free(ast);
-    assert_eq(R_OK, AstMakeFor(&ast, ast1, ast2, ast3, NULL, srcLoc), "AstMakeFor failed with no post.");
+    assert_eq(R_Success, AstMakeFor(&ast, ast1, ast2, ast3, NULL, srcLoc), "AstMakeFor failed with no post.");
     free(ast->Children); free(ast);
-    assert_eq(R_OK, AstMakeFor(&ast, NULL, NULL, NULL, NULL, srcLoc), "AstMakeFor failed with nothing.");
+    assert_eq(R_Success, AstMakeFor(&ast, NULL, NULL, NULL, NULL, srcLoc), "AstMakeFor failed with nothing.");
     free(ast->Children); free(ast);
     assert_eq(R_InvalidArgument, AstMakeFor(NULL, ast1, ast2, ast3, ast4, srcLoc), "AstMakeFor did not fail.");
 }
 
 TEST(AstMakeWhile) {
     struct Ast *ast;
-    assert_eq(R_OK, AstMakeWhile(&ast, ast1, ast2, srcLoc), "AstMakeWhile failed.");
+    assert_eq(R_Success, AstMakeWhile(&ast, ast1, ast2, srcLoc), "AstMakeWhile failed.");
     free(ast->Children); free(ast);
-    assert_eq(R_OK, AstMakeWhile(&ast, ast1, NULL, srcLoc), "AstMakeWhile failed with no body");
+    assert_eq(R_Success, AstMakeWhile(&ast, ast1, NULL, srcLoc), "AstMakeWhile failed with no body");
     free(ast->Children); free(ast);
     assert_eq(R_InvalidArgument, AstMakeWhile(NULL, ast1, ast2, srcLoc), "AstMakeWhile did not fail.");
     assert_eq(R_InvalidArgument, AstMakeWhile(&ast, NULL, ast2, srcLoc), "AstMakeWhile did not fail with no condition.");
@@ -192,13 +192,13 @@ TEST(AstMakeWhile) {
 
 TEST(AstMakeIfElse) {
     struct Ast *ast;
-    assert_eq(R_OK, AstMakeIfElse(&ast, ast1, ast2, ast3, srcLoc), "AstMakeIfElse failed.");
+    assert_eq(R_Success, AstMakeIfElse(&ast, ast1, ast2, ast3, srcLoc), "AstMakeIfElse failed.");
     free(ast->Children); free(ast);
-    assert_eq(R_OK, AstMakeIfElse(&ast, ast1, NULL, ast3, srcLoc), "AstMakeIfElse failed with no body.");
+    assert_eq(R_Success, AstMakeIfElse(&ast, ast1, NULL, ast3, srcLoc), "AstMakeIfElse failed with no body.");
     free(ast->Children); free(ast);
-    assert_eq(R_OK, AstMakeIfElse(&ast, ast1, ast2, NULL, srcLoc), "AstMakeIfElse failed with no elseif.");
+    assert_eq(R_Success, AstMakeIfElse(&ast, ast1, ast2, NULL, srcLoc), "AstMakeIfElse failed with no elseif.");
     free(ast->Children); free(ast);
-    assert_eq(R_OK, AstMakeIfElse(&ast, ast1, NULL, NULL, srcLoc), "AstMakeIfElse failed with no body or elseif.");
+    assert_eq(R_Success, AstMakeIfElse(&ast, ast1, NULL, NULL, srcLoc), "AstMakeIfElse failed with no body or elseif.");
     free(ast->Children); free(ast);
     assert_eq(R_InvalidArgument, AstMakeIfElse(NULL, ast1, ast2, ast3, srcLoc), "AstMakeIfElse did not fail.");
     assert_eq(R_InvalidArgument, AstMakeIfElse(NULL, NULL, ast2, ast3, srcLoc), "AstMakeIfElse did not fail with no condition.");
@@ -0,0 +1,109 @@
+#ifndef _LITTLE_LANG_TESTS_C_BENCH_H
+#define _LITTLE_LANG_TESTS_C_BENCH_H
+
+/* A small harness for timing the core data structures. A benchmark is run
+   with more and more iterations until it takes at least BENCH_MIN_TIME_NS,
+   the time and allocations per iteration of the last run are reported. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define BENCH_MIN_TIME_NS 200000000ULL
+#define BENCH_MAX_ITERATIONS 1000000000UL
+
+struct Bench {
+    /* Number of iterations the benchmark must run. */
+    unsigned long N;
+    unsigned long long Start;
+    unsigned long long Elapsed;
+    unsigned long long AllocsAtStart;
+    unsigned long long Allocs;
+    int Running;
+};
+
+typedef void (*BenchFn)(struct Bench *b, void *arg);
+
+static unsigned long long _c_bench_allocs;
+
+#ifdef __GLIBC__
+#define BENCH_COUNTS_ALLOCS 1
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+/* Every allocation is counted, including the ones libc makes for us, like
+   strdup's. */
+void *malloc(size_t size) {
+    ++_c_bench_allocs;
+    return __libc_malloc(size);
+}
+void *calloc(size_t count, size_t size) {
+    ++_c_bench_allocs;
+    return __libc_calloc(count, size);
+}
+void *realloc(void *ptr, size_t size) {
+    ++_c_bench_allocs;
+    return __libc_realloc(ptr, size);
+}
+#else
+#define BENCH_COUNTS_ALLOCS 0
+#endif
+
+static unsigned long long BenchNow(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+}
+
+/* Setup done inside a benchmark can be left out of its numbers by stopping
+   the timer around it. */
+static void BenchStartTimer(struct Bench *b) {
+    if (!b->Running) {
+        b->Running = 1;
+        b->AllocsAtStart = _c_bench_allocs;
+        b->Start = BenchNow();
+    }
+}
+
+static void BenchStopTimer(struct Bench *b) {
+    if (b->Running) {
+        b->Elapsed += BenchNow() - b->Start;
+        b->Allocs += _c_bench_allocs - b->AllocsAtStart;
+        b->Running = 0;
+    }
+}
+
+static void BenchRun(const char *name, BenchFn fn, void *arg) {
+    struct Bench b;
+    unsigned long n = 1, next;
+    char allocs[32] = "-";
+    while (1) {
+        b.N = n;
+        b.Elapsed = 0;
+        b.Allocs = 0;
+        b.Running = 0;
+        BenchStartTimer(&b);
+        fn(&b, arg);
+        BenchStopTimer(&b);
+        if (b.Elapsed >= BENCH_MIN_TIME_NS || n >= BENCH_MAX_ITERATIONS) {
+            break;
+        }
+        /* Aim a little past the minimum so the next run is the last. */
+        next = b.Elapsed ? (unsigned long)(n * 1.2 * BENCH_MIN_TIME_NS / b.Elapsed) : n * 100;
+        if (next < n * 2) {
+            next = n * 2;
+        }
+        if (next > n * 100) {
+            next = n * 100;
+        }
+        n = next < BENCH_MAX_ITERATIONS ? next : BENCH_MAX_ITERATIONS;
+    }
+    if (BENCH_COUNTS_ALLOCS) {
+        snprintf(allocs, sizeof allocs, "%.2f", (double)b.Allocs / n);
+    }
+    printf("%-48s %10lu %14.1f ns/op %10s allocs/op\n", name, n, (double)b.Elapsed / n, allocs);
+}
+
+#endif
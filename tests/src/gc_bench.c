@@ -0,0 +1,129 @@
+#include "interpreter.h"
+#include "isolate.h"
+#include "globals.h"
+#include "llvector.h"
+#include "value.h"
+#include "runtime/gc.h"
+
+#include "c_bench.h"
+
+/* Garbage left by the collector-disabled benchmarks is collected in
+   batches of this many objects. */
+#define GARBAGE_BATCH 100000UL
+
+static struct Isolate TheIsolate;
+static struct SrcLoc srcLoc = {"gc_bench.c", -1, -1};
+
+static struct Value *AllocInteger(int i) {
+    struct Value *v;
+    GC_AllocValue(&v);
+    v->TypeInfo = &g_TheIntegerTypeInfo;
+    v->v.Integer = i;
+    return v;
+}
+
+/* Keeps size objects reachable from the global scope through a vector. */
+static void MakeLiveSet(unsigned int size) {
+    struct Value *vector;
+    unsigned int i;
+    GC_Disable();
+    GC_AllocValue(&vector);
+    vector->TypeInfo = &g_TheVectorTypeInfo;
+    vector->IsPassByReference = 1;
+    vector->v.Vector = calloc(sizeof *vector->v.Vector, 1);
+    LLVectorMake(vector->v.Vector, size ? size : 1);
+    for (i = 0; i < size; ++i) {
+        vector->v.Vector->Values[i] = AllocInteger(i);
+    }
+    SymbolTableAssign(TheIsolate.GlobalScope, vector, "live", 1, srcLoc);
+    GC_Enable();
+    GC_Collect();
+}
+
+static void DropLiveSet(void) {
+    SymbolTableAssign(TheIsolate.GlobalScope, &g_TheNilValue, "live", 1, srcLoc);
+    GC_Collect();
+}
+
+static void BenchAllocNoCollect(struct Bench *b, void *arg) {
+    unsigned long i;
+    (void)arg;
+    GC_Disable();
+    for (i = 0; i < b->N; ++i) {
+        AllocInteger(i);
+        if (0 == (i + 1) % GARBAGE_BATCH) {
+            BenchStopTimer(b);
+            GC_Enable();
+            GC_Collect();
+            GC_Disable();
+            BenchStartTimer(b);
+        }
+    }
+    BenchStopTimer(b);
+    GC_Enable();
+    GC_Collect();
+}
+
+static void BenchAllocLive(struct Bench *b, void *arg) {
+    unsigned long i;
+    BenchStopTimer(b);
+    MakeLiveSet(*(unsigned int*)arg);
+    BenchStartTimer(b);
+    for (i = 0; i < b->N; ++i) {
+        AllocInteger(i);
+    }
+    BenchStopTimer(b);
+    DropLiveSet();
+}
+
+static void BenchCollectLive(struct Bench *b, void *arg) {
+    unsigned long i;
+    BenchStopTimer(b);
+    MakeLiveSet(*(unsigned int*)arg);
+    BenchStartTimer(b);
+    for (i = 0; i < b->N; ++i) {
+        GC_Collect();
+    }
+    BenchStopTimer(b);
+    DropLiveSet();
+}
+
+/* One collection that frees as many objects as it keeps. */
+static void BenchCollectGarbage(struct Bench *b, void *arg) {
+    unsigned int j, size = *(unsigned int*)arg;
+    unsigned long i;
+    BenchStopTimer(b);
+    MakeLiveSet(size);
+    for (i = 0; i < b->N; ++i) {
+        GC_Disable();
+        for (j = 0; j < size; ++j) {
+            AllocInteger(j);
+        }
+        GC_Enable();
+        BenchStartTimer(b);
+        GC_Collect();
+        BenchStopTimer(b);
+    }
+    DropLiveSet();
+}
+
+int main() {
+    static unsigned int sizes[] = { 1000, 10000, 100000 };
+    unsigned int s;
+    char name[64];
+    InterpreterInit();
+    IsolateMake(&TheIsolate);
+    IsolateEnter(&TheIsolate);
+    BenchRun("GC_AllocValue/collector disabled", BenchAllocNoCollect, NULL);
+    for (s = 0; s < sizeof sizes / sizeof *sizes; ++s) {
+        snprintf(name, sizeof name, "GC_AllocValue/live/%u", sizes[s]);
+        BenchRun(name, BenchAllocLive, &sizes[s]);
+        snprintf(name, sizeof name, "GC_Collect/live/%u", sizes[s]);
+        BenchRun(name, BenchCollectLive, &sizes[s]);
+        snprintf(name, sizeof name, "GC_Collect/live/%u/garbage/%u", sizes[s], sizes[s]);
+        BenchRun(name, BenchCollectGarbage, &sizes[s]);
+    }
+    IsolateExit(&TheIsolate);
+    IsolateFree(&TheIsolate);
+    return 0;
+}
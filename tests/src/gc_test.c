@@ -1,15 +1,16 @@
 #undef NDEBUG
-#include "../src/globals.c"
-#include "../src/ast.c"
-#include "../helpers/strings.c"
-#include "../src/symbol_table.c"
-#include "../src/type_info.c"
-#include "../src/value.c"
+/* For GC_Mark, GC_Sweep and GC_Heap, the rest of the interpreter is
+   linked in, see bin/gc_test in the Makefile. */
 #include "../runtime/gc.c"
+#include "interpreter.h"
+#include "little_lang_machine.h"
 
 #include "c_test.h"
 #include "test_helpers.h"
 
+#include <pthread.h>
+#include <unistd.h>
+
 /* Note that these tests use the current state of the garbage collector
    and do not need to reallocate resources between tests, however, this
    does mean that the order in which they are executed does matter. */
@@ -19,16 +20,39 @@ static unsigned int allocated = MaxNumValuesAllocated / 2;
 static struct Value **ValuesAllocated;
 
 static struct SymbolTable *CurrentScope;
+static struct Isolate TheIsolate;
 
 void setup(void) {
-    GlobalsInit();
-    CurrentScope = g_TheGlobalScope;
+    InterpreterInit();
+    IsolateMake(&TheIsolate);
+    IsolateEnter(&TheIsolate);
+    CurrentScope = TheIsolate.GlobalScope;
     ValuesAllocated = calloc(sizeof *ValuesAllocated, MaxNumValuesAllocated);
 }
 
+/* Lets the next GC_Sweep free v although a scope holds it, the scope is
+   left holding nil instead of the freed value. */
+static void Unmark(struct Value *v) {
+    struct SymbolTable *st;
+    struct Symbol *s;
+    unsigned int i;
+    for (st = TheIsolate.GlobalScope; st; st = st->Child) {
+        for (i = 0; i < st->TableLength; ++i) {
+            for (s = st->Symbols[i]; s; s = s->Next) {
+                if (v == s->Value) {
+                    s->Value = &g_TheNilValue;
+                }
+            }
+        }
+    }
+    v->Visited = 0;
+}
+
 void done(void) {
-    GlobalsDenit();
     GC_Collect();
+    IsolateExit(&TheIsolate);
+    IsolateFree(&TheIsolate);
+    InterpreterDenit();
     free(ValuesAllocated);
 }
 
@@ -37,11 +61,12 @@ TEST(GC_Alloc) {
     char *id;
     struct Value *v;
     for (i = 0; i < allocated; ++i) {
-        assert_eq(R_OK, GC_AllocValue(&v), "GC Failed to alloc values");
+        assert_eq(R_Success, GC_AllocValue(&v), "GC Failed to alloc values");
         assert_eq(0, v->Visited, "GC_AllocValue Failed to set Value->Visited");
         v->TypeInfo = &g_TheIntegerTypeInfo;
         v->v.Integer = i;
-        id = ident_generator(i);
+        /* Seeds 0 and 1 give the same identifier. */
+        id = ident_generator(i + 1);
         if (i && i % (allocated/5) == 0) {
             SymbolTablePushScope(&CurrentScope);
         }
@@ -53,7 +78,7 @@ TEST(GC_Alloc) {
 
 TEST(CheckValueOrderIsCorrect) {
     unsigned int i = 0;
-    struct GC_Object *object = GC_Head;
+    struct GC_Object *object = GC_Heap.Head;
     while (object) {
         assert_eq(ValuesAllocated[i++], object->Value, "Value Order is incorrect");
         object = object->Next;
@@ -62,16 +87,16 @@ TEST(CheckValueOrderIsCorrect) {
 
 TEST(GC_CollectHead) {
     GC_Mark();
-    GC_Head->Value->Visited = 0;
+    Unmark(GC_Heap.Head->Value);
     GC_Sweep();
-    assert_eq(ValuesAllocated[1], GC_Head->Value, "GC_Collect failed to move head.");
+    assert_eq(ValuesAllocated[1], GC_Heap.Head->Value, "GC_Collect failed to move head.");
 }
 
 TEST(GC_CollectTail) {
     GC_Mark();
-    GC_Tail->Value->Visited = 0;
+    Unmark(GC_Heap.Tail->Value);
     GC_Sweep();
-    assert_eq(ValuesAllocated[allocated-2], GC_Tail->Value, "GC_Collect failed to move Tail.");
+    assert_eq(ValuesAllocated[allocated-2], GC_Heap.Tail->Value, "GC_Collect failed to move Tail.");
 }
 
 TEST(GC_CollectRandomAreNotInList) {
@@ -83,13 +108,13 @@ TEST(GC_CollectRandomAreNotInList) {
     struct Value *cv;
     struct GC_Object *object;
     GC_Mark();
-    v11->Visited = 0;
-    v21->Visited = 0;
-    v31->Visited = 0;
-    v41->Visited = 0;
-    v51->Visited = 0;
+    Unmark(v11);
+    Unmark(v21);
+    Unmark(v31);
+    Unmark(v41);
+    Unmark(v51);
     GC_Sweep();
-    object = GC_Head;
+    object = GC_Heap.Head;
     while (object) {
         cv = object->Value;
         if (cv == v11 || cv == v21 || cv == v31 || cv == v41 || cv == v51) {
@@ -131,7 +156,7 @@ TEST(CheckCollectAfterScopePop) {
     struct GC_Object *object;
     SymbolTablePopScope(&CurrentScope);
     GC_Collect();
-    object = GC_Head;
+    object = GC_Heap.Head;
     while (object) {
         if (check_in_vals(values, object->Value)) {
             fail("GC_Collect didn't last scope.");
@@ -142,13 +167,13 @@ TEST(CheckCollectAfterScopePop) {
 
 TEST(CheckAllocatedObjectCountIsCorrect) {
     unsigned int count = 0;
-    struct GC_Object *obj = GC_Head;
-    assert_ne(0, GC_Allocated, "GC_Allocated should not be 0");
+    struct GC_Object *obj = GC_Heap.Head;
+    assert_ne(0, GC_Heap.Allocated, "GC_Allocated should not be 0");
     while (obj) {
         ++count;
         obj = obj->Next;
     }
-    assert_eq(count, GC_Allocated, "GC_Allocated != count");
+    assert_eq(count, GC_Heap.Allocated, "GC_Allocated != count");
 }
 
 TEST(CheckGCForGarbageAfterCollect) {
@@ -156,13 +181,153 @@ TEST(CheckGCForGarbageAfterCollect) {
     struct TypeInfo *bad;
     memset(&bad, 0xff, sizeof bad);
     GC_Collect();
-    obj = GC_Head;
+    obj = GC_Heap.Head;
     while (obj) {
         assert_ne(bad, obj->Value->TypeInfo, "Found garbage still in list.");
         obj = obj->Next;
     }
 }
 
+TEST(CheckStatsAddUp) {
+    const struct GC_Stats *stats = GC_GetStats();
+    assert_eq(allocated, stats->ObjectsAllocated, "GC_Stats missed an allocation");
+    assert_eq(stats->ObjectsAllocated - stats->ObjectsFreed, GC_Heap.Allocated, "GC_Stats freed != allocated - live");
+    assert_eq(GC_Heap.Allocated, stats->LastSurvived, "GC_Stats survivors of the last sweep are wrong");
+    assert_eq(allocated, stats->PeakObjects, "GC_Stats peak is wrong");
+}
+
+/* Collects as it goes and leaves every step'th number behind in out,
+   prefixed with the machine's letter. */
+static const char *MachineProgram =
+    "mut keep = Vector.new()\n"
+    "for mut i = 0; i < 2000; i = i + 1 {\n"
+    "    string(i)\n"
+    "    if i %% %u == 0 {\n"
+    "        keep << \"%c\" + string(i)\n"
+    "    }\n"
+    "}\n"
+    "mut out = \"\"\n"
+    "for mut i = 0; i < keep.length(); i = i + 1 {\n"
+    "    out = out + keep[i]\n"
+    "}\n";
+
+struct MachineRun {
+    char Letter;
+    unsigned int Step;
+    char Path[32];
+    struct LittleLangMachine Machine;
+    int Result;
+};
+
+static void *RunMachine(void *arg) {
+    struct MachineRun *run = arg;
+    char *argv[2];
+    argv[0] = "--no-module-cache";
+    argv[1] = run->Path;
+    run->Result = LittleLangMachineInit(&run->Machine, 2, argv);
+    if (R_Success == run->Result) {
+        run->Result = LittleLangMachineRun(&run->Machine);
+    }
+    return NULL;
+}
+
+static int WriteMachineProgram(struct MachineRun *run) {
+    FILE *file;
+    int fd;
+    strcpy(run->Path, "/tmp/gc_test_XXXXXX");
+    fd = mkstemp(run->Path);
+    if (-1 == fd) {
+        return R_OperationFailed;
+    }
+    file = fdopen(fd, "w");
+    fprintf(file, MachineProgram, run->Step, run->Letter);
+    fclose(file);
+    return R_Success;
+}
+
+static char *ExpectedOutput(struct MachineRun *run) {
+    char *out = calloc(1, 2000 * 8);
+    unsigned int i;
+    for (i = 0; i < 2000; i += run->Step) {
+        sprintf(out + strlen(out), "%c%u", run->Letter, i);
+    }
+    return out;
+}
+
+static char *MachineOutput(struct MachineRun *run) {
+    struct Symbol *symbol;
+    if (R_True != SymbolTableFindLocal(run->Machine.ThisModule->ModuleScope, "out", &symbol)) {
+        return NULL;
+    }
+    if (&g_TheStringTypeInfo != symbol->Value->TypeInfo) {
+        return NULL;
+    }
+    return symbol->Value->v.String->CString;
+}
+
+static unsigned int HeapLength(struct Isolate *isolate) {
+    struct GC_Object *object;
+    unsigned int length = 0;
+    for (object = isolate->GC.Head; object; object = object->Next) {
+        ++length;
+    }
+    return length;
+}
+
+static int InHeap(struct Isolate *isolate, struct Value *v) {
+    struct GC_Object *object;
+    for (object = isolate->GC.Head; object; object = object->Next) {
+        if (v == object->Value) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+TEST(TwoMachinesOnTwoThreads) {
+    struct MachineRun runs[2];
+    struct Isolate *a, *b;
+    struct GC_Object *object;
+    char *expected, *out;
+    pthread_t threads[2];
+    unsigned int i;
+    memset(runs, 0, sizeof runs);
+    runs[0].Letter = 'a';
+    runs[0].Step = 100;
+    runs[1].Letter = 'b';
+    runs[1].Step = 40;
+    for (i = 0; i < 2; ++i) {
+        assert_eq(R_Success, WriteMachineProgram(&runs[i]), "Could not write a machine's program");
+    }
+    for (i = 0; i < 2; ++i) {
+        pthread_create(&threads[i], NULL, RunMachine, &runs[i]);
+    }
+    for (i = 0; i < 2; ++i) {
+        pthread_join(threads[i], NULL);
+        unlink(runs[i].Path);
+        assert_eq(R_Success, runs[i].Result, "A machine failed to run its program");
+        expected = ExpectedOutput(&runs[i]);
+        out = MachineOutput(&runs[i]);
+        assert_p(out && 0 == strcmp(expected, out), "A machine's output has the other's in it");
+        free(expected);
+    }
+    a = runs[0].Machine.Isolate;
+    b = runs[1].Machine.Isolate;
+    assert_ne(0, a->GC.Stats.Collections, "The first machine never collected");
+    assert_ne(0, b->GC.Stats.Collections, "The second machine never collected");
+    assert_eq(a->GC.Allocated, HeapLength(a), "The first heap's count is off");
+    assert_eq(b->GC.Allocated, HeapLength(b), "The second heap's count is off");
+    for (object = a->GC.Head; object; object = object->Next) {
+        if (InHeap(b, object->Value)) {
+            fail("An object is in both heaps");
+            break;
+        }
+    }
+    for (i = 0; i < 2; ++i) {
+        LittleLangMachineDenit(&runs[i].Machine);
+    }
+}
+
 int main() {
     setup();
     TEST_RUN(GC_Alloc);
@@ -173,6 +338,8 @@ int main() {
     TEST_RUN(CheckCollectAfterScopePop);
     TEST_RUN(CheckGCForGarbageAfterCollect);
     TEST_RUN(CheckAllocatedObjectCountIsCorrect);
+    TEST_RUN(CheckStatsAddUp);
+    TEST_RUN(TwoMachinesOnTwoThreads);
     done();
     return 0;
 }
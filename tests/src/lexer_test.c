@@ -17,7 +17,8 @@ TEST(LexerMakeFree) {
 
 #define _LEX_TEST(lex, str, tok, typ)                                   \
     assert_eq(0, LexerNextToken(lex, &tok), "LexerNextToken Failed");    \
-    assert_str_eq(str, tok->TokenStr, "Did not successfully parse '" str "' token."); \
+    assert_eq(STRLEN_LIT(str), tok->Length, "Did not successfully parse '" str "' token."); \
+    assert_eq(0, strncmp(str, tok->Text, tok->Length), "Did not successfully parse '" str "' token."); \
     assert_eq(typ, tok->Type, "Did not correctly set token '" str "' type.");
 
 #define _LEX_TOK_FREE(tok)                      \
@@ -73,12 +74,12 @@ TEST(LexerPeekToken) {
     LexerMake(lexer, filename, code);
 
     assert_eq(0, LexerPeekToken(lexer, &token), "LexerPeekToken Failed");
-    assert_str_eq("def", token->TokenStr, "Did not successfully parse 'def' token.");
+    assert_eq(0, strncmp("def", token->Text, token->Length), "Did not successfully parse 'def' token.");
     TokenFree(token);
     free(token);
 
     assert_eq(0, LexerPeekToken(lexer, &token), "LexerPeekToken Failed");
-    assert_str_eq("def", token->TokenStr, "Peek consumed 'def' token.");
+    assert_eq(0, strncmp("def", token->Text, token->Length), "Peek consumed 'def' token.");
     TokenFree(token);
     free(token);
 
@@ -153,6 +154,7 @@ const char *SourceCode =
     " return "
     " continue "
     " break "
+    " yield "
     ;
 TEST(LexerTestAllTokenTypes) {
     struct Lexer *lexer = malloc(sizeof *lexer);
@@ -227,6 +229,7 @@ TEST(LexerTestAllTokenTypes) {
     LEX_TEST(lexer, "return", token, TokenReturn);
     LEX_TEST(lexer, "continue", token, TokenContinue);
     LEX_TEST(lexer, "break", token, TokenBreak);
+    LEX_TEST(lexer, "yield", token, TokenYield);
 
     LEX_TEST(lexer, "<EOS>", token, TokenEOS);
     assert_eq(Token_NUM_TOKENS, lex_tests, "Not all tokens have been tested.");
@@ -0,0 +1,34 @@
+#include "llvector.h"
+#include "globals.h"
+
+#include "c_bench.h"
+
+/* Appends to vectors that start out with room for one value until they
+   hold size values. */
+static void BenchAppend(struct Bench *b, void *arg) {
+    unsigned int i, size = *(unsigned int*)arg;
+    struct LLVector vector;
+    unsigned long done = 0;
+    while (done < b->N) {
+        BenchStopTimer(b);
+        LLVectorMake(&vector, 1);
+        BenchStartTimer(b);
+        for (i = 0; i < size && done < b->N; ++i, ++done) {
+            LLVectorAppendValue(&vector, &g_TheNilValue);
+        }
+        BenchStopTimer(b);
+        LLVectorFree(&vector);
+        BenchStartTimer(b);
+    }
+}
+
+int main() {
+    static unsigned int sizes[] = { 16, 1024, 65536 };
+    unsigned int s;
+    char name[64];
+    for (s = 0; s < sizeof sizes / sizeof *sizes; ++s) {
+        snprintf(name, sizeof name, "LLVectorAppendValue/%u", sizes[s]);
+        BenchRun(name, BenchAppend, &sizes[s]);
+    }
+    return 0;
+}
@@ -0,0 +1,57 @@
+#include "module_table.h"
+
+#include "c_bench.h"
+
+#include <string.h>
+
+#define MAX_MODULES 512U
+
+static char *Keys[MAX_MODULES];
+static char *MissingKeys[MAX_MODULES];
+/* Lookups never look inside a module, every key maps to this one. */
+static struct Module TheModule;
+
+struct FindArgs {
+    struct ModuleTable *Table;
+    unsigned int Size;
+    char **Keys;
+};
+
+static void BenchFind(struct Bench *b, void *arg) {
+    struct FindArgs *args = arg;
+    struct Module *module;
+    unsigned long i;
+    for (i = 0; i < b->N; ++i) {
+        ModuleTableFind(args->Table, args->Keys[i % args->Size], &module);
+    }
+}
+
+int main() {
+    static unsigned int sizes[] = { 8, 64, MAX_MODULES };
+    struct ModuleTable table;
+    struct FindArgs find;
+    unsigned int s, i;
+    char name[128];
+    for (i = 0; i < MAX_MODULES; ++i) {
+        snprintf(name, sizeof name, "/home/user/project/lib/module_%u.ll", i);
+        Keys[i] = strdup(name);
+        snprintf(name, sizeof name, "/home/user/project/lib/missing_%u.ll", i);
+        MissingKeys[i] = strdup(name);
+    }
+    /* The tables are never freed, that would free TheModule. */
+    for (s = 0; s < sizeof sizes / sizeof *sizes; ++s) {
+        ModuleTableMake(&table);
+        for (i = 0; i < sizes[s]; ++i) {
+            ModuleTableInsert(&table, Keys[i], &TheModule);
+        }
+        find.Table = &table;
+        find.Size = sizes[s];
+        find.Keys = Keys;
+        snprintf(name, sizeof name, "ModuleTableFind/%u/hit", find.Size);
+        BenchRun(name, BenchFind, &find);
+        find.Keys = MissingKeys;
+        snprintf(name, sizeof name, "ModuleTableFind/%u/miss", find.Size);
+        BenchRun(name, BenchFind, &find);
+    }
+    return 0;
+}
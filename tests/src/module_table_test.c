@@ -30,7 +30,7 @@ void free_things(void) {
 
 TEST(ModuleMakeFree) {
     alloc_things();
-    assert_eq(R_OK, ModuleMake(module, program, imports), "ModuleMake failed.");
+    assert_eq(R_Success, ModuleMake(module, program, imports), "ModuleMake failed.");
     assert_ne(NULL, module->ModuleScope, "module->ModuleScope not correctly created.");
     assert_ne(NULL, module->TypeTable, "module->TypeTable not correctly created.");
     assert_eq(module->ModuleScope, module->CurrentScope, "module->CurrentScope not set to module->ModuleScope.");
@@ -39,7 +39,7 @@ TEST(ModuleMakeFree) {
     
     assert_eq(R_InvalidArgument, ModuleMake(NULL, program, imports), "ModuleMake should have failed.");
 
-    assert_eq(R_OK, ModuleFree(module), "ModuleFree failed.");
+    assert_eq(R_Success, ModuleFree(module), "ModuleFree failed.");
     assert_eq(NULL, module->ModuleScope, "module->ModuleScope not set to NULL.");
     assert_eq(NULL, module->TypeTable, "module->TypeTable not set to NULL.");
     assert_eq(NULL, module->CurrentScope, "module->CurrentScope not set to NULL.");
@@ -52,13 +52,13 @@ TEST(ModuleMakeFree) {
 
 TEST(ModuleTableMakeFree) {
     struct ModuleTable *table = calloc(sizeof *table, 1);
-    assert_eq(R_OK, ModuleTableMake(table), "ModuleTabkeMake failed.");
+    assert_eq(R_Success, ModuleTableMake(table), "ModuleTabkeMake failed.");
     assert_p(table->NumNodes > 0, "moduleTable->NumNodes not > 0");
     assert_ne(NULL, table->Nodes, "ModuleTable->Nodes == NULL");
 
     assert_eq(R_InvalidArgument, ModuleTableMake(NULL), "ModuleTableMake should have failed.");
 
-    assert_eq(R_OK, ModuleTableFree(table), "ModuleTableFree failed.");
+    assert_eq(R_Success, ModuleTableFree(table), "ModuleTableFree failed.");
 
     assert_eq(R_InvalidArgument, ModuleTableFree(NULL), "ModuleTableFree should have failed.");
     free(table);
@@ -68,7 +68,7 @@ TEST(ModuleTableInsert) {
     struct ModuleTable *table = calloc(sizeof *table, 1);
     alloc_things();
     ModuleTableMake(table);
-    assert_eq(R_OK, ModuleTableInsert(table, "key", module), "ModuleTableInsert failed.");
+    assert_eq(R_Success, ModuleTableInsert(table, "key", module), "ModuleTableInsert failed.");
 
     assert_eq(R_KeyAlreadyInTable, ModuleTableInsert(table, "key", module), "ModuleTableInsert should have failed.");
 
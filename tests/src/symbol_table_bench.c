@@ -0,0 +1,103 @@
+#include "symbol_table.h"
+#include "globals.h"
+
+#include "c_bench.h"
+
+#include <string.h>
+
+#define MAX_KEYS 4096U
+
+static char *Keys[MAX_KEYS];
+static char *MissingKeys[MAX_KEYS];
+static struct SrcLoc srcLoc = {"symbol_table_bench.c", -1, -1};
+
+struct TableArgs {
+    unsigned int Size;
+    int IsGlobalScope;
+};
+
+static void MakeTable(struct SymbolTable *table, struct TableArgs *args) {
+    if (args->IsGlobalScope) {
+        SymbolTableMakeGlobalScope(table);
+    }
+    else {
+        SymbolTableMake(table);
+    }
+}
+
+static void FillTable(struct SymbolTable *table, unsigned int size) {
+    unsigned int i;
+    for (i = 0; i < size; ++i) {
+        SymbolTableInsert(table, &g_TheNilValue, Keys[i], 0, srcLoc);
+    }
+}
+
+static void BenchInsert(struct Bench *b, void *arg) {
+    struct TableArgs *args = arg;
+    struct SymbolTable table;
+    unsigned long done = 0;
+    unsigned int i;
+    while (done < b->N) {
+        BenchStopTimer(b);
+        MakeTable(&table, args);
+        BenchStartTimer(b);
+        for (i = 0; i < args->Size && done < b->N; ++i, ++done) {
+            SymbolTableInsert(&table, &g_TheNilValue, Keys[i], 0, srcLoc);
+        }
+        BenchStopTimer(b);
+        SymbolTableFree(&table);
+        BenchStartTimer(b);
+    }
+}
+
+static void BenchFind(struct Bench *b, char **keys, struct TableArgs *args) {
+    struct SymbolTable table;
+    struct Symbol *symbol;
+    unsigned long i;
+    BenchStopTimer(b);
+    MakeTable(&table, args);
+    FillTable(&table, args->Size);
+    BenchStartTimer(b);
+    for (i = 0; i < b->N; ++i) {
+        SymbolTableFindLocal(&table, keys[i % args->Size], &symbol);
+    }
+    BenchStopTimer(b);
+    SymbolTableFree(&table);
+}
+
+static void BenchFindHit(struct Bench *b, void *arg) {
+    BenchFind(b, Keys, arg);
+}
+
+static void BenchFindMiss(struct Bench *b, void *arg) {
+    BenchFind(b, MissingKeys, arg);
+}
+
+int main() {
+    static const unsigned int sizes[] = { 8, 64, 512, MAX_KEYS };
+    struct TableArgs args;
+    unsigned int i, s;
+    char name[64];
+    for (i = 0; i < MAX_KEYS; ++i) {
+        snprintf(name, sizeof name, "symbol_%u", i);
+        Keys[i] = strdup(name);
+        snprintf(name, sizeof name, "missing_%u", i);
+        MissingKeys[i] = strdup(name);
+    }
+    for (args.IsGlobalScope = 0; args.IsGlobalScope < 2; ++args.IsGlobalScope) {
+        for (s = 0; s < sizeof sizes / sizeof *sizes; ++s) {
+            args.Size = sizes[s];
+            snprintf(name, sizeof name, "SymbolTableInsert/%s/%u", args.IsGlobalScope ? "global" : "local", args.Size);
+            BenchRun(name, BenchInsert, &args);
+            snprintf(name, sizeof name, "SymbolTableFindLocal/%s/%u/hit", args.IsGlobalScope ? "global" : "local", args.Size);
+            BenchRun(name, BenchFindHit, &args);
+            snprintf(name, sizeof name, "SymbolTableFindLocal/%s/%u/miss", args.IsGlobalScope ? "global" : "local", args.Size);
+            BenchRun(name, BenchFindMiss, &args);
+        }
+    }
+    for (i = 0; i < MAX_KEYS; ++i) {
+        free(Keys[i]);
+        free(MissingKeys[i]);
+    }
+    return 0;
+}
@@ -53,7 +53,7 @@ TEST(SymbolTableInsert) {
     TypeInfoMake(ti, TypeInteger, NULL, typeName);
     ValueMakeObject(v, ti, &data, sizeof(data));
     SymbolTableMakeGlobalScope(st);
-    assert_eq(R_OK, SymbolTableInsert(st, v, name, 0, srcLoc), "Failed to insert symbol into symbol table.");
+    assert_eq(R_Success, SymbolTableInsert(st, v, name, 0, srcLoc), "Failed to insert symbol into symbol table.");
     assert_eq(R_KeyAlreadyInTable, SymbolTableInsert(st, v, name, 0, srcLoc), "Failed to skip insert of duplicate name.");
 
     SymbolTableFree(st);
@@ -19,8 +19,8 @@ void done() {
 
 TEST(TokenStreamMakeFree) {
     struct TokenStream *ts = malloc(sizeof *ts);
-    assert_eq(R_OK, TokenStreamMake(ts, lex), "TokenStreamMake failed");
-    assert_eq(R_OK, TokenStreamFree(ts), "TokenStreamFree failed");
+    assert_eq(R_Success, TokenStreamMake(ts, lex), "TokenStreamMake failed");
+    assert_eq(R_Success, TokenStreamFree(ts), "TokenStreamFree failed");
     free(ts);
 }
 
@@ -29,24 +29,24 @@ TEST(TokenStreamAppend) {
     struct Token *def = malloc(sizeof *def);
     struct Token *ident = malloc(sizeof *ident);
     struct Token *lbrace = malloc(sizeof *lbrace);
-    TokenMake(def, TokenDef, "def", "test.ll", 5, 10);
-    TokenMake(ident, TokenIdentifer, "hello_world", "test.ll", 5, 10);
-    TokenMake(lbrace, TokenLeftCurlyBrace, "{", "test.ll", 4, 2);
+    TokenMake(def, TokenDef, "def", 3, "test.ll", 5, 10);
+    TokenMake(ident, TokenIdentifer, "hello_world", 11, "test.ll", 5, 10);
+    TokenMake(lbrace, TokenLeftCurlyBrace, "{", 1, "test.ll", 4, 2);
     TokenStreamMake(ts, lex);
-    assert_eq(R_OK, TokenStreamAppend(ts, def), "Failed to append token.");
-    assert_eq(def, ts->Head->Token, "Did not correctly assign head.");
-    assert_eq(def, ts->Tail->Token, "Did not correctly assign tail.");
-    assert_eq(def, ts->Current->Token, "Did not correctly assign current.");
+    assert_eq(R_Success, TokenStreamAppend(ts, def), "Failed to append token.");
+    assert_eq(1, ts->Count, "Did not correctly append 'def'.");
+    assert_eq(TokenDef, ts->Tokens[0].Type, "Did not correctly copy 'def'.");
+    assert_eq(TokenDef, TOKEN_STREAM_CURRENT(ts)->Type, "Did not correctly assign current.");
 
-    assert_eq(R_OK, TokenStreamAppend(ts, ident), "Failed to append token.");
-    assert_eq(def, ts->Head->Token, "Head should still be 'def'.");
-    assert_eq(ident, ts->Tail->Token, "Did not correctly assign tail.");
-    assert_eq(def, ts->Current->Token, "Current should still be 'def'.");
+    assert_eq(R_Success, TokenStreamAppend(ts, ident), "Failed to append token.");
+    assert_eq(2, ts->Count, "Did not correctly append 'hello_world'.");
+    assert_eq(TokenIdentifer, ts->Tokens[1].Type, "Did not correctly copy 'hello_world'.");
+    assert_eq(TokenDef, TOKEN_STREAM_CURRENT(ts)->Type, "Current should still be 'def'.");
 
-    assert_eq(R_OK, TokenStreamAppend(ts, lbrace), "Failed to append token.");
-    assert_eq(def, ts->Head->Token, "Head should still be 'def'.");
-    assert_eq(lbrace, ts->Tail->Token, "Did not correctly assign tail.");
-    assert_eq(def, ts->Current->Token, "Current should still be 'def'.");
+    assert_eq(R_Success, TokenStreamAppend(ts, lbrace), "Failed to append token.");
+    assert_eq(3, ts->Count, "Did not correctly append '{'.");
+    assert_eq(TokenLeftCurlyBrace, ts->Tokens[2].Type, "Did not correctly copy '{'.");
+    assert_eq(TokenDef, TOKEN_STREAM_CURRENT(ts)->Type, "Current should still be 'def'.");
 
     TokenStreamFree(ts);
     free(def);
@@ -61,30 +61,30 @@ TEST(TokenStreamAdvanceRewind) {
     struct Token *def = malloc(sizeof *def);
     struct Token *ident = malloc(sizeof *ident);
     struct Token *lbrace = malloc(sizeof *lbrace);
-    TokenMake(def, TokenDef, "def", "test.ll", 5, 10);
-    TokenMake(ident, TokenIdentifer, "hello_world", "test.ll", 5, 10);
-    TokenMake(lbrace, TokenLeftCurlyBrace, "{", "test.ll", 4, 2);
+    TokenMake(def, TokenDef, "def", 3, "test.ll", 5, 10);
+    TokenMake(ident, TokenIdentifer, "hello_world", 11, "test.ll", 5, 10);
+    TokenMake(lbrace, TokenLeftCurlyBrace, "{", 1, "test.ll", 4, 2);
     TokenStreamMake(ts, lex);
     TokenStreamAppend(ts, def);
     TokenStreamAppend(ts, ident);
     TokenStreamAppend(ts, lbrace);
 
-    assert_eq(R_OK, TokenStreamAdvance(ts), "TokenStreamAdvance failed.");
-    assert_eq(ident, ts->Current->Token, "Did not correctly advance stream.");
-    assert_eq(R_OK, TokenStreamRewind(ts), "TokenStreamAdvance failed.");
-    assert_eq(def, ts->Current->Token, "Did not correctly advance stream.");
-    assert_eq(R_OK, TokenStreamAdvance(ts), "TokenStreamAdvance failed.");
-    assert_eq(ident, ts->Current->Token, "Did not correctly advance stream.");
-    assert_eq(R_OK, TokenStreamAdvance(ts), "TokenStreamAdvance failed.");
-    assert_eq(lbrace, ts->Current->Token, "Did not correctly advance stream.");
+    assert_eq(R_Success, TokenStreamAdvance(ts), "TokenStreamAdvance failed.");
+    assert_eq(TokenIdentifer, TOKEN_STREAM_CURRENT(ts)->Type, "Did not correctly advance stream.");
+    assert_eq(R_Success, TokenStreamRewind(ts), "TokenStreamAdvance failed.");
+    assert_eq(TokenDef, TOKEN_STREAM_CURRENT(ts)->Type, "Did not correctly advance stream.");
+    assert_eq(R_Success, TokenStreamAdvance(ts), "TokenStreamAdvance failed.");
+    assert_eq(TokenIdentifer, TOKEN_STREAM_CURRENT(ts)->Type, "Did not correctly advance stream.");
+    assert_eq(R_Success, TokenStreamAdvance(ts), "TokenStreamAdvance failed.");
+    assert_eq(TokenLeftCurlyBrace, TOKEN_STREAM_CURRENT(ts)->Type, "Did not correctly advance stream.");
 
     // Test extra advances/rewinds.
-    while (ts->Current->Next) {
+    while (ts->Current + 1 < ts->Count) {
         TokenStreamAdvance(ts);
     }
     assert_eq(R_OperationFailed, TokenStreamAdvance(ts), "TokenStreamAdvance should have failed.");
 
-    while (ts->Current->Prev) {
+    while (ts->Current > 0) {
         TokenStreamRewind(ts);
     }
     assert_eq(R_OperationFailed, TokenStreamRewind(ts), "TokenStreamRewind should have failed.");
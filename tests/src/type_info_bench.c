@@ -0,0 +1,100 @@
+#include "interpreter.h"
+#include "type_info.h"
+#include "type_table.h"
+#include "globals.h"
+
+#include "c_bench.h"
+
+#include <string.h>
+
+#define MAX_DEPTH 64U
+#define MAX_TYPES 512U
+
+static struct TypeInfo Hierarchy[MAX_DEPTH];
+static struct TypeInfo Types[MAX_TYPES];
+static char *MissingKeys[MAX_TYPES];
+static struct SrcLoc srcLoc = {"type_info_bench.c", -1, -1};
+
+struct LookupArgs {
+    unsigned int Depth;
+    char *Method;
+};
+
+struct FindArgs {
+    struct TypeTable *Table;
+    unsigned int Size;
+    int Miss;
+};
+
+/* Hierarchy[0] derives from the base object and defines `root', every
+   other class derives from the one before it and defines `leaf'. */
+static void MakeHierarchy(void) {
+    unsigned int i;
+    char name[32];
+    for (i = 0; i < MAX_DEPTH; ++i) {
+        snprintf(name, sizeof name, "Class%u", i);
+        TypeInfoMake(&Hierarchy[i], TypeUserObject, i ? &Hierarchy[i - 1] : &g_TheBaseObjectTypeInfo, name);
+        SymbolTableInsert(Hierarchy[i].MethodTable, &g_TheNilValue, i ? "leaf" : "root", 0, srcLoc);
+    }
+}
+
+static void BenchLookup(struct Bench *b, void *arg) {
+    struct LookupArgs *args = arg;
+    struct TypeInfo *typeInfo = &Hierarchy[args->Depth - 1];
+    struct Value *method;
+    unsigned long i;
+    for (i = 0; i < b->N; ++i) {
+        TypeInfoLookupMethod(typeInfo, args->Method, &method);
+    }
+}
+
+static void BenchFind(struct Bench *b, void *arg) {
+    struct FindArgs *args = arg;
+    struct TypeInfo *typeInfo;
+    unsigned long i;
+    for (i = 0; i < b->N; ++i) {
+        TypeTableFind(args->Table, args->Miss ? MissingKeys[i % args->Size] : Types[i % args->Size].TypeName, &typeInfo);
+    }
+}
+
+int main() {
+    static unsigned int depths[] = { 1, 4, 16, MAX_DEPTH };
+    static unsigned int sizes[] = { 8, 64, MAX_TYPES };
+    static char *methods[] = { "leaf", "root", "__str__", "missing" };
+    struct LookupArgs lookup;
+    struct FindArgs find;
+    struct TypeTable table;
+    unsigned int d, m, s, i;
+    char name[64];
+    InterpreterInit();
+    MakeHierarchy();
+    for (i = 0; i < MAX_TYPES; ++i) {
+        snprintf(name, sizeof name, "Type%u", i);
+        TypeInfoMake(&Types[i], TypeUserObject, &g_TheBaseObjectTypeInfo, name);
+        snprintf(name, sizeof name, "Missing%u", i);
+        MissingKeys[i] = strdup(name);
+    }
+    for (d = 0; d < sizeof depths / sizeof *depths; ++d) {
+        for (m = 0; m < sizeof methods / sizeof *methods; ++m) {
+            lookup.Depth = depths[d];
+            lookup.Method = methods[m];
+            snprintf(name, sizeof name, "TypeInfoLookupMethod/depth/%u/%s", lookup.Depth, lookup.Method);
+            BenchRun(name, BenchLookup, &lookup);
+        }
+    }
+    /* The tables share the types, they are left for the process to
+       release. */
+    for (s = 0; s < sizeof sizes / sizeof *sizes; ++s) {
+        TypeTableMake(&table, 0);
+        for (i = 0; i < sizes[s]; ++i) {
+            TypeTableInsert(&table, &Types[i]);
+        }
+        find.Table = &table;
+        find.Size = sizes[s];
+        for (find.Miss = 0; find.Miss < 2; ++find.Miss) {
+            snprintf(name, sizeof name, "TypeTableFind/%u/%s", find.Size, find.Miss ? "miss" : "hit");
+            BenchRun(name, BenchFind, &find);
+        }
+    }
+    return 0;
+}